@@ -0,0 +1,80 @@
+#version 450 core
+
+// foliage debug views (DebugViewType): counts every rasterized foliage fragment for OverdrawCounter, then
+// shades like foliage_instancing.frag with a debug color. The counts are taken before the alpha test and
+// without early depth, so they are the fragment work of the alpha-tested foliage, hidden layers included.
+layout(location = 0) out vec4 fragColor;
+
+in VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    vec2 uv;
+    flat float textureLayer;
+    flat float fade;
+    flat uvec2 debugIDs;
+} fs_in;
+
+// per view: layer 2 * view fragments, 2 * view + 1 quad lanes in 1 / LANE_UNITS
+layout(r32ui, binding = 0) uniform uimage2DArray countImage;
+
+uniform sampler2DArray albedoTextureArray;
+uniform vec3 lightDir;
+uniform int debugView;
+uniform int countView;
+// lower left corner of the viewport, the counts of every view start at 0
+uniform ivec2 viewportOrigin;
+
+const uint LANE_UNITS = 12u;
+const int DEBUG_VIEW_INSTANCE = 2;
+const int DEBUG_VIEW_LOD = 3;
+
+// must match foliage_instancing.frag
+float ditherThreshold(vec2 fragCoord) {
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+vec3 hueColor(float h) {
+    return clamp(abs(fract(h + vec3(0.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0) - 1.0, 0.0, 1.0);
+}
+
+// number of lanes of this fragment's 2x2 quad that are covered (not helper invocations), from the fine
+// derivatives of the coverage; needs uniform control flow so it runs before any discard
+uint coveredQuadLanes() {
+    float covered = gl_HelperInvocation ? 0.0 : 1.0;
+    ivec2 parity = ivec2(gl_FragCoord.xy) & 1;
+    float dx = dFdxFine(covered);
+    float dy = dFdyFine(covered);
+    float neighborX = parity.x == 0 ? covered + dx : covered - dx;
+    float neighborY = parity.y == 0 ? covered + dy : covered - dy;
+    float dxy = dFdyFine(neighborX);
+    float diagonal = parity.y == 0 ? neighborX + dxy : neighborX - dxy;
+    return uint(covered + neighborX + neighborY + diagonal + 0.5);
+}
+
+void main() {
+    uint lanes = coveredQuadLanes();
+    if (!gl_HelperInvocation) {
+        ivec2 p = ivec2(gl_FragCoord.xy) - viewportOrigin;
+        imageAtomicAdd(countImage, ivec3(p, 2 * countView), 1u);
+        imageAtomicAdd(countImage, ivec3(p, 2 * countView + 1), 4u * LANE_UNITS / max(lanes, 1u));
+    }
+
+    vec4 texel = texture(albedoTextureArray, vec3(fs_in.uv, fs_in.textureLayer));
+    if (texel.a < 0.5 || ditherThreshold(gl_FragCoord.xy) < fs_in.fade) {
+        discard;
+    }
+
+    // overdraw / quad occupancy are drawn over this by overdraw_view.frag
+    vec3 color = vec3(0.6);
+    if (debugView == DEBUG_VIEW_INSTANCE) {
+        color = hueColor(float(fs_in.debugIDs.x & 0xFFFFu) / 65536.0);
+    }
+    else if (debugView == DEBUG_VIEW_LOD) {
+        const vec3 lodColors[4] = vec3[4](vec3(0.1, 0.8, 0.1), vec3(0.9, 0.9, 0.1), vec3(0.9, 0.4, 0.1), vec3(0.8, 0.1, 0.8));
+        color = lodColors[min(fs_in.debugIDs.y, 3u)];
+    }
+    float diff = max(dot(normalize(fs_in.normal), normalize(lightDir)), 0.0);
+    fragColor = vec4(color * (0.35 + 0.65 * diff), 1.0);
+}
@@ -0,0 +1,28 @@
+#version 430 core
+
+// depth pre-pass of the foliage (RenderingOrderExp::FoliagePass::DEPTH_PREPASS): only the alpha test and the
+// impostor dither of foliage_instancing.frag, no color; foliage_shade.frag then shades the surviving depth
+in VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    vec2 uv;
+    flat float textureLayer;
+    flat float fade;
+    flat uvec2 debugIDs;
+} fs_in;
+
+uniform sampler2DArray albedoTextureArray;
+
+// 4x4 ordered dither in (0, 1), must match foliage_instancing.frag / impostor.frag
+float ditherThreshold(vec2 fragCoord) {
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void main() {
+    float alpha = texture(albedoTextureArray, vec3(fs_in.uv, fs_in.textureLayer)).a;
+    if (alpha < 0.5 || ditherThreshold(gl_FragCoord.xy) < fs_in.fade) {
+        discard;
+    }
+}
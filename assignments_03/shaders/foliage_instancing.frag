@@ -7,22 +7,39 @@ in VS_OUT {
     vec3 normal;
     vec2 uv;
     flat float textureLayer;
+    flat float fade;
+    flat uvec2 debugIDs;
 } fs_in;
 
 uniform sampler2DArray albedoTextureArray;
-uniform vec3 cameraPos;
 uniform vec3 lightDir;
 
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
+
 const vec3 Ka = vec3(0.1);
 const vec3 Kd = vec3(0.8);
 const vec3 Ks = vec3(0.1);
 const float shininess = 1.0;
 const float exposure = 3.0;
 
+// 4x4 ordered dither in (0, 1), must match impostor.frag so the crossfade is complementary (and foliage_depth.frag /
+// foliage_shade.frag)
+float ditherThreshold(vec2 fragCoord) {
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
 void main() {
     vec3 N = normalize(fs_in.normal);
     vec4 texel = texture(albedoTextureArray, vec3(fs_in.uv, fs_in.textureLayer));
-    if (texel.a < 0.5) {
+    // the impostor draws the pixels the dither leaves out
+    if (texel.a < 0.5 || ditherThreshold(gl_FragCoord.xy) < fs_in.fade) {
         discard;
     }
     vec3 albedo = texel.rgb;
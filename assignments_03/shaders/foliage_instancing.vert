@@ -1,42 +1,102 @@
-#version 460 core
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV;
 
+// transform: bits 0-15 yaw in [0, 2pi), 16-23 uniform scale in [MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE],
+// 24-31 species (mesh id)
 struct InstanceProperties {
-    vec4 position;
+    vec3 position;
+    uint transform;
 };
 
 layout(std430, binding = 1) buffer CurrValidInstanceData {
     InstanceProperties currValidInstanceProps[];
 };
 
+// per species, see foliage_cull.comp: info.z texture layer, far.y impostor distance, far.z crossfade band
+struct MeshLod {
+    uvec4 info;
+    vec4 maxDistances;
+    vec4 far;
+};
+
+layout(std430, binding = 8) buffer MeshLodBlock {
+    MeshLod meshLods[];
+};
+
+const float MIN_INSTANCE_SCALE = 0.5;
+const float MAX_INSTANCE_SCALE = 2.0;
+const float TWO_PI = 6.28318530718;
+
 uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
+// 1: instances past their species' impostor distance dissolve into the impostors (impostor.frag)
+uniform int impostorCrossfade;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
 
 out VS_OUT {
     vec3 worldPos;
     vec3 normal;
     vec2 uv;
     flat float textureLayer;
+    // fraction of the mesh that is dithered away
+    flat float fade;
+    // foliage_debug.frag: x hash of the instance, y LOD
+    flat uvec2 debugIDs;
 } vs_out;
 
+// integer hash (lowbias32), spreads neighbouring instance positions over the debug colors
+uint hashInstance(vec3 position) {
+    uvec3 bits = floatBitsToUint(position);
+    uint h = bits.x ^ (bits.y * 0x9E3779B9u) ^ (bits.z * 0x85EBCA6Bu);
+    h ^= h >> 16u;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15u;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16u;
+    return h;
+}
+
+// the depth pre-pass (foliage_depth.frag) and the GL_EQUAL shading pass are separate programs
+invariant gl_Position;
+
 void main() {
-    uint instanceIndex = gl_BaseInstance + gl_InstanceID;
-    vec4 instanceData = currValidInstanceProps[instanceIndex].position;
-    vec3 translation = instanceData.xyz;
-    float layer = instanceData.w;
+    uint instanceIndex = gl_BaseInstanceARB + gl_InstanceID;
+    InstanceProperties instance = currValidInstanceProps[instanceIndex];
+    float yaw = float(instance.transform & 0xFFFFu) * (TWO_PI / 65535.0);
+    float scale = mix(MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE, float((instance.transform >> 16u) & 0xFFu) / 255.0);
+    MeshLod lods = meshLods[instance.transform >> 24u];
+    // rotation about +y, same convention as the culling bounds
+    float c = cos(yaw);
+    float s = sin(yaw);
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
 
     vec4 localPos = modelMat * vec4(inPosition, 1.0);
-    vec3 worldPosition = localPos.xyz + translation;
-    vec3 normal = mat3(modelMat) * inNormal;
+    vec3 worldPosition = rotation * (scale * localPos.xyz) + instance.position;
+    vec3 normal = rotation * (mat3(modelMat) * inNormal);
 
     vs_out.worldPos = worldPosition;
     vs_out.normal = normal;
     vs_out.uv = inUV;
-    vs_out.textureLayer = layer;
+    vs_out.textureLayer = float(lods.info.z);
+    // same distance as the LOD selection in foliage_cull.comp
+    float dist = distance(instance.position, cameraPos);
+    vs_out.fade = impostorCrossfade == 1 && lods.far.y > 0.0 ? clamp((dist - lods.far.y) / max(lods.far.z, 1e-4), 0.0, 1.0) : 0.0;
+    // same loop as selectCommands in foliage_cull.comp
+    uint lastLod = lods.info.y - 1u;
+    uint lod = 0u;
+    while (lod < lastLod && dist > lods.maxDistances[lod]) {
+        lod++;
+    }
+    vs_out.debugIDs = uvec2(hashInstance(instance.position), lod);
 
     gl_Position = projMat * viewMat * vec4(worldPosition, 1.0);
 }
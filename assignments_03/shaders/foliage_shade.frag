@@ -0,0 +1,71 @@
+#version 430 core
+
+// foliage shading without discard, so the depth test runs before the shader:
+//   depth pre-pass: drawn with GL_EQUAL against the depth of foliage_depth.frag, alpha is unused
+//   alpha to coverage: the alpha test and the impostor dither become the sample coverage of a
+//   multisample target (GL_SAMPLE_ALPHA_TO_COVERAGE)
+layout(location = 0) out vec4 fragColor;
+
+in VS_OUT {
+    vec3 worldPos;
+    vec3 normal;
+    vec2 uv;
+    flat float textureLayer;
+    flat float fade;
+    flat uvec2 debugIDs;
+} fs_in;
+
+uniform sampler2DArray albedoTextureArray;
+uniform vec3 lightDir;
+uniform int alphaToCoverage;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
+
+const vec3 Ka = vec3(0.1);
+const vec3 Kd = vec3(0.8);
+const vec3 Ks = vec3(0.1);
+const float shininess = 1.0;
+const float exposure = 3.0;
+// alpha test of foliage_instancing.frag
+const float ALPHA_CUTOFF = 0.5;
+
+// 4x4 ordered dither in (0, 1), must match foliage_instancing.frag / impostor.frag
+float ditherThreshold(vec2 fragCoord) {
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void main() {
+    vec3 N = normalize(fs_in.normal);
+    vec4 texel = texture(albedoTextureArray, vec3(fs_in.uv, fs_in.textureLayer));
+    vec3 albedo = texel.rgb;
+
+    vec3 L = normalize(lightDir);
+    vec3 V = normalize(cameraPos - fs_in.worldPos);
+    float diff = max(dot(N, L), 0.0);
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(R, V), 0.0), shininess);
+
+    vec3 ambient = Ka * albedo;
+    vec3 diffuse = Kd * albedo * diff;
+    vec3 specular = Ks * albedo * spec;
+    vec3 color = ambient + diffuse + specular;
+
+    vec3 mapped = vec3(1.0) - exp(-color * exposure);
+    mapped = pow(mapped, vec3(1.0 / 2.2));
+
+    float coverage = 1.0;
+    if (alphaToCoverage == 1) {
+        // the cutoff sharpened to about a pixel wide ramp, so the edges get a few coverage steps
+        // instead of the blurry alpha of the mips
+        coverage = clamp((texel.a - ALPHA_CUTOFF) / max(fwidth(texel.a), 1e-4) + 0.5, 0.0, 1.0);
+        coverage *= step(fs_in.fade, ditherThreshold(gl_FragCoord.xy));
+    }
+    fragColor = vec4(mapped, coverage);
+}
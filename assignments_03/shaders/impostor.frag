@@ -0,0 +1,95 @@
+#version 430 core
+
+// the impostor surface is never in front of the quad, early depth testing stays on
+layout(depth_greater) out float gl_FragDepth;
+layout(location = 0) out vec4 fragColor;
+
+in VS_OUT {
+    vec3 worldPos;
+    vec4 frameUV01;
+    vec4 frameUV23;
+    flat vec4 frameOrigin01;
+    flat vec4 frameOrigin23;
+    flat vec4 frameWeights;
+    flat float atlasLayer;
+    flat vec2 yawCosSin;
+    flat vec4 facing;
+    flat float fade;
+} fs_in;
+
+// see OPENGL::ImpostorAtlas, both premultiplied by coverage
+uniform sampler2DArray impostorAlbedo;
+uniform sampler2DArray impostorNormalDepth;
+uniform vec3 lightDir;
+uniform int framesPerSide;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
+
+// same shading as foliage_instancing.frag
+const vec3 Ka = vec3(0.1);
+const vec3 Kd = vec3(0.8);
+const vec3 Ks = vec3(0.1);
+const float shininess = 1.0;
+const float exposure = 3.0;
+
+// 4x4 ordered dither in (0, 1), must match foliage_instancing.frag so the crossfade is complementary
+float ditherThreshold(vec2 fragCoord) {
+    const float bayer[16] = float[16](0.0, 8.0, 2.0, 10.0, 12.0, 4.0, 14.0, 6.0, 3.0, 11.0, 1.0, 9.0, 15.0, 7.0, 13.0, 5.0);
+    ivec2 p = ivec2(fragCoord) & 3;
+    return (bayer[p.y * 4 + p.x] + 0.5) / 16.0;
+}
+
+void sampleFrame(vec2 uv, vec2 origin, float weight, inout vec4 albedo, inout vec4 normalDepth) {
+    // where the ray leaves this frame's image there is nothing of the mesh; sampled anyway, texture()
+    // needs uniform control flow for its derivatives
+    float inside = all(greaterThanEqual(uv, vec2(0.0))) && all(lessThanEqual(uv, vec2(1.0))) ? weight : 0.0;
+    vec3 atlasUV = vec3(origin + clamp(uv, 0.0, 1.0) / float(framesPerSide), fs_in.atlasLayer);
+    albedo += inside * texture(impostorAlbedo, atlasUV);
+    normalDepth += inside * texture(impostorNormalDepth, atlasUV);
+}
+
+void main() {
+    vec4 albedo = vec4(0.0);
+    vec4 normalDepth = vec4(0.0);
+    sampleFrame(fs_in.frameUV01.xy, fs_in.frameOrigin01.xy, fs_in.frameWeights.x, albedo, normalDepth);
+    sampleFrame(fs_in.frameUV01.zw, fs_in.frameOrigin01.zw, fs_in.frameWeights.y, albedo, normalDepth);
+    sampleFrame(fs_in.frameUV23.xy, fs_in.frameOrigin23.xy, fs_in.frameWeights.z, albedo, normalDepth);
+    sampleFrame(fs_in.frameUV23.zw, fs_in.frameOrigin23.zw, fs_in.frameWeights.w, albedo, normalDepth);
+    // coverage, tested like the mesh's alpha; the mesh draws the pixels the dither leaves out
+    if (albedo.a < 0.5 || ditherThreshold(gl_FragCoord.xy) >= fs_in.fade) {
+        discard;
+    }
+    albedo.rgb /= albedo.a;
+    normalDepth /= albedo.a;
+
+    // mesh space normal rotated by the instance yaw (see foliage_instancing.vert)
+    vec3 meshNormal = normalDepth.xyz * 2.0 - 1.0;
+    float c = fs_in.yawCosSin.x;
+    float s = fs_in.yawCosSin.y;
+    vec3 N = normalize(vec3(c * meshNormal.x + s * meshNormal.z, meshNormal.y, -s * meshNormal.x + c * meshNormal.z));
+
+    // surface point: from the quad (radius in front of the center) back along the view ray to the baked depth
+    vec3 toCamera = fs_in.facing.xyz;
+    float radius = fs_in.facing.w;
+    vec3 ray = normalize(fs_in.worldPos - cameraPos);
+    float towardViewer = normalDepth.w * 2.0 - 1.0;
+    vec3 surfacePos = fs_in.worldPos + ray * ((1.0 - towardViewer) * radius / max(-dot(ray, toCamera), 1e-3));
+    vec4 clipPos = projMat * viewMat * vec4(surfacePos, 1.0);
+    gl_FragDepth = clipPos.z / clipPos.w * 0.5 + 0.5;
+
+    vec3 L = normalize(lightDir);
+    vec3 V = -ray;
+    float diff = max(dot(N, L), 0.0);
+    vec3 R = reflect(-L, N);
+    float spec = pow(max(dot(R, V), 0.0), shininess);
+
+    vec3 color = Ka * albedo.rgb + Kd * albedo.rgb * diff + Ks * albedo.rgb * spec;
+    vec3 mapped = vec3(1.0) - exp(-color * exposure);
+    mapped = pow(mapped, vec3(1.0 / 2.2));
+    fragColor = vec4(mapped, 1.0);
+}
@@ -0,0 +1,149 @@
+#version 450 core
+#extension GL_ARB_shader_draw_parameters : require
+
+// transform: bits 0-15 yaw in [0, 2pi), 16-23 uniform scale in [MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE],
+// 24-31 species (mesh id)
+struct InstanceProperties {
+    vec3 position;
+    uint transform;
+};
+
+layout(std430, binding = 1) buffer CurrValidInstanceData {
+    InstanceProperties currValidInstanceProps[];
+};
+
+// per species bounding sphere (xyz center in mesh space, w radius)
+layout(std430, binding = 7) buffer MeshBoundsBlock {
+    vec4 meshBounds[];
+};
+
+// per species, see foliage_cull.comp: info.w impostor atlas layer, far.y impostor distance, far.z crossfade band
+struct MeshLod {
+    uvec4 info;
+    vec4 maxDistances;
+    vec4 far;
+};
+
+layout(std430, binding = 8) buffer MeshLodBlock {
+    MeshLod meshLods[];
+};
+
+const float MIN_INSTANCE_SCALE = 0.5;
+const float MAX_INSTANCE_SCALE = 2.0;
+const float TWO_PI = 6.28318530718;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
+
+uniform int framesPerSide;
+
+// The quad faces the camera from the front of the instance's bounding sphere. The four atlas frames
+// around the view direction are blended; each is sampled where the view ray through the quad point
+// crosses that frame's image plane.
+out VS_OUT {
+    vec3 worldPos;
+    // position inside each frame, [0, 1]^2 over the bounding sphere
+    vec4 frameUV01;
+    vec4 frameUV23;
+    // lower left corner of each frame in the atlas
+    flat vec4 frameOrigin01;
+    flat vec4 frameOrigin23;
+    flat vec4 frameWeights;
+    flat float atlasLayer;
+    // cos / sin of the instance yaw, the atlas normals are in mesh space
+    flat vec2 yawCosSin;
+    // toward the camera, and the sphere radius: the quad lies radius in front of the center along it
+    flat vec4 facing;
+    // of the impostor, 0 where the mesh is still fully drawn
+    flat float fade;
+} vs_out;
+
+// [0, 1]^2 hemi-octahedral square position of an upper hemisphere direction
+vec2 hemiOctEncode(vec3 dir) {
+    vec3 p = dir / (abs(dir.x) + abs(dir.y) + abs(dir.z));
+    return vec2(p.x + p.z, p.x - p.z) * 0.5 + 0.5;
+}
+
+// must match impostor_bake.vert
+vec3 hemiOctDecode(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 dir = vec3(0.5 * (e.x + e.y), 0.0, 0.5 * (e.x - e.y));
+    dir.y = 1.0 - abs(dir.x) - abs(dir.z);
+    return normalize(dir);
+}
+
+// must match impostor_bake.vert
+void frameBasis(vec3 dir, out vec3 right, out vec3 up) {
+    vec3 side = cross(vec3(0.0, 1.0, 0.0), dir);
+    right = dot(side, side) > 1e-8 ? normalize(side) : vec3(1.0, 0.0, 0.0);
+    up = cross(dir, right);
+}
+
+// mesh space position of the ray hit in the image plane of frame, [0, 1]^2 over the bounding sphere
+vec2 frameUV(vec2 frame, vec3 point, vec3 ray, float radius) {
+    vec3 dir = hemiOctDecode((frame + 0.5) / float(framesPerSide));
+    vec3 right;
+    vec3 up;
+    frameBasis(dir, right, up);
+    float denom = dot(ray, dir);
+    float t = abs(denom) > 1e-6 ? -dot(point, dir) / denom : 0.0;
+    vec3 hit = point + t * ray;
+    return vec2(dot(hit, right), dot(hit, up)) / radius * 0.5 + 0.5;
+}
+
+void main() {
+    InstanceProperties instance = currValidInstanceProps[gl_BaseInstanceARB + gl_InstanceID];
+    uint species = instance.transform >> 24u;
+    MeshLod lods = meshLods[species];
+    vec4 bounds = meshBounds[species];
+    float yaw = float(instance.transform & 0xFFFFu) * (TWO_PI / 65535.0);
+    float scale = mix(MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE, float((instance.transform >> 16u) & 0xFFu) / 255.0);
+    float c = cos(yaw);
+    float s = sin(yaw);
+    // rotation about +y as in foliage_instancing.vert, and its inverse
+    mat3 rotation = mat3(c, 0.0, -s, 0.0, 1.0, 0.0, s, 0.0, c);
+    mat3 inverseRotation = transpose(rotation);
+
+    vec3 center = instance.position + rotation * (scale * bounds.xyz);
+    float radius = scale * bounds.w;
+    vec3 toCamera = normalize(cameraPos - center);
+    vec3 side = cross(vec3(0.0, 1.0, 0.0), toCamera);
+    vec3 right = dot(side, side) > 1e-8 ? normalize(side) : vec3(1.0, 0.0, 0.0);
+    vec3 up = cross(toCamera, right);
+    // corners from the quad's indices 0..3
+    vec2 corner = vec2(float(gl_VertexID & 1), float((gl_VertexID >> 1) & 1)) * 2.0 - 1.0;
+    vec3 worldPos = center + radius * (toCamera + corner.x * right + corner.y * up);
+
+    // frames around the mesh space view direction, the atlas only covers the upper hemisphere
+    vec3 viewDir = inverseRotation * toCamera;
+    viewDir.y = max(viewDir.y, 0.0);
+    vec2 grid = hemiOctEncode(normalize(viewDir)) * float(framesPerSide) - 0.5;
+    vec2 base = floor(grid);
+    vec2 t = grid - base;
+    vec2 lastFrame = vec2(float(framesPerSide - 1));
+    vec2 frame00 = clamp(base, vec2(0.0), lastFrame);
+    vec2 frame10 = clamp(base + vec2(1.0, 0.0), vec2(0.0), lastFrame);
+    vec2 frame01 = clamp(base + vec2(0.0, 1.0), vec2(0.0), lastFrame);
+    vec2 frame11 = clamp(base + vec2(1.0, 1.0), vec2(0.0), lastFrame);
+
+    // view ray through the quad point, mesh space relative to the sphere center
+    vec3 point = inverseRotation * (worldPos - center) / scale;
+    vec3 ray = inverseRotation * (worldPos - cameraPos);
+    vs_out.frameUV01 = vec4(frameUV(frame00, point, ray, bounds.w), frameUV(frame10, point, ray, bounds.w));
+    vs_out.frameUV23 = vec4(frameUV(frame01, point, ray, bounds.w), frameUV(frame11, point, ray, bounds.w));
+    vs_out.frameOrigin01 = vec4(frame00, frame10) / float(framesPerSide);
+    vs_out.frameOrigin23 = vec4(frame01, frame11) / float(framesPerSide);
+    vs_out.frameWeights = vec4((1.0 - t.x) * (1.0 - t.y), t.x * (1.0 - t.y), (1.0 - t.x) * t.y, t.x * t.y);
+    vs_out.atlasLayer = float(lods.info.w);
+    vs_out.yawCosSin = vec2(c, s);
+    vs_out.facing = vec4(toCamera, radius);
+    // same distance as the LOD selection in foliage_cull.comp
+    vs_out.fade = clamp((distance(instance.position, cameraPos) - lods.far.y) / max(lods.far.z, 1e-4), 0.0, 1.0);
+    vs_out.worldPos = worldPos;
+
+    gl_Position = projMat * viewMat * vec4(worldPos, 1.0);
+}
@@ -0,0 +1,24 @@
+#version 430 core
+
+layout(location = 0) out vec4 albedoOut;
+layout(location = 1) out vec4 normalDepthOut;
+
+in VS_OUT {
+    vec3 normal;
+    vec2 uv;
+    float depth;
+} fs_in;
+
+uniform sampler2DArray albedoTextureArray;
+uniform float textureLayer;
+
+void main() {
+    vec4 texel = texture(albedoTextureArray, vec3(fs_in.uv, textureLayer));
+    // same alpha test as foliage_instancing.frag
+    if (texel.a < 0.5) {
+        discard;
+    }
+    // full coverage, the cleared background is 0 (see ImpostorAtlas)
+    albedoOut = vec4(texel.rgb, 1.0);
+    normalDepthOut = vec4(normalize(fs_in.normal) * 0.5 + 0.5, fs_in.depth);
+}
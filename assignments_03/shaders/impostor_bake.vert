@@ -0,0 +1,48 @@
+#version 430 core
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inNormal;
+layout(location = 2) in vec2 inUV;
+
+// mesh space bounding sphere, xyz center, w radius
+uniform vec4 boundingSphere;
+// frame (column, row) of the atlas layer being drawn, the viewport covers it
+uniform ivec2 frame;
+uniform int framesPerSide;
+
+out VS_OUT {
+    vec3 normal;
+    vec2 uv;
+    float depth;
+} vs_out;
+
+// upper hemisphere direction of a point of the [0, 1]^2 hemi-octahedral square, must match impostor.vert
+vec3 hemiOctDecode(vec2 e) {
+    e = e * 2.0 - 1.0;
+    vec3 dir = vec3(0.5 * (e.x + e.y), 0.0, 0.5 * (e.x - e.y));
+    dir.y = 1.0 - abs(dir.x) - abs(dir.z);
+    return normalize(dir);
+}
+
+// image axes of the frame looking from dir, must match impostor.vert
+void frameBasis(vec3 dir, out vec3 right, out vec3 up) {
+    vec3 side = cross(vec3(0.0, 1.0, 0.0), dir);
+    right = dot(side, side) > 1e-8 ? normalize(side) : vec3(1.0, 0.0, 0.0);
+    up = cross(dir, right);
+}
+
+void main() {
+    vec3 dir = hemiOctDecode((vec2(frame) + 0.5) / float(framesPerSide));
+    vec3 right;
+    vec3 up;
+    frameBasis(dir, right, up);
+
+    // orthographic, the bounding sphere fills the frame; nearer to the viewer (+dir) is smaller depth
+    vec3 p = (inPosition - boundingSphere.xyz) / boundingSphere.w;
+    float towardViewer = dot(p, dir);
+    gl_Position = vec4(dot(p, right), dot(p, up), -towardViewer, 1.0);
+
+    vs_out.normal = inNormal;
+    vs_out.uv = inUV;
+    vs_out.depth = towardViewer * 0.5 + 0.5;
+}
@@ -0,0 +1,39 @@
+#version 430 core
+
+// heatmap of the foliage counts of a view (OverdrawCounter::draw), pixels without foliage are left as they are
+layout(location = 0) out vec4 fragColor;
+
+layout(r32ui, binding = 0) uniform readonly uimage2DArray countImage;
+
+uniform int view;
+uniform int debugView;
+uniform uint laneUnits;
+// lower left corner of the viewport, the counts start at 0
+uniform ivec2 viewportOrigin;
+
+const int DEBUG_VIEW_QUAD_OCCUPANCY = 4;
+
+// black - blue - cyan - green - yellow - red - white over 1 to 32 fragments, log scaled
+vec3 heat(float t) {
+    const vec3 ramp[7] = vec3[7](vec3(0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(1.0));
+    float x = clamp(t, 0.0, 1.0) * 6.0;
+    int i = min(int(x), 5);
+    return mix(ramp[i], ramp[i + 1], x - float(i));
+}
+
+void main() {
+    ivec2 p = ivec2(gl_FragCoord.xy) - viewportOrigin;
+    uint fragments = imageLoad(countImage, ivec3(p, 2 * view)).r;
+    if (fragments == 0u) {
+        discard;
+    }
+    if (debugView == DEBUG_VIEW_QUAD_OCCUPANCY) {
+        // covered / shaded lanes of the quads, 0.25 (one lane of four) red to 1 green
+        float occupancy = float(fragments * laneUnits) / float(max(imageLoad(countImage, ivec3(p, 2 * view + 1)).r, 1u));
+        float t = clamp((occupancy - 0.25) / 0.75, 0.0, 1.0);
+        fragColor = vec4(mix(vec3(1.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), t), 1.0);
+    }
+    else {
+        fragColor = vec4(heat((log2(float(fragments)) + 1.0) / 6.0), 1.0);
+    }
+}
@@ -9,9 +9,15 @@ in VS_OUT {
 } fs_in;
 
 uniform sampler2D albedoTexture;
-uniform vec3 cameraPos;
 uniform vec3 lightDir;
 
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
+
 const vec3 Ka = vec3(0.1);
 const vec3 Kd = vec3(0.8);
 const vec3 Ks = vec3(0.1);
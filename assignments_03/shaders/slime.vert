@@ -5,8 +5,13 @@ layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV;
 
 uniform mat4 modelMat;
-uniform mat4 viewMat;
-uniform mat4 projMat;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+    mat4 viewMat;
+    mat4 projMat;
+    vec3 cameraPos;
+};
 
 out VS_OUT {
     vec3 worldPos;
@@ -6,8 +6,13 @@ out vec3 f_worldVertex;
 out vec3 f_viewVertex;
 
 layout(location = 0) uniform mat4 modelMat ;
-layout(location = 1) uniform mat4 viewMat ;
-layout(location = 2) uniform mat4 projMat ;
+
+// camera of the viewport being drawn, see RenderingOrderExp::bindViewConstants
+layout(std140, binding = 0) uniform ViewConstants {
+	mat4 viewMat;
+	mat4 projMat;
+	vec3 cameraPos;
+};
 
 void main(){
 	vec4 worldVertex = modelMat * vec4(v_vertex, 1.0);
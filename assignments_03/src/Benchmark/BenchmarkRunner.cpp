@@ -0,0 +1,213 @@
+#include "BenchmarkRunner.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "../RenderWidgets/RenderingOrderExp.h"
+#include "../Rendering/FramePacer.h"
+#include "../Rendering/GpuProfiler.h"
+#include "../Rendering/OffscreenTarget.h"
+#include "../Rendering/OverdrawCounter.h"
+
+namespace INANOA {
+	namespace BENCHMARK {
+		namespace {
+			double elapsedMs(const std::chrono::steady_clock::time_point& from, const std::chrono::steady_clock::time_point& to) {
+				return std::chrono::duration<double, std::milli>(to - from).count();
+			}
+		}
+
+		BenchmarkRunner::BenchmarkRunner(const BenchmarkSettings& settings) :
+			m_settings(settings), m_statistics(std::max(settings.numFrames, 1)) {}
+
+		BenchmarkRunner::~BenchmarkRunner() {
+			if (this->m_queries[0] != 0u) {
+				glDeleteQueries(NUM_QUERY_SLOTS, this->m_queries);
+			}
+		}
+
+		bool BenchmarkRunner::run(RenderingOrderExp* renderer, OPENGL::OffscreenTarget* target) {
+			const int numFrames = std::max(this->m_settings.numFrames, 1);
+			const int warmupFrames = std::max(this->m_settings.warmupFrames, 0);
+
+			CameraPath path;
+			if (this->m_settings.pathFile.empty() == false) {
+				if (path.load(this->m_settings.pathFile) == false) {
+					std::cerr << "Failed to load camera path: " << this->m_settings.pathFile << std::endl;
+					return false;
+				}
+			}
+			else {
+				path = CameraPath::procedural(numFrames);
+			}
+
+			if (this->m_queries[0] == 0u) {
+				glGenQueries(NUM_QUERY_SLOTS, this->m_queries);
+			}
+
+			// frame times are only measured on the fully loaded scene
+			renderer->finishLoading();
+			renderer->setOcclusionCulling(this->m_settings.occlusionCulling);
+			renderer->setPrefixSumCompaction(this->m_settings.prefixSumCompaction);
+			renderer->setIndirectCountDraws(this->m_settings.indirectCountDraws);
+			renderer->setImpostors(this->m_settings.impostors);
+			renderer->setFoliagePass(this->m_settings.foliagePass);
+			renderer->setDebugView(this->m_settings.debugView);
+			OPENGL::OverdrawCounter* overdrawCounter = renderer->overdrawCounter();
+			if (this->m_settings.debugView != OPENGL::DebugViewType::NONE && overdrawCounter == nullptr) {
+				std::cerr << "Foliage debug views are not supported, no overdraw is reported" << std::endl;
+			}
+			OPENGL::FramePacer pacer;
+			pacer.setTargetFps(this->m_settings.fpsLimit);
+			const double simulationStep = renderer->simulationClock()->stepSeconds();
+			target->bind();
+			std::chrono::steady_clock::time_point prevFrameStart;
+			for (int frame = 0; frame < warmupFrames + numFrames; frame++) {
+				const int measuredFrame = frame - warmupFrames;
+				const float t = numFrames > 1 ? std::max(measuredFrame, 0) / static_cast<float>(numFrames - 1) : 0.0f;
+				const CameraPathKey key = path.sample(t);
+
+				const auto frameStart = std::chrono::steady_clock::now();
+				if (measuredFrame > 0) {
+					this->m_statistics.set("wall_ms", measuredFrame - 1, elapsedMs(prevFrameStart, frameStart));
+				}
+				prevFrameStart = frameStart;
+
+				// recycling a slot waits for the frame submitted NUM_QUERY_SLOTS frames ago,
+				// which also keeps the driver from queueing an unbounded number of frames
+				const int slot = frame % NUM_QUERY_SLOTS;
+				this->resolveQuery(slot);
+
+				renderer->setPlayerPose(key.eye, key.lookCenter);
+				renderer->setSlimePosition(key.slimePosition);
+
+				const auto cpuStart = std::chrono::steady_clock::now();
+				glBeginQuery(GL_TIME_ELAPSED, this->m_queries[slot]);
+				renderer->update(simulationStep);
+				renderer->render();
+				glEndQuery(GL_TIME_ELAPSED);
+				const auto cpuEnd = std::chrono::steady_clock::now();
+				this->m_queryFrame[slot] = frame;
+				glFlush();
+
+				if (measuredFrame >= 0) {
+					this->m_statistics.set("cpu_ms", measuredFrame, elapsedMs(cpuStart, cpuEnd));
+				}
+				this->collectProfilerFrames(renderer->profiler());
+				this->collectOverdrawFrames(overdrawCounter);
+				pacer.wait();
+			}
+			glFinish();
+			this->m_statistics.set("wall_ms", numFrames - 1, elapsedMs(prevFrameStart, std::chrono::steady_clock::now()));
+			for (int slot = 0; slot < NUM_QUERY_SLOTS; slot++) {
+				this->resolveQuery(slot);
+			}
+			renderer->profiler()->flush();
+			this->collectProfilerFrames(renderer->profiler());
+			if (overdrawCounter != nullptr) {
+				overdrawCounter->flush();
+				this->collectOverdrawFrames(overdrawCounter);
+			}
+			target->unbind();
+
+			this->m_foliagePass = renderer->activeFoliagePass();
+			if (this->m_foliagePass != this->m_settings.foliagePass) {
+				std::cerr << "Foliage pass " << foliagePassName(this->m_settings.foliagePass) << " is not available, the foliage was drawn with " << foliagePassName(this->m_foliagePass) << std::endl;
+			}
+			return true;
+		}
+
+		void BenchmarkRunner::resolveQuery(const int slot) {
+			const int frame = this->m_queryFrame[slot];
+			if (frame < 0) {
+				return;
+			}
+			GLuint64 elapsedNs = 0u;
+			glGetQueryObjectui64v(this->m_queries[slot], GL_QUERY_RESULT, &elapsedNs);
+			this->m_queryFrame[slot] = -1;
+
+			const int measuredFrame = frame - std::max(this->m_settings.warmupFrames, 0);
+			if (measuredFrame >= 0) {
+				this->m_statistics.set("gpu_ms", measuredFrame, elapsedNs / 1.0e6);
+			}
+		}
+
+		void BenchmarkRunner::collectProfilerFrames(OPENGL::GpuProfiler* profiler) {
+			// the renderer's profiler counts render() calls, which is the benchmark frame index
+			OPENGL::GpuProfiler::FrameResult frame;
+			while (profiler->popFrame(frame)) {
+				const int measuredFrame = frame.frameIndex - std::max(this->m_settings.warmupFrames, 0);
+				if (measuredFrame < 0) {
+					continue;
+				}
+				for (const OPENGL::GpuProfiler::ScopeResult& scope : frame.scopes) {
+					this->m_statistics.set("cpu." + scope.name, measuredFrame, scope.cpuMs);
+					this->m_statistics.set("gpu." + scope.name, measuredFrame, scope.gpuMs);
+				}
+			}
+		}
+
+		void BenchmarkRunner::collectOverdrawFrames(OPENGL::OverdrawCounter* counter) {
+			if (counter == nullptr) {
+				return;
+			}
+			// counts render() calls like the profiler
+			OPENGL::OverdrawCounter::FrameResult frame;
+			while (counter->popFrame(frame)) {
+				const int measuredFrame = frame.frameIndex - std::max(this->m_settings.warmupFrames, 0);
+				if (measuredFrame < 0) {
+					continue;
+				}
+				for (const OPENGL::OverdrawCounter::ViewStats& view : frame.views) {
+					if (view.valid == false) {
+						continue;
+					}
+					const std::string prefix = std::string("overdraw.") + view.name;
+					this->m_statistics.set(prefix + ".avg", measuredFrame, view.averageOverdraw);
+					this->m_statistics.set(prefix + ".covered", measuredFrame, view.coveredOverdraw);
+					this->m_statistics.set(prefix + ".max", measuredFrame, static_cast<double>(view.maxOverdraw));
+					this->m_statistics.set(prefix + ".quad", measuredFrame, view.quadOccupancy);
+				}
+			}
+		}
+
+		bool BenchmarkRunner::writeReports() const {
+			const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+			const char* glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+			std::vector<std::pair<std::string, std::string>> metadata = {
+				{ "renderer", glRenderer != nullptr ? glRenderer : "unknown" },
+				{ "version", glVersion != nullptr ? glVersion : "unknown" },
+				{ "resolution", std::to_string(this->m_settings.width) + "x" + std::to_string(this->m_settings.height) },
+				{ "path", this->m_settings.pathFile.empty() ? "procedural" : this->m_settings.pathFile },
+				{ "warmup_frames", std::to_string(this->m_settings.warmupFrames) },
+				{ "occlusion_culling", this->m_settings.occlusionCulling ? "on" : "off" },
+				{ "compaction", this->m_settings.prefixSumCompaction ? "prefix_sum" : "atomic" },
+				{ "draw_lists", this->m_settings.indirectCountDraws ? "indirect_count" : "full" },
+				{ "impostors", this->m_settings.impostors ? "on" : "off" },
+				{ "foliage_pass", foliagePassName(this->m_foliagePass) },
+				{ "debug_view", OPENGL::debugViewName(this->m_settings.debugView) },
+				{ "fps_limit", this->m_settings.fpsLimit > 0.0 ? std::to_string(this->m_settings.fpsLimit) : "off" }
+			};
+
+			const std::string jsonFile = this->m_settings.outputPrefix + ".json";
+			const std::string csvFile = this->m_settings.outputPrefix + ".csv";
+			if (this->m_statistics.writeJson(jsonFile, metadata) == false) {
+				std::cerr << "Failed to write " << jsonFile << std::endl;
+				return false;
+			}
+			if (this->m_statistics.writeCsv(csvFile) == false) {
+				std::cerr << "Failed to write " << csvFile << std::endl;
+				return false;
+			}
+
+			for (const std::string& channel : this->m_statistics.channels()) {
+				const FrameStatistics::Summary s = this->m_statistics.summarize(channel);
+				// the overdraw channels are fragments per pixel / lane ratios, the rest milliseconds
+				const char* unit = channel.compare(0, 9, "overdraw.") == 0 ? "" : "ms, ";
+				std::cout << channel << ": p50 " << s.p50 << " p95 " << s.p95 << " p99 " << s.p99 << " (" << unit << s.count << " frames)" << std::endl;
+			}
+			return true;
+		}
+	}
+}
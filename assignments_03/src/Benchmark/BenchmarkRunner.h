@@ -0,0 +1,88 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "CameraPath.h"
+#include "FrameStatistics.h"
+#include "../Rendering/RendererBase.h"
+#include "../RenderWidgets/FoliagePass.h"
+
+namespace INANOA {
+	class RenderingOrderExp;
+
+	namespace OPENGL {
+		class OffscreenTarget;
+		class GpuProfiler;
+		class OverdrawCounter;
+	}
+
+	namespace BENCHMARK {
+		struct BenchmarkSettings {
+			int numFrames = 600;
+			int warmupFrames = 60;
+			int width = 1344;
+			int height = 756;
+			// recorded path (CameraPath text format), procedural path when empty
+			std::string pathFile;
+			// <prefix>.json (summary) and <prefix>.csv (per frame) are written
+			std::string outputPrefix = "benchmark";
+			// two-phase Hi-Z occlusion culling of the player view
+			bool occlusionCulling = true;
+			// stable prefix sum compaction of the culling survivors, atomic appends otherwise
+			bool prefixSumCompaction = true;
+			// compacted foliage draw lists with a GPU draw count, when the context supports them
+			bool indirectCountDraws = true;
+			// far foliage as octahedral impostors (species with an impostor distance)
+			bool impostors = true;
+			// depth pre-pass / alpha to coverage instead of the alpha tested foliage shading
+			FoliagePass foliagePass = FoliagePass::ALPHA_TEST;
+			// foliage debug shading, any debug view also reports the overdraw per viewport
+			OPENGL::DebugViewType debugView = OPENGL::DebugViewType::NONE;
+			// frames per second the loop is paced at, 0: as fast as possible. The simulation advances one
+			// fixed step per frame either way, so the path and the slime do not depend on it
+			double fpsLimit = 0.0;
+		};
+
+		// Drives RenderingOrderExp along a camera/slime path into an offscreen target and collects
+		// per-frame CPU submission time and GPU time. GPU times come from a small ring of
+		// GL_TIME_ELAPSED queries that are read back a few frames later so the pipeline never drains.
+		// The per-pass scopes of the renderer's GpuProfiler are exported as "cpu.<pass>"/"gpu.<pass>",
+		// with a debug view the foliage overdraw as "overdraw.<viewport>.avg/.covered/.max/.quad".
+		class BenchmarkRunner
+		{
+		public:
+			explicit BenchmarkRunner(const BenchmarkSettings& settings);
+			virtual ~BenchmarkRunner();
+
+			BenchmarkRunner(const BenchmarkRunner&) = delete;
+			BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+
+		public:
+			bool run(RenderingOrderExp* renderer, OPENGL::OffscreenTarget* target);
+			bool writeReports() const;
+
+		public:
+			inline const FrameStatistics& statistics() const { return this->m_statistics; }
+
+		private:
+			void resolveQuery(const int slot);
+			void collectProfilerFrames(OPENGL::GpuProfiler* profiler);
+			void collectOverdrawFrames(OPENGL::OverdrawCounter* counter);
+
+		private:
+			// one less than the profiler's frame slots so its non-blocking readback never drops a frame
+			static const int NUM_QUERY_SLOTS = 3;
+
+			const BenchmarkSettings m_settings;
+			FrameStatistics m_statistics;
+			// the foliage pass that was drawn, ALPHA_TEST when the renderer fell back from the requested one
+			FoliagePass m_foliagePass = FoliagePass::ALPHA_TEST;
+
+			GLuint m_queries[NUM_QUERY_SLOTS] = { 0u };
+			int m_queryFrame[NUM_QUERY_SLOTS] = { -1, -1, -1 };
+		};
+	}
+}
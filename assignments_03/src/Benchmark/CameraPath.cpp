@@ -0,0 +1,102 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+#include <glm/gtc/constants.hpp>
+#include <glm/geometric.hpp>
+
+namespace INANOA {
+	namespace BENCHMARK {
+		CameraPath::CameraPath() {}
+		CameraPath::~CameraPath() {}
+
+		bool CameraPath::load(const std::string& filename) {
+			std::ifstream input(filename);
+			if (!input.is_open()) {
+				return false;
+			}
+			this->m_keys.clear();
+
+			// one key per line: eye.xyz lookCenter.xyz slime.xyz, '#' starts a comment
+			std::string line;
+			while (std::getline(input, line)) {
+				if (line.empty() || line[0] == '#') {
+					continue;
+				}
+				std::istringstream lineStream(line);
+				CameraPathKey key;
+				lineStream >> key.eye.x >> key.eye.y >> key.eye.z
+					>> key.lookCenter.x >> key.lookCenter.y >> key.lookCenter.z
+					>> key.slimePosition.x >> key.slimePosition.y >> key.slimePosition.z;
+				if (lineStream.fail()) {
+					continue;
+				}
+				this->m_keys.push_back(key);
+			}
+			return this->m_keys.empty() == false;
+		}
+
+		bool CameraPath::save(const std::string& filename) const {
+			std::ofstream output(filename);
+			if (!output.is_open()) {
+				return false;
+			}
+			output << "# eye.xyz lookCenter.xyz slime.xyz\n";
+			for (const CameraPathKey& key : this->m_keys) {
+				output << key.eye.x << " " << key.eye.y << " " << key.eye.z << " "
+					<< key.lookCenter.x << " " << key.lookCenter.y << " " << key.lookCenter.z << " "
+					<< key.slimePosition.x << " " << key.slimePosition.y << " " << key.slimePosition.z << "\n";
+			}
+			return true;
+		}
+
+		void CameraPath::append(const CameraPathKey& key) {
+			this->m_keys.push_back(key);
+		}
+		void CameraPath::clear() {
+			this->m_keys.clear();
+		}
+
+		CameraPathKey CameraPath::sample(const float t) const {
+			if (this->m_keys.empty()) {
+				return CameraPathKey();
+			}
+			if (this->m_keys.size() == 1) {
+				return this->m_keys[0];
+			}
+			const float pos = glm::clamp(t, 0.0f, 1.0f) * static_cast<float>(this->m_keys.size() - 1);
+			const size_t i0 = std::min(static_cast<size_t>(pos), this->m_keys.size() - 2);
+			const float f = pos - static_cast<float>(i0);
+
+			const CameraPathKey& a = this->m_keys[i0];
+			const CameraPathKey& b = this->m_keys[i0 + 1];
+			CameraPathKey key;
+			key.eye = glm::mix(a.eye, b.eye, f);
+			key.lookCenter = glm::mix(a.lookCenter, b.lookCenter, f);
+			key.slimePosition = glm::mix(a.slimePosition, b.slimePosition, f);
+			return key;
+		}
+
+		CameraPath CameraPath::procedural(const int numKeys) {
+			const float TWO_PI = glm::two_pi<float>();
+			CameraPath path;
+			const int n = std::max(numKeys, 2);
+			for (int i = 0; i < n; i++) {
+				const float t = static_cast<float>(i) / static_cast<float>(n - 1);
+				const float yaw = 0.4f * std::sin(2.0f * TWO_PI * t);
+				const glm::vec3 forward(std::sin(yaw), 0.0f, -std::cos(yaw));
+				const glm::vec3 right(-forward.z, 0.0f, forward.x);
+
+				CameraPathKey key;
+				key.eye = glm::vec3(20.0f * std::sin(TWO_PI * t), 10.0f, -200.0f * t);
+				key.lookCenter = key.eye + 5.0f * forward + glm::vec3(0.0f, -0.5f, 0.0f);
+				key.slimePosition = glm::vec3(key.eye.x, 0.0f, key.eye.z) + 15.0f * forward + 8.0f * std::sin(3.0f * TWO_PI * t) * right;
+				path.append(key);
+			}
+			return path;
+		}
+	}
+}
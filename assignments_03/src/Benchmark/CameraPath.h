@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <glm/vec3.hpp>
+
+namespace INANOA {
+	namespace BENCHMARK {
+		struct CameraPathKey {
+			glm::vec3 eye = glm::vec3(0.0f);
+			glm::vec3 lookCenter = glm::vec3(0.0f, 0.0f, -1.0f);
+			glm::vec3 slimePosition = glm::vec3(0.0f);
+		};
+
+		// Sequence of player camera + slime poses. Either recorded from an interactive session
+		// (one key per frame, plain text) or generated procedurally. Sampling is done with a
+		// normalized parameter so a path can be replayed for any number of frames.
+		class CameraPath
+		{
+		public:
+			explicit CameraPath();
+			virtual ~CameraPath();
+
+		public:
+			bool load(const std::string& filename);
+			bool save(const std::string& filename) const;
+
+			void append(const CameraPathKey& key);
+			void clear();
+
+			// t in [0, 1], linear interpolation between neighboring keys
+			CameraPathKey sample(const float t) const;
+
+		public:
+			inline bool empty() const { return this->m_keys.empty(); }
+			inline size_t numKeys() const { return this->m_keys.size(); }
+
+		public:
+			// walk through the foliage field along -z with a slow sway, slime crossing in front of the player
+			static CameraPath procedural(const int numKeys);
+
+		private:
+			std::vector<CameraPathKey> m_keys;
+		};
+	}
+}
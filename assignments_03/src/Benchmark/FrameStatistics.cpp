@@ -0,0 +1,144 @@
+#include "FrameStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+
+namespace INANOA {
+	namespace BENCHMARK {
+		namespace {
+			std::string escapeJson(const std::string& text) {
+				std::string escaped;
+				escaped.reserve(text.size());
+				for (const char c : text) {
+					if (c == '"' || c == '\\') {
+						escaped.push_back('\\');
+					}
+					escaped.push_back(c);
+				}
+				return escaped;
+			}
+		}
+
+		FrameStatistics::FrameStatistics(const int numFrames) : m_numFrames(numFrames) {}
+		FrameStatistics::~FrameStatistics() {}
+
+		int FrameStatistics::findChannel(const std::string& channel) const {
+			for (size_t i = 0; i < this->m_channelNames.size(); i++) {
+				if (this->m_channelNames[i] == channel) {
+					return static_cast<int>(i);
+				}
+			}
+			return -1;
+		}
+		int FrameStatistics::channelIndex(const std::string& channel) {
+			const int idx = this->findChannel(channel);
+			if (idx >= 0) {
+				return idx;
+			}
+			this->m_channelNames.push_back(channel);
+			this->m_channelValues.emplace_back(this->m_numFrames, std::numeric_limits<double>::quiet_NaN());
+			return static_cast<int>(this->m_channelNames.size() - 1);
+		}
+
+		void FrameStatistics::set(const std::string& channel, const int frame, const double value) {
+			if (frame < 0 || frame >= this->m_numFrames) {
+				return;
+			}
+			const int idx = this->channelIndex(channel);
+			this->m_channelValues[idx][frame] = value;
+		}
+
+		FrameStatistics::Summary FrameStatistics::summarize(const std::string& channel) const {
+			Summary summary;
+			const int idx = this->findChannel(channel);
+			if (idx < 0) {
+				return summary;
+			}
+			std::vector<double> values;
+			values.reserve(this->m_numFrames);
+			for (const double v : this->m_channelValues[idx]) {
+				if (std::isnan(v) == false) {
+					values.push_back(v);
+				}
+			}
+			if (values.empty()) {
+				return summary;
+			}
+			std::sort(values.begin(), values.end());
+
+			double sum = 0.0;
+			for (const double v : values) {
+				sum = sum + v;
+			}
+			summary.count = static_cast<int>(values.size());
+			summary.mean = sum / values.size();
+			summary.min = values.front();
+			summary.max = values.back();
+			summary.p50 = FrameStatistics::percentile(values, 50.0);
+			summary.p95 = FrameStatistics::percentile(values, 95.0);
+			summary.p99 = FrameStatistics::percentile(values, 99.0);
+			return summary;
+		}
+
+		double FrameStatistics::percentile(const std::vector<double>& sortedValues, const double p) {
+			if (sortedValues.empty()) {
+				return 0.0;
+			}
+			const double rank = std::ceil(p / 100.0 * sortedValues.size());
+			const size_t idx = static_cast<size_t>(std::max(rank, 1.0)) - 1;
+			return sortedValues[std::min(idx, sortedValues.size() - 1)];
+		}
+
+		bool FrameStatistics::writeCsv(const std::string& filename) const {
+			std::ofstream output(filename);
+			if (!output.is_open()) {
+				return false;
+			}
+			output << "frame";
+			for (const std::string& name : this->m_channelNames) {
+				output << "," << name;
+			}
+			output << "\n";
+			for (int frame = 0; frame < this->m_numFrames; frame++) {
+				output << frame;
+				for (const std::vector<double>& values : this->m_channelValues) {
+					output << ",";
+					if (std::isnan(values[frame]) == false) {
+						output << values[frame];
+					}
+				}
+				output << "\n";
+			}
+			return true;
+		}
+
+		bool FrameStatistics::writeJson(const std::string& filename, const std::vector<std::pair<std::string, std::string>>& metadata) const {
+			std::ofstream output(filename);
+			if (!output.is_open()) {
+				return false;
+			}
+			output << "{\n";
+			for (const auto& entry : metadata) {
+				output << "  \"" << escapeJson(entry.first) << "\": \"" << escapeJson(entry.second) << "\",\n";
+			}
+			output << "  \"frames\": " << this->m_numFrames << ",\n";
+			output << "  \"channels\": {";
+			for (size_t i = 0; i < this->m_channelNames.size(); i++) {
+				const Summary s = this->summarize(this->m_channelNames[i]);
+				output << (i == 0 ? "\n" : ",\n");
+				output << "    \"" << this->m_channelNames[i] << "\": { "
+					<< "\"count\": " << s.count << ", "
+					<< "\"mean\": " << s.mean << ", "
+					<< "\"min\": " << s.min << ", "
+					<< "\"p50\": " << s.p50 << ", "
+					<< "\"p95\": " << s.p95 << ", "
+					<< "\"p99\": " << s.p99 << ", "
+					<< "\"max\": " << s.max << " }";
+			}
+			output << "\n  }\n}\n";
+			return true;
+		}
+	}
+}
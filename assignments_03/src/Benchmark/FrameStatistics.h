@@ -0,0 +1,54 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace INANOA {
+	namespace BENCHMARK {
+		// Per-frame timing samples grouped in named channels (e.g. "cpu_ms", "gpu_ms").
+		// A sample that never arrived (e.g. a GPU query that was not resolved) stays NaN and is
+		// ignored by the summary.
+		class FrameStatistics
+		{
+		public:
+			struct Summary {
+				int count = 0;
+				double mean = 0.0;
+				double min = 0.0;
+				double p50 = 0.0;
+				double p95 = 0.0;
+				double p99 = 0.0;
+				double max = 0.0;
+			};
+
+		public:
+			explicit FrameStatistics(const int numFrames);
+			virtual ~FrameStatistics();
+
+		public:
+			void set(const std::string& channel, const int frame, const double value);
+			Summary summarize(const std::string& channel) const;
+
+			bool writeCsv(const std::string& filename) const;
+			bool writeJson(const std::string& filename, const std::vector<std::pair<std::string, std::string>>& metadata) const;
+
+		public:
+			inline int numFrames() const { return this->m_numFrames; }
+			inline const std::vector<std::string>& channels() const { return this->m_channelNames; }
+
+		public:
+			// nearest-rank percentile, p in [0, 100], values must be sorted
+			static double percentile(const std::vector<double>& sortedValues, const double p);
+
+		private:
+			int channelIndex(const std::string& channel);
+			int findChannel(const std::string& channel) const;
+
+		private:
+			const int m_numFrames;
+			std::vector<std::string> m_channelNames;
+			std::vector<std::vector<double>> m_channelValues;
+		};
+	}
+}
@@ -0,0 +1,246 @@
+#include "InstanceLayoutBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "../Rendering/Camera/Camera.h"
+#include "../Rendering/Shader.h"
+
+namespace INANOA {
+	namespace BENCHMARK {
+		namespace {
+			// same edge as INSTANCE_CELL_SIZE of the renderer
+			constexpr float CELL_SIZE = 8.0f;
+			// roughly the grass blade sphere
+			const glm::vec4 MESH_SPHERE = glm::vec4(0.0f, 0.5f, 0.0f, 0.8f);
+
+			struct UnpackedInstanceGPU {
+				glm::vec4 position;
+				glm::ivec4 indices;
+			};
+			struct PackedInstanceGPU {
+				GLuint words[3];
+			};
+			struct InstanceCellGPU {
+				glm::vec4 boundsMin;
+				glm::vec4 boundsMax;
+				glm::uvec4 range;
+			};
+			struct InstancePropertiesGPU {
+				glm::vec3 position;
+				GLuint transform;
+			};
+		}
+
+		InstanceLayoutBenchmark::InstanceLayoutBenchmark(const InstanceLayoutSettings& settings) :
+			m_settings(settings), m_statistics(std::max(settings.numIterations, 1)) {}
+
+		InstanceLayoutBenchmark::~InstanceLayoutBenchmark() {
+			const GLuint buffers[] = { this->m_unpackedSSBO, this->m_packedSSBO, this->m_cellSSBO, this->m_visibleSSBO, this->m_counterSSBO };
+			for (const GLuint buffer : buffers) {
+				if (buffer != 0u) {
+					glDeleteBuffers(1, &buffer);
+				}
+			}
+			if (this->m_query != 0u) {
+				glDeleteQueries(1, &this->m_query);
+			}
+			delete this->m_shader;
+		}
+
+		bool InstanceLayoutBenchmark::initializeField() {
+			this->m_shader = OPENGL::ShaderProgram::createShaderProgramForComputeShader("shaders/instance_layout_bench.comp");
+			if (this->m_shader == nullptr) {
+				std::cerr << "Failed to create instance layout benchmark shader" << std::endl;
+				return false;
+			}
+			this->m_packedLayoutLoc = glGetUniformLocation(this->m_shader->programId(), "packedLayout");
+			this->m_frustumPlanesLoc = glGetUniformLocation(this->m_shader->programId(), "frustumPlanes");
+			this->m_meshSphereLoc = glGetUniformLocation(this->m_shader->programId(), "meshSphere");
+
+			// square grid of cells, uniformly scattered instances inside each
+			const GLuint numInstances = static_cast<GLuint>(std::max(this->m_settings.numInstances, 1));
+			this->m_numCells = (numInstances + INSTANCES_PER_CELL - 1) / INSTANCES_PER_CELL;
+			const GLuint gridWidth = static_cast<GLuint>(std::ceil(std::sqrt(static_cast<double>(this->m_numCells))));
+			const float fieldHalfWidth = 0.5f * CELL_SIZE * static_cast<float>(gridWidth);
+
+			std::mt19937 rng(1234u);
+			std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+			std::vector<UnpackedInstanceGPU> unpacked(numInstances);
+			std::vector<PackedInstanceGPU> packed(numInstances);
+			std::vector<InstanceCellGPU> cells(this->m_numCells);
+			for (GLuint cellID = 0u; cellID < this->m_numCells; ++cellID) {
+				const glm::vec3 origin(static_cast<float>(cellID % gridWidth) * CELL_SIZE - fieldHalfWidth, 0.0f, static_cast<float>(cellID / gridWidth) * CELL_SIZE - fieldHalfWidth);
+				const GLuint first = cellID * INSTANCES_PER_CELL;
+				const GLuint count = std::min(static_cast<GLuint>(INSTANCES_PER_CELL), numInstances - first);
+
+				InstanceCellGPU& cell = cells[cellID];
+				cell.boundsMin = glm::vec4(origin + glm::vec3(MESH_SPHERE) - MESH_SPHERE.w, 0.0f);
+				cell.boundsMax = glm::vec4(origin + glm::vec3(CELL_SIZE, 0.0f, CELL_SIZE) + glm::vec3(MESH_SPHERE) + MESH_SPHERE.w, 0.0f);
+				cell.boundsMin = glm::min(cell.boundsMin, glm::vec4(origin, 0.0f));
+				cell.range = glm::uvec4(first, count, 0u, 0u);
+
+				const glm::vec3 extent = glm::vec3(cell.boundsMax - cell.boundsMin);
+				for (GLuint i = first; i < first + count; ++i) {
+					const glm::vec3 position = origin + glm::vec3(unit(rng) * CELL_SIZE, 0.0f, unit(rng) * CELL_SIZE);
+					const GLuint transform = static_cast<GLuint>(unit(rng) * 65535.0f) | (128u << 16);
+					unpacked[i].position = glm::vec4(position, 0.0f);
+					unpacked[i].indices = glm::ivec4(0, 0, static_cast<int>(transform), 0);
+
+					const glm::uvec3 q = glm::uvec3(glm::clamp((position - glm::vec3(cell.boundsMin)) / extent, 0.0f, 1.0f) * 65535.0f + 0.5f);
+					packed[i].words[0] = q.x | (q.y << 16);
+					packed[i].words[1] = q.z;
+					packed[i].words[2] = transform;
+				}
+			}
+
+			glGenBuffers(1, &this->m_unpackedSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_unpackedSSBO);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, unpacked.size() * sizeof(UnpackedInstanceGPU), unpacked.data(), GL_STATIC_DRAW);
+
+			glGenBuffers(1, &this->m_packedSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_packedSSBO);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, packed.size() * sizeof(PackedInstanceGPU), packed.data(), GL_STATIC_DRAW);
+
+			glGenBuffers(1, &this->m_cellSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_cellSSBO);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, cells.size() * sizeof(InstanceCellGPU), cells.data(), GL_STATIC_DRAW);
+
+			glGenBuffers(1, &this->m_visibleSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_visibleSSBO);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, numInstances * sizeof(InstancePropertiesGPU), nullptr, GL_DYNAMIC_DRAW);
+
+			glGenBuffers(1, &this->m_counterSSBO);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_counterSSBO);
+			glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+			glGenQueries(1, &this->m_query);
+
+			// player-like camera in the middle of the field; every cell is dispatched regardless,
+			// so both layouts read the whole field
+			Camera camera(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 9.5f, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f, 45.0f, 1.0f, 150.0f);
+			camera.resize(1344, 756);
+			camera.update();
+			glm::vec4 frustumPlanes[6];
+			camera.viewFrustumPlanesInWorldSpace(frustumPlanes);
+
+			glUseProgram(this->m_shader->programId());
+			glUniform4fv(this->m_frustumPlanesLoc, 6, glm::value_ptr(frustumPlanes[0]));
+			glUniform4fv(this->m_meshSphereLoc, 1, glm::value_ptr(MESH_SPHERE));
+			glUseProgram(0);
+			return true;
+		}
+
+		double InstanceLayoutBenchmark::cull(const bool packedLayout, GLuint& visibleCount, double& wallMs) {
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_counterSSBO);
+			glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+			glUseProgram(this->m_shader->programId());
+			glUniform1i(this->m_packedLayoutLoc, packedLayout ? 1 : 0);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, this->m_unpackedSSBO);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, this->m_packedSSBO);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, this->m_visibleSSBO);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, this->m_counterSSBO);
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, this->m_cellSSBO);
+
+			glFinish();
+			const std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+			glBeginQuery(GL_TIME_ELAPSED, this->m_query);
+			glDispatchCompute(this->m_numCells, 1, 1);
+			glEndQuery(GL_TIME_ELAPSED);
+			glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+			// software rasterizers do not always resolve timer queries, the wall time of the
+			// isolated dispatch is kept as well
+			glFinish();
+			wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+			// the benchmark measures one dispatch at a time, waiting here is intended
+			GLuint64 elapsedNs = 0u;
+			glGetQueryObjectui64v(this->m_query, GL_QUERY_RESULT, &elapsedNs);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_counterSSBO);
+			glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &visibleCount);
+			glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+			glUseProgram(0);
+			return static_cast<double>(elapsedNs) / 1.0e6;
+		}
+
+		bool InstanceLayoutBenchmark::run() {
+			if (this->initializeField() == false) {
+				return false;
+			}
+			const int numIterations = std::max(this->m_settings.numIterations, 1);
+			const int warmupIterations = std::max(this->m_settings.warmupIterations, 0);
+			for (int iteration = 0; iteration < warmupIterations + numIterations; iteration++) {
+				// alternate the order so neither layout always runs on a warm cache
+				const bool packedFirst = (iteration % 2) == 1;
+				GLuint unpackedVisible = 0u;
+				GLuint packedVisible = 0u;
+				double unpackedMs = 0.0;
+				double packedMs = 0.0;
+				double unpackedWallMs = 0.0;
+				double packedWallMs = 0.0;
+				if (packedFirst) {
+					packedMs = this->cull(true, packedVisible, packedWallMs);
+					unpackedMs = this->cull(false, unpackedVisible, unpackedWallMs);
+				}
+				else {
+					unpackedMs = this->cull(false, unpackedVisible, unpackedWallMs);
+					packedMs = this->cull(true, packedVisible, packedWallMs);
+				}
+				// quantization may move an instance across a plane, never more than a handful
+				this->m_visibleCount = packedVisible;
+				this->m_visibleCountDelta = static_cast<int>(packedVisible) - static_cast<int>(unpackedVisible);
+
+				const int measured = iteration - warmupIterations;
+				if (measured >= 0) {
+					this->m_statistics.set("gpu.unpacked", measured, unpackedMs);
+					this->m_statistics.set("gpu.packed", measured, packedMs);
+					this->m_statistics.set("wall.unpacked", measured, unpackedWallMs);
+					this->m_statistics.set("wall.packed", measured, packedWallMs);
+				}
+			}
+			return true;
+		}
+
+		bool InstanceLayoutBenchmark::writeReports() const {
+			const char* glRenderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+			const char* glVersion = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+			const std::vector<std::pair<std::string, std::string>> metadata = {
+				{ "renderer", glRenderer != nullptr ? glRenderer : "unknown" },
+				{ "version", glVersion != nullptr ? glVersion : "unknown" },
+				{ "instances", std::to_string(this->m_settings.numInstances) },
+				{ "visible_instances", std::to_string(this->m_visibleCount) },
+				{ "visible_instances_packed_minus_unpacked", std::to_string(this->m_visibleCountDelta) },
+				{ "unpacked_bytes_per_instance", std::to_string(sizeof(UnpackedInstanceGPU)) },
+				{ "packed_bytes_per_instance", std::to_string(sizeof(PackedInstanceGPU)) },
+				{ "warmup_iterations", std::to_string(this->m_settings.warmupIterations) }
+			};
+
+			const std::string jsonFile = this->m_settings.outputPrefix + ".json";
+			const std::string csvFile = this->m_settings.outputPrefix + ".csv";
+			if (this->m_statistics.writeJson(jsonFile, metadata) == false) {
+				std::cerr << "Failed to write " << jsonFile << std::endl;
+				return false;
+			}
+			if (this->m_statistics.writeCsv(csvFile) == false) {
+				std::cerr << "Failed to write " << csvFile << std::endl;
+				return false;
+			}
+
+			for (const std::string& channel : this->m_statistics.channels()) {
+				const FrameStatistics::Summary s = this->m_statistics.summarize(channel);
+				std::cout << channel << ": p50 " << s.p50 << " p95 " << s.p95 << " p99 " << s.p99 << " (ms, " << s.count << " iterations)" << std::endl;
+			}
+			return true;
+		}
+	}
+}
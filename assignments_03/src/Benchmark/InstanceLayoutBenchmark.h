@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+
+#include <glad/glad.h>
+
+#include "FrameStatistics.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		class ShaderProgram;
+	}
+
+	namespace BENCHMARK {
+		struct InstanceLayoutSettings {
+			// synthetic instances, binned into cells of INSTANCES_PER_CELL
+			int numInstances = 1 << 21;
+			int numIterations = 60;
+			int warmupIterations = 5;
+			// <prefix>.json (summary) and <prefix>.csv (per iteration) are written
+			std::string outputPrefix = "layout_benchmark";
+		};
+
+		// Culls the same synthetic foliage field with the unpacked 32 byte instance record
+		// (vec4 position + ivec4 indices) and the packed 12 byte one the renderer uses (cell-relative
+		// unorm16 position, 8 bit mesh, packed transform), one work group per cell like
+		// foliage_cull.comp, and reports the GPU time of each as "gpu.unpacked" / "gpu.packed"
+		// (plus the wall time of the isolated dispatch as "wall.unpacked" / "wall.packed").
+		class InstanceLayoutBenchmark
+		{
+		public:
+			explicit InstanceLayoutBenchmark(const InstanceLayoutSettings& settings);
+			virtual ~InstanceLayoutBenchmark();
+
+			InstanceLayoutBenchmark(const InstanceLayoutBenchmark&) = delete;
+			InstanceLayoutBenchmark& operator=(const InstanceLayoutBenchmark&) = delete;
+
+		public:
+			bool run();
+			bool writeReports() const;
+
+		public:
+			inline const FrameStatistics& statistics() const { return this->m_statistics; }
+
+		private:
+			bool initializeField();
+			// GPU time in ms of one culling dispatch, visibleCount receives the survivors and
+			// wallMs the CPU-observed time of the dispatch
+			double cull(const bool packedLayout, GLuint& visibleCount, double& wallMs);
+
+		private:
+			static const int INSTANCES_PER_CELL = 256;
+
+			const InstanceLayoutSettings m_settings;
+			FrameStatistics m_statistics;
+
+			OPENGL::ShaderProgram* m_shader = nullptr;
+			GLint m_packedLayoutLoc = -1;
+			GLint m_frustumPlanesLoc = -1;
+			GLint m_meshSphereLoc = -1;
+
+			GLuint m_unpackedSSBO = 0u;
+			GLuint m_packedSSBO = 0u;
+			GLuint m_cellSSBO = 0u;
+			GLuint m_visibleSSBO = 0u;
+			GLuint m_counterSSBO = 0u;
+			GLuint m_query = 0u;
+			GLuint m_numCells = 0u;
+			GLuint m_visibleCount = 0u;
+			int m_visibleCountDelta = 0;
+		};
+	}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+
+namespace INANOA {
+        // how the foliage meshes resolve their alpha tested texels, see RenderingOrderExp::renderFoliage
+        enum class FoliagePass : int {
+                // discard in the shading pass (foliage_instancing.frag), no early depth test
+                ALPHA_TEST = 0,
+                // alpha tested depth-only pass, then shading with GL_EQUAL depth and no discard
+                DEPTH_PREPASS = 1,
+                // no discard, alpha becomes the sample coverage of a multisample player view;
+                // the god view stays alpha tested
+                ALPHA_TO_COVERAGE = 2
+        };
+        constexpr int NUM_FOLIAGE_PASSES = 3;
+
+        // command line / benchmark report names
+        inline const char* foliagePassName(const FoliagePass pass) {
+                switch (pass) {
+                case FoliagePass::DEPTH_PREPASS:
+                        return "depth-prepass";
+                case FoliagePass::ALPHA_TO_COVERAGE:
+                        return "alpha-to-coverage";
+                default:
+                        return "alpha-test";
+                }
+        }
+
+        inline bool parseFoliagePass(const std::string& name, FoliagePass& pass) {
+                for (int i = 0; i < NUM_FOLIAGE_PASSES; ++i) {
+                        if (name == foliagePassName(static_cast<FoliagePass>(i))) {
+                                pass = static_cast<FoliagePass>(i);
+                                return true;
+                        }
+                }
+                return false;
+        }
+}
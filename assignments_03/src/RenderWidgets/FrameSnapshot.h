@@ -0,0 +1,31 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "../Rendering/RendererBase.h"
+#include "FoliagePass.h"
+
+namespace INANOA {
+        // renderer toggles of the GUI / the benchmark settings
+        struct RenderSettings {
+                bool occlusionCulling = true;
+                bool prefixSumCompaction = true;
+                bool indirectCountDraws = true;
+                bool impostors = true;
+                FoliagePass foliagePass = FoliagePass::ALPHA_TEST;
+                OPENGL::DebugViewType debugView = OPENGL::DebugViewType::NONE;
+        };
+
+        // Everything RenderingOrderExp::render() needs from the simulation for one frame. It is a plain
+        // value, so the window thread can hand it to the render thread while it simulates the next frame.
+        struct FrameSnapshot {
+                // interpolated between the last two simulation steps
+                glm::vec3 playerEye = glm::vec3(0.0f);
+                glm::vec3 playerLookCenter = glm::vec3(0.0f);
+                glm::vec3 slimePosition = glm::vec3(0.0f);
+                // trackball
+                glm::vec3 godEye = glm::vec3(0.0f);
+                glm::vec3 godLookCenter = glm::vec3(0.0f);
+                RenderSettings settings;
+        };
+}
@@ -3,6 +3,7 @@
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 
+#include <glm/gtc/packing.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/constants.hpp>
@@ -13,16 +14,30 @@
 #include <stb_image.h>
 
 #include <algorithm>
-#include <array>
+#include <chrono>
 #include <cmath>
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <string>
+#include <thread>
 #include <vector>
 
+#include "../Rendering/GLExtensions.h"
+#include "../Rendering/GLStateCache.h"
 #include "../Rendering/ShaderParameterBindingPoint.h"
 #include "../Rendering/Shader.h"
+#include "../Scene/InstanceField.h"
+#include "../Scene/MeshCache.h"
+#include "../Scene/MeshOptimizer.h"
 #include "../Scene/SpatialSample.h"
+#include "../Scene/TextureCache.h"
+#include "../Scene/TextureCompressor.h"
 
 namespace INANOA {
 namespace {
@@ -30,37 +45,231 @@ namespace {
         constexpr GLuint VISIBLE_INSTANCE_BINDING = 1;
         constexpr GLuint DRAW_COMMAND_BINDING = 2;
         constexpr GLuint INSTANCE_STATE_BINDING = 3;
-
-        constexpr int NUM_FOLIAGE_TEXTURES = 3;
+        constexpr GLuint OCCLUSION_CANDIDATE_BINDING = 4;
+        constexpr GLuint LATE_DISPATCH_BINDING = 5;
+        constexpr GLuint LATE_DRAW_COMMAND_BINDING = 6;
+        constexpr GLuint MESH_BOUNDS_BINDING = 7;
+        constexpr GLuint MESH_LOD_BINDING = 8;
+        constexpr GLuint INSTANCE_CELL_BINDING = 9;
+        constexpr GLuint VISIBLE_CELL_BINDING = 10;
+        constexpr GLuint CELL_DISPATCH_BINDING = 11;
+        constexpr GLuint CELL_COMMAND_COUNT_BINDING = 12;
+        constexpr GLuint INSTANCE_SLOT_BINDING = 13;
+        constexpr GLuint TILE_SLOT_BINDING = 14;
+        constexpr GLuint DRAW_LIST_BINDING = 15;
+        constexpr GLuint DRAW_COUNT_BINDING = 16;
+        constexpr GLuint SCAN_GROUP_TOTAL_BINDING = 17;
+
+        // uniform block binding points, ViewConstants / CullConstants in the foliage and slime shaders
+        constexpr GLuint VIEW_CONSTANTS_BINDING = 0;
+        constexpr GLuint CULL_CONSTANTS_BINDING = 1;
+        // per frame uniform data: one cull block + a view block per viewport pass, padded to the UBO alignment
+        constexpr GLsizeiptr FRAME_RING_BYTES = 16 * 1024;
+
+        constexpr GLuint CELL_CULL_GROUP_SIZE = 64u;
+        // cells per work group of the compaction scan, must match LOCAL_SIZE in foliage_compact.comp
+        constexpr GLuint COMPACT_SCAN_GROUP_SIZE = 256u;
+        // world space edge of an instance cell, ~300 instances per cell in the grass field
+        constexpr float INSTANCE_CELL_SIZE = 8.0f;
+        // streaming tiles are square blocks of cells
+        constexpr int CELLS_PER_TILE_EDGE = 8;
+        constexpr uint32_t CELLS_PER_TILE = CELLS_PER_TILE_EDGE * CELLS_PER_TILE_EDGE;
+        constexpr float TILE_SIZE = INSTANCE_CELL_SIZE * CELLS_PER_TILE_EDGE;
+        // tiles within this distance of the player are kept resident (player far plane + one cell)
+        constexpr float STREAMING_RADIUS = 158.0f;
+
+        // species, meshes, textures and sample sets of the foliage (SCENE::FoliageCatalog)
+        const char* const FOLIAGE_CATALOG_FILE = "assets/foliage.catalog";
+        // SS2 v2 field baked from the v1 sample sets of the foliage species
+        const char* const INSTANCE_FIELD_FILE = "cache/foliage_field.ss2";
+        const char* const SLIME_MESH_FILE = "assets/models/foliages/slime.obj";
+        const char* const SLIME_TEXTURE_FILE = "assets/textures/slime_albedo.jpg";
+        // welded, cache optimized and quantized meshes (SCENE::MeshCache), one file per OBJ
+        const char* const MESH_CACHE_DIRECTORY = "cache/";
+        // BC7 foliage texture layers with their mips (SCENE::TextureCache), one file per image
+        const char* const TEXTURE_CACHE_DIRECTORY = "cache/";
+        // worker threads of the asset loader, the GL thread only uploads
+        constexpr int MAX_LOADER_THREADS = 4;
+        // GL thread time per frame for running finished uploads while the scene is loading
+        constexpr double UPLOAD_BUDGET_MS = 4.0;
+        // packed instance transform (PackedInstanceGPU word 2, visible transform): bits 0-15 yaw in [0, 2pi),
+        // 16-23 uniform scale in [MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE]; the culling passes put the species
+        // into bits 24-31 of the visible transform. Must match foliage_cull.comp / foliage_instancing.vert
+        constexpr float MIN_INSTANCE_SCALE = 0.5f;
+        constexpr float MAX_INSTANCE_SCALE = 2.0f;
+        // scroll zoom limit of the god camera, Camera's MIN_DISTANCE
+        constexpr float MIN_GOD_CAMERA_DISTANCE = 0.05f;
+        // views culled by one dispatch, must match MAX_CULL_VIEWS in foliage_cull.comp / foliage_cell_cull.comp
+        constexpr int MAX_CULL_VIEWS = 4;
+        // the player view comes first, it is the only one with occlusion culling
+        constexpr int CULL_VIEW_PLAYER = 0;
+        constexpr int CULL_VIEW_GOD = 1;
+        constexpr int NUM_CULL_VIEWS = 2;
+        static_assert(NUM_CULL_VIEWS <= MAX_CULL_VIEWS, "too many cull views");
+        // draw commands of all views the prefix sum compaction can rank, must match foliage_cull.comp / foliage_compact.comp;
+        // larger catalogs are culled with atomic appends
+        constexpr size_t MAX_DRAW_COMMANDS = 48u;
+        // compacted draw lists (foliage_draw_list.comp): one per cull view + the player's late list
+        constexpr int LATE_DRAW_LIST = NUM_CULL_VIEWS;
+        constexpr int NUM_DRAW_LISTS = NUM_CULL_VIEWS + 1;
         constexpr int IMG_WIDTH = 1024;
         constexpr int IMG_HEIGHT = 1024;
         constexpr int IMG_CHANNEL = 4;
+        // full mip chain of an IMG_WIDTH x IMG_HEIGHT layer
+        constexpr int FOLIAGE_TEXTURE_LEVELS = 11;
+        // BC7 is core since GL 4.2, no extension check or fallback format is needed
+        constexpr GLenum FOLIAGE_TEXTURE_FORMAT = GL_COMPRESSED_RGBA_BPTC_UNORM;
+        // must match the alpha test in foliage_instancing.frag
+        constexpr float FOLIAGE_ALPHA_CUTOFF = 0.5f;
+        // camera facing quad of every impostor, impostor.vert derives the corners from these indices
+        const GLuint IMPOSTOR_QUAD_INDICES[6] = { 0u, 1u, 2u, 2u, 1u, 3u };
+        // texture units of the impostor atlas in impostor.frag
+        constexpr GLuint IMPOSTOR_ALBEDO_UNIT = 0;
+        constexpr GLuint IMPOSTOR_NORMAL_DEPTH_UNIT = 1;
+        // samples of the player view with FoliagePass::ALPHA_TO_COVERAGE (fewer if the context has fewer)
+        constexpr GLint MULTISAMPLE_SAMPLES = 4;
 
         const glm::vec3 LIGHT_DIRECTION = glm::normalize(glm::vec3(0.3f, 0.7f, 0.5f));
 
-        struct RawInstancePropertiesGPU {
-                glm::vec4 position;
-                glm::ivec4 indices;
+        // foliage / slime vertex: normal as GL_INT_2_10_10_10_REV snorm, uv as two half floats
+        struct VertexGPU {
+                glm::vec3 position;
+                GLuint normal;
+                GLuint uv;
+        };
+        // instance as read from the sample files, packed into PackedInstanceGPU once binned into cells
+        struct RawInstance {
+                glm::vec3 position;
+                uint32_t meshID;
+                uint32_t transform;
+        };
+        // 0: x | y << 16, 1: z | mesh << 16, 2: transform; x, y, z are unorm16 inside the cell bounds
+        struct PackedInstanceGPU {
+                GLuint words[3];
         };
         struct InstancePropertiesGPU {
-                glm::vec4 position;
+                glm::vec3 position;
+                GLuint transform;
+        };
+        // info: x first draw command of the mesh, y number of LODs, z texture layer, w impostor atlas layer;
+        // distances: upper bound of each LOD; far: x distance beyond which the instances are culled (0: none),
+        // y distance from which they are impostors (0: never), z crossfade band
+        struct MeshLodGPU {
+                glm::uvec4 info;
+                glm::vec4 maxDistances;
+                glm::vec4 far;
+        };
+        // bounds cover the bounding spheres of the cell's instances, range: x first instance, y count
+        struct InstanceCellGPU {
+                glm::vec4 boundsMin;
+                glm::vec4 boundsMax;
+                glm::uvec4 range;
+        };
+        // std140 layout of ViewConstants
+        struct ViewConstantsGPU {
+                glm::mat4 viewMat;
+                glm::mat4 projMat;
+                glm::vec4 cameraPos;
+        };
+        // std140 layout of CullConstants (foliage_cell_cull.comp, foliage_cull.comp, foliage_compact.comp)
+        struct CullConstantsGPU {
+                glm::vec4 frustumPlanes[6 * MAX_CULL_VIEWS];
+                glm::vec4 viewPositions[MAX_CULL_VIEWS];
+                glm::vec3 slimePosition;
+                float eraseRadius;
+                GLint numViews;
+                GLint numMeshes;
+                GLint commandsPerView;
+                GLuint instancePoolSize;
+                GLuint numCells;
+                GLuint cellsPerTileSlot;
+                GLint impostorCommand;
+                GLuint padding;
+        };
+        // glDispatchComputeIndirect arguments of the late culling pass + candidate counter
+        struct LateDispatchGPU {
+                GLuint numGroupsX;
+                GLuint numGroupsY;
+                GLuint numGroupsZ;
+                GLuint candidateCount;
         };
 }
 
-struct RenderingOrderExp::Vertex {
-        glm::vec3 position;
-        glm::vec3 normal;
-        glm::vec2 uv;
+struct RenderingOrderExp::MeshLod {
+        uint32_t indexCount = 0u;
+        uint32_t firstIndex = 0u;
+        // camera distance up to which this LOD is used, the last LOD has no limit
+        float maxDistance = 0.0f;
 };
 
+// a foliage species of the catalog, its mesh id is its index in m_meshInfos
 struct RenderingOrderExp::MeshInfo {
         std::string name;
-        uint32_t indexCount = 0u;
-        uint32_t firstIndex = 0u;
+        // v1 sample set the species' instances are placed from
+        std::string sampleFile;
+        // LOD 0 is the full mesh, every LOD shares the vertices of LOD 0; species with the same
+        // geometry share the vertex and index ranges
+        std::vector<MeshLod> lods;
+        // within the commands of one view
+        uint32_t firstCommand = 0u;
         uint32_t baseVertex = 0u;
         uint32_t textureLayer = 0u;
-        uint32_t rawOffset = 0u;
+        float density = 1.0f;
+        float scaleJitter = 0.0f;
+        float cullDistance = 0.0f;
+        float impostorDistance = 0.0f;
+        float impostorCrossfade = 0.0f;
+        // -1: always drawn as a mesh
+        int impostorLayer = -1;
         uint32_t rawCount = 0u;
+        // mesh space bounding sphere (xyz center, w radius)
+        glm::vec4 boundingSphere = glm::vec4(0.0f);
+};
+
+// field as built from the v1 sample files, when there is no up to date SS2 v2 file
+struct RenderingOrderExp::BakedInstanceField {
+        SCENE::InstanceFieldHeader header{};
+        std::vector<uint32_t> meshInstanceCounts;
+        std::vector<InstanceCellGPU> cells;
+        std::vector<PackedInstanceGPU> records;
+        std::vector<SCENE::InstanceFieldTile> tiles;
+        std::vector<uint32_t> tileMeshCounts;
+};
+static_assert(sizeof(InstanceCellGPU) == sizeof(SCENE::InstanceFieldChunk), "SS2 v2 chunks are uploaded as instance cells");
+
+// CPU side results of the loading jobs until the GL thread has uploaded them; every job writes
+// only its own entries, the counters are touched by the uploads (GL thread) only
+struct RenderingOrderExp::LoadingState {
+        struct MeshData {
+                bool loaded = false;
+                // VertexGPU vertices and the indices of every LOD
+                SCENE::MeshCacheData mesh;
+        };
+        // one per geometry of the foliage catalog
+        std::vector<MeshData> meshes;
+        int numMeshesParsed = 0;
+
+        // FOLIAGE_TEXTURE_FORMAT mip chains, no levels when the image failed to load
+        std::vector<SCENE::TextureCacheData> layers;
+        int numLayersUploaded = 0;
+
+        SCENE::MeshCacheData slimeMesh;
+        std::vector<unsigned char> slimePixels;
+        int slimeWidth = 0;
+        int slimeHeight = 0;
+
+        // v1 sample sets of m_meshInfos, only read when the SS2 v2 field has to be baked
+        std::vector<SCENE::EXPERIMENTAL::SpatialSample*> samples;
+        int numSamplesRead = 0;
+        uint32_t contentKey = 0u;
+
+        std::chrono::steady_clock::time_point start;
+
+        ~LoadingState() {
+                for (SCENE::EXPERIMENTAL::SpatialSample* sample : this->samples) {
+                        delete sample;
+                }
+        }
 };
 
 struct RenderingOrderExp::DrawCommand {
@@ -79,6 +288,468 @@ namespace {
                 }
                 return filePath.substr(0, pos + 1);
         }
+
+        constexpr uint32_t FNV_OFFSET_BASIS = 2166136261u;
+
+        // a tile slot of the pool holds CELLS_PER_TILE cells, fields baked with another tile / cell size do not fit
+        bool tilesFitTileSlots(const SCENE::InstanceFieldTile* tiles, const uint32_t numTiles) {
+                for (uint32_t t = 0u; t < numTiles; ++t) {
+                        if (tiles[t].numChunks > CELLS_PER_TILE) {
+                                return false;
+                        }
+                }
+                return true;
+        }
+
+        // FNV-1a
+        uint32_t hashBytes(uint32_t hash, const void* data, const size_t size) {
+                const unsigned char* bytes = static_cast<const unsigned char*>(data);
+                for (size_t i = 0; i < size; ++i) {
+                        hash = (hash ^ bytes[i]) * 16777619u;
+                }
+                return hash;
+        }
+
+        // <directory><stem>_<hash of the source path><extension>, sources with the same file name in different
+        // directories get their own cache file
+        std::string cacheFilePath(const char* directory, const std::string& sourceFile, const char* extension) {
+                const std::string sourcePath = std::filesystem::path(sourceFile).lexically_normal().generic_string();
+                char pathHash[9];
+                snprintf(pathHash, sizeof(pathHash), "%08x", hashBytes(FNV_OFFSET_BASIS, sourcePath.data(), sourcePath.size()));
+                return std::string(directory) + std::filesystem::path(sourceFile).stem().string() + "_" + pathHash + extension;
+        }
+
+        // integer hash (lowbias32), stable per instance across runs
+        uint32_t hashInstance(uint32_t x) {
+                x ^= x >> 16;
+                x *= 0x7feb352du;
+                x ^= x >> 15;
+                x *= 0x846ca68bu;
+                x ^= x >> 16;
+                return x;
+        }
+
+        uint32_t packInstanceTransform(const float yaw, const float scale) {
+                const float twoPi = glm::two_pi<float>();
+                const float wrappedYaw = yaw - twoPi * std::floor(yaw / twoPi);
+                const uint32_t yawBits = std::min(static_cast<uint32_t>(wrappedYaw / twoPi * 65535.0f + 0.5f), 65535u);
+                const float scale01 = glm::clamp((scale - MIN_INSTANCE_SCALE) / (MAX_INSTANCE_SCALE - MIN_INSTANCE_SCALE), 0.0f, 1.0f);
+                const uint32_t scaleBits = static_cast<uint32_t>(scale01 * 255.0f + 0.5f);
+                return yawBits | (scaleBits << 16);
+        }
+
+        // color and depth of a multisample target into a single sample target of the same size
+        void resolveTarget(const OPENGL::OffscreenTarget& src, const OPENGL::OffscreenTarget& dst) {
+                glBindFramebuffer(GL_READ_FRAMEBUFFER, src.framebufferId());
+                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst.framebufferId());
+                glBlitFramebuffer(0, 0, src.width(), src.height(), 0, 0, dst.width(), dst.height(), GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+        }
+
+        // foliage_instancing.vert with one of the foliage fragment shaders, constant uniforms set
+        OPENGL::ShaderProgram* createFoliageProgram(const std::string& fsResource) {
+                OPENGL::ShaderProgram* program = OPENGL::ShaderProgram::createShaderProgram("shaders/foliage_instancing.vert", fsResource);
+                if (program == nullptr) {
+                        return nullptr;
+                }
+                const GLuint programId = program->programId();
+                glUseProgram(programId);
+                glUniform1i(glGetUniformLocation(programId, "albedoTextureArray"), 0);
+                const glm::mat4 identityMat(1.0f);
+                glUniformMatrix4fv(glGetUniformLocation(programId, "modelMat"), 1, GL_FALSE, glm::value_ptr(identityMat));
+                glUniform3fv(glGetUniformLocation(programId, "lightDir"), 1, glm::value_ptr(LIGHT_DIRECTION));
+                glUseProgram(0);
+                return program;
+        }
+
+        // world space bounding sphere of an instance, same decoding as instanceSphere() in foliage_cull.comp
+        glm::vec4 instanceSphere(const RawInstance& raw, const glm::vec4& meshSphere) {
+                const uint32_t transform = raw.transform;
+                const float yaw = static_cast<float>(transform & 0xFFFFu) * (glm::two_pi<float>() / 65535.0f);
+                const float scale = glm::mix(MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE, static_cast<float>((transform >> 16) & 0xFFu) / 255.0f);
+                const float c = std::cos(yaw);
+                const float s = std::sin(yaw);
+                const glm::vec3 offset = scale * glm::vec3(c * meshSphere.x + s * meshSphere.z, meshSphere.y, -s * meshSphere.x + c * meshSphere.z);
+                return glm::vec4(raw.position + offset, scale * meshSphere.w);
+        }
+
+        // inverse of decodeInstance() in foliage_cull.comp
+        PackedInstanceGPU packInstance(const RawInstance& raw, const InstanceCellGPU& cell) {
+                const glm::vec3 extent = glm::max(glm::vec3(cell.boundsMax - cell.boundsMin), glm::vec3(1e-6f));
+                const glm::vec3 normalized = glm::clamp((raw.position - glm::vec3(cell.boundsMin)) / extent, 0.0f, 1.0f);
+                const glm::uvec3 q = glm::uvec3(normalized * 65535.0f + 0.5f);
+                PackedInstanceGPU packed{};
+                packed.words[0] = q.x | (q.y << 16);
+                packed.words[1] = q.z | ((raw.meshID & 0xFFu) << 16);
+                packed.words[2] = raw.transform;
+                return packed;
+        }
+
+        uint32_t findCard(std::vector<uint32_t>& parents, uint32_t v) {
+                while (parents[v] != v) {
+                        parents[v] = parents[parents[v]];
+                        v = parents[v];
+                }
+                return v;
+        }
+
+        // Coarser LODs of foliage meshes (there are no authored ones): whole cards (triangles connected
+        // through shared OBJ vertices, i.e. a grass blade or a leaf quad) are dropped, so the kept
+        // triangles never leave half a card behind. Card k is kept when frac(k * golden ratio) < keepRatio,
+        // which spreads the kept cards evenly over the mesh and keeps every LOD a subset of the previous one.
+        std::vector<uint32_t> thinCards(const std::vector<uint32_t>& triangleCards, const std::vector<uint32_t>& indices, const float keepRatio) {
+                std::vector<uint32_t> kept;
+                kept.reserve(indices.size());
+                for (size_t tri = 0; tri < triangleCards.size(); ++tri) {
+                        const float sequence = std::fmod(static_cast<float>(triangleCards[tri]) * 0.618034f, 1.0f);
+                        if (sequence < keepRatio) {
+                                kept.insert(kept.end(), indices.begin() + tri * 3, indices.begin() + tri * 3 + 3);
+                        }
+                }
+                return kept;
+        }
+
+        // one vertex per OBJ index, as tinyobj hands them out
+        struct ObjVertex {
+                glm::vec3 position;
+                glm::vec3 normal;
+                glm::vec2 uv;
+        };
+        struct ObjMesh {
+                std::vector<ObjVertex> vertices;
+                // card (see thinCards()) of every triangle
+                std::vector<uint32_t> triangleCards;
+        };
+
+        bool loadObjMesh(const std::string& objFile, ObjMesh& mesh) {
+                tinyobj::attrib_t attrib;
+                std::vector<tinyobj::shape_t> shapes;
+                std::vector<tinyobj::material_t> materials;
+                std::string warn;
+                std::string err;
+                const std::string baseDir = directoryFromPath(objFile);
+                bool loaded = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objFile.c_str(), baseDir.c_str(), true);
+                if (!warn.empty()) {
+                        std::cout << "[TinyObjLoader] " << warn << std::endl;
+                }
+                if (!loaded) {
+                        std::cerr << "Failed to load OBJ: " << objFile << " " << err << std::endl;
+                        return false;
+                }
+
+                std::vector<uint32_t> cardParents(attrib.vertices.size() / 3 + 1);
+                for (uint32_t i = 0u; i < cardParents.size(); ++i) {
+                        cardParents[i] = i;
+                }
+                std::vector<uint32_t> triangleVertices;
+                triangleVertices.reserve(shapes.size() * 64);
+                mesh.vertices.reserve(shapes.size() * 64);
+
+                for (const auto& shape : shapes) {
+                        for (size_t i = 0; i + 2 < shape.mesh.indices.size(); i += 3) {
+                                const uint32_t v0 = static_cast<uint32_t>(shape.mesh.indices[i].vertex_index + 1);
+                                const uint32_t v1 = static_cast<uint32_t>(shape.mesh.indices[i + 1].vertex_index + 1);
+                                const uint32_t v2 = static_cast<uint32_t>(shape.mesh.indices[i + 2].vertex_index + 1);
+                                cardParents[findCard(cardParents, v1)] = findCard(cardParents, v0);
+                                cardParents[findCard(cardParents, v2)] = findCard(cardParents, v0);
+                                triangleVertices.push_back(v0);
+                        }
+                        for (const auto& idx : shape.mesh.indices) {
+                                ObjVertex vertex{};
+                                if (idx.vertex_index >= 0) {
+                                        vertex.position = glm::vec3(
+                                                attrib.vertices[3 * idx.vertex_index + 0],
+                                                attrib.vertices[3 * idx.vertex_index + 1],
+                                                attrib.vertices[3 * idx.vertex_index + 2]
+                                        );
+                                }
+                                if (idx.normal_index >= 0) {
+                                        vertex.normal = glm::vec3(
+                                                attrib.normals[3 * idx.normal_index + 0],
+                                                attrib.normals[3 * idx.normal_index + 1],
+                                                attrib.normals[3 * idx.normal_index + 2]
+                                        );
+                                }
+                                else {
+                                        vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+                                }
+                                if (idx.texcoord_index >= 0) {
+                                        vertex.uv = glm::vec2(
+                                                attrib.texcoords[2 * idx.texcoord_index + 0],
+                                                attrib.texcoords[2 * idx.texcoord_index + 1]
+                                        );
+                                }
+                                mesh.vertices.push_back(vertex);
+                        }
+                }
+
+                mesh.triangleCards.resize(triangleVertices.size());
+                std::vector<uint32_t> cardIds(cardParents.size(), UINT32_MAX);
+                uint32_t numCards = 0u;
+                for (size_t tri = 0; tri < triangleVertices.size(); ++tri) {
+                        const uint32_t root = findCard(cardParents, triangleVertices[tri]);
+                        if (cardIds[root] == UINT32_MAX) {
+                                cardIds[root] = numCards++;
+                        }
+                        mesh.triangleCards[tri] = cardIds[root];
+                }
+                return true;
+        }
+
+        // Welds the OBJ vertices, builds one index range per keep ratio (thinCards()), orders each
+        // range for the post-transform cache and the vertices for fetch locality, and quantizes them
+        // into VertexGPU.
+        SCENE::MeshCacheData processMesh(const std::string& objFile, const ObjMesh& obj, const std::vector<float>& keepRatios) {
+                using namespace SCENE::MeshOptimizer;
+                SCENE::MeshCacheData data;
+                data.vertexStride = sizeof(VertexGPU);
+
+                glm::vec3 boundsMin(0.0f);
+                glm::vec3 boundsMax(0.0f);
+                if (obj.vertices.empty() == false) {
+                        boundsMin = obj.vertices[0].position;
+                        boundsMax = obj.vertices[0].position;
+                }
+                for (const ObjVertex& v : obj.vertices) {
+                        boundsMin = glm::min(boundsMin, v.position);
+                        boundsMax = glm::max(boundsMax, v.position);
+                }
+                const glm::vec3 boundsCenter = 0.5f * (boundsMin + boundsMax);
+                float boundsRadius = 0.0f;
+                for (const ObjVertex& v : obj.vertices) {
+                        boundsRadius = std::max(boundsRadius, glm::length(v.position - boundsCenter));
+                }
+                std::memcpy(data.boundingSphere, glm::value_ptr(glm::vec4(boundsCenter, boundsRadius)), sizeof(data.boundingSphere));
+
+                // the OBJ index buffer is 0, 1, 2, ..., welding turns it into the remap table
+                std::vector<uint32_t> weldedIndices;
+                const size_t numWelded = weldVertices(obj.vertices.data(), obj.vertices.size(), sizeof(ObjVertex), weldedIndices);
+                std::vector<ObjVertex> welded(numWelded);
+                for (size_t v = 0; v < obj.vertices.size(); ++v) {
+                        welded[weldedIndices[v]] = obj.vertices[v];
+                }
+
+                float acmrBefore = 0.0f;
+                float acmrAfter = 0.0f;
+                for (const float keepRatio : keepRatios) {
+                        std::vector<uint32_t> lodIndices = keepRatio < 1.0f ? thinCards(obj.triangleCards, weldedIndices, keepRatio) : weldedIndices;
+                        if (data.lods.empty()) {
+                                acmrBefore = averageCacheMissRatio(lodIndices.data(), lodIndices.size(), numWelded, 16);
+                        }
+                        optimizeVertexCache(lodIndices.data(), lodIndices.size(), numWelded);
+                        if (data.lods.empty()) {
+                                acmrAfter = averageCacheMissRatio(lodIndices.data(), lodIndices.size(), numWelded, 16);
+                        }
+                        SCENE::MeshCacheLod lod{};
+                        lod.firstIndex = static_cast<uint32_t>(data.indices.size());
+                        lod.indexCount = static_cast<uint32_t>(lodIndices.size());
+                        data.lods.push_back(lod);
+                        data.indices.insert(data.indices.end(), lodIndices.begin(), lodIndices.end());
+                }
+
+                // LOD 0 comes first and uses every vertex, the coarser LODs use subsets of them
+                std::vector<uint32_t> fetchRemap;
+                const size_t numVertices = optimizeVertexFetch(data.indices.data(), data.indices.size(), numWelded, fetchRemap);
+                for (uint32_t& index : data.indices) {
+                        index = fetchRemap[index];
+                }
+                std::vector<VertexGPU> vertices(numVertices);
+                for (size_t v = 0; v < numWelded; ++v) {
+                        if (fetchRemap[v] == UINT32_MAX) {
+                                continue;
+                        }
+                        const ObjVertex& source = welded[v];
+                        const float normalLength = glm::length(source.normal);
+                        const glm::vec3 normal = normalLength > 0.0f ? source.normal / normalLength : glm::vec3(0.0f, 1.0f, 0.0f);
+                        VertexGPU& vertex = vertices[fetchRemap[v]];
+                        vertex.position = source.position;
+                        vertex.normal = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+                        vertex.uv = glm::packHalf2x16(source.uv);
+                }
+                data.vertices.resize(vertices.size() * sizeof(VertexGPU));
+                std::memcpy(data.vertices.data(), vertices.data(), data.vertices.size());
+
+                std::cout << "[MeshCache] " << objFile << ": " << obj.vertices.size() << " -> " << numVertices << " vertices, ACMR " << acmrBefore << " -> " << acmrAfter << std::endl;
+                return data;
+        }
+
+        // processed mesh of an OBJ file from cache/, the OBJ is only parsed when the cache is missing or stale
+        bool loadProcessedMesh(const std::string& objFile, const std::vector<float>& keepRatios, SCENE::MeshCacheData& data) {
+                std::ifstream input(objFile, std::ios::binary);
+                if (!input.is_open()) {
+                        std::cerr << "Failed to load OBJ: " << objFile << std::endl;
+                        return false;
+                }
+                const std::string objBytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+                uint32_t contentKey = hashBytes(FNV_OFFSET_BASIS, objBytes.data(), objBytes.size());
+                contentKey = hashBytes(contentKey, keepRatios.data(), keepRatios.size() * sizeof(float));
+
+                const std::string cacheFile = cacheFilePath(MESH_CACHE_DIRECTORY, objFile, ".mesh");
+                if (SCENE::MeshCache::read(cacheFile, contentKey, sizeof(VertexGPU), data)) {
+                        return true;
+                }
+
+                ObjMesh obj;
+                if (loadObjMesh(objFile, obj) == false) {
+                        return false;
+                }
+                data = processMesh(objFile, obj, keepRatios);
+
+                // a missing cache only costs the processing on the next start
+                std::error_code error;
+                std::filesystem::create_directories(MESH_CACHE_DIRECTORY, error);
+                if (SCENE::MeshCache::write(cacheFile, contentKey, data) == false) {
+                        std::cerr << "Failed to write mesh cache: " << cacheFile << std::endl;
+                }
+                return true;
+        }
+
+        // IMG_WIDTH x IMG_HEIGHT FOLIAGE_TEXTURE_FORMAT mip chain of an image from cache/, the image is only
+        // decoded and compressed when the cache is missing or stale; no levels when it fails to load
+        bool loadCompressedTexture(const std::string& imageFile, SCENE::TextureCacheData& data) {
+                std::ifstream input(imageFile, std::ios::binary);
+                if (!input.is_open()) {
+                        std::cerr << "Failed to load texture: " << imageFile << std::endl;
+                        return false;
+                }
+                const std::string imageBytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+                uint32_t contentKey = hashBytes(FNV_OFFSET_BASIS, imageBytes.data(), imageBytes.size());
+                const int layout[3] = { IMG_WIDTH, IMG_HEIGHT, FOLIAGE_TEXTURE_LEVELS };
+                contentKey = hashBytes(contentKey, layout, sizeof(layout));
+                contentKey = hashBytes(contentKey, &FOLIAGE_ALPHA_CUTOFF, sizeof(FOLIAGE_ALPHA_CUTOFF));
+
+                const std::string cacheFile = cacheFilePath(TEXTURE_CACHE_DIRECTORY, imageFile, ".tex");
+                if (SCENE::TextureCache::read(cacheFile, contentKey, FOLIAGE_TEXTURE_FORMAT, data)) {
+                        if (data.width == IMG_WIDTH && data.height == IMG_HEIGHT && data.levels.size() == FOLIAGE_TEXTURE_LEVELS) {
+                                return true;
+                        }
+                }
+
+                int width = 0;
+                int height = 0;
+                int channel = 0;
+                unsigned char* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(imageBytes.data()), static_cast<int>(imageBytes.size()), &width, &height, &channel, STBI_rgb_alpha);
+                if (pixels == nullptr) {
+                        std::cerr << "Failed to load texture: " << imageFile << std::endl;
+                        data = SCENE::TextureCacheData();
+                        return false;
+                }
+                // every layer is IMG_WIDTH x IMG_HEIGHT, smaller images are padded with zeros
+                std::vector<unsigned char> image(static_cast<size_t>(IMG_WIDTH) * IMG_HEIGHT * IMG_CHANNEL, 0);
+                const int copyWidth = std::min(width, IMG_WIDTH);
+                const int copyHeight = std::min(height, IMG_HEIGHT);
+                for (int y = 0; y < copyHeight; ++y) {
+                        unsigned char* dst = image.data() + static_cast<size_t>(y) * IMG_WIDTH * IMG_CHANNEL;
+                        const unsigned char* src = pixels + static_cast<size_t>(y) * width * IMG_CHANNEL;
+                        std::memcpy(dst, src, static_cast<size_t>(copyWidth) * IMG_CHANNEL);
+                }
+                stbi_image_free(pixels);
+
+                std::vector<std::vector<unsigned char>> mips;
+                SCENE::TextureCompressor::buildMipChain(image.data(), IMG_WIDTH, IMG_HEIGHT, FOLIAGE_ALPHA_CUTOFF, mips);
+                data = SCENE::TextureCacheData();
+                data.glInternalFormat = FOLIAGE_TEXTURE_FORMAT;
+                data.blockBytes = static_cast<uint32_t>(SCENE::TextureCompressor::BC7_BLOCK_BYTES);
+                data.width = IMG_WIDTH;
+                data.height = IMG_HEIGHT;
+                data.levels.resize(mips.size());
+                size_t sourceBytes = 0u;
+                size_t compressedBytes = 0u;
+                for (size_t level = 0; level < mips.size(); ++level) {
+                        const int levelWidth = std::max(IMG_WIDTH >> level, 1);
+                        const int levelHeight = std::max(IMG_HEIGHT >> level, 1);
+                        SCENE::TextureCompressor::compressBC7(mips[level].data(), levelWidth, levelHeight, data.levels[level]);
+                        sourceBytes += mips[level].size();
+                        compressedBytes += data.levels[level].size();
+                }
+                std::cout << "[TextureCache] " << imageFile << ": " << mips.size() << " levels, " << sourceBytes / 1024 << " -> " << compressedBytes / 1024 << " KiB" << std::endl;
+
+                // a missing cache only costs the compression on the next start
+                std::error_code error;
+                std::filesystem::create_directories(TEXTURE_CACHE_DIRECTORY, error);
+                if (SCENE::TextureCache::write(cacheFile, contentKey, data) == false) {
+                        std::cerr << "Failed to write texture cache: " << cacheFile << std::endl;
+                }
+                return true;
+        }
+
+        // Sorts the instances by the INSTANCE_CELL_SIZE grid cell (xz) they fall into, tile by tile
+        // (CELLS_PER_TILE_EDGE^2 cells), so every cell is a contiguous instance range and every tile a
+        // contiguous run of cells. Returns the non-empty cells; tiles and their per-mesh instance counts
+        // (numMeshes per tile) are appended to the other two vectors.
+        std::vector<InstanceCellGPU> binInstancesIntoCells(std::vector<RawInstance>& instances, const std::vector<glm::vec4>& meshBounds, std::vector<SCENE::InstanceFieldTile>& tiles, std::vector<uint32_t>& tileMeshCounts) {
+                std::vector<InstanceCellGPU> cells;
+                if (instances.empty()) {
+                        return cells;
+                }
+                glm::vec2 gridMin(instances[0].position.x, instances[0].position.z);
+                glm::vec2 gridMax = gridMin;
+                for (const RawInstance& raw : instances) {
+                        gridMin = glm::min(gridMin, glm::vec2(raw.position.x, raw.position.z));
+                        gridMax = glm::max(gridMax, glm::vec2(raw.position.x, raw.position.z));
+                }
+                const int gridWidth = static_cast<int>((gridMax.x - gridMin.x) / INSTANCE_CELL_SIZE) + 1;
+                const int gridHeight = static_cast<int>((gridMax.y - gridMin.y) / INSTANCE_CELL_SIZE) + 1;
+                const int tileGridWidth = (gridWidth + CELLS_PER_TILE_EDGE - 1) / CELLS_PER_TILE_EDGE;
+                const auto cellOf = [&](const RawInstance& raw) {
+                        const int x = std::min(static_cast<int>((raw.position.x - gridMin.x) / INSTANCE_CELL_SIZE), gridWidth - 1);
+                        const int z = std::min(static_cast<int>((raw.position.z - gridMin.y) / INSTANCE_CELL_SIZE), gridHeight - 1);
+                        return z * gridWidth + x;
+                };
+                const auto tileOf = [&](const int cell) {
+                        return (cell / gridWidth / CELLS_PER_TILE_EDGE) * tileGridWidth + (cell % gridWidth) / CELLS_PER_TILE_EDGE;
+                };
+                std::stable_sort(instances.begin(), instances.end(), [&](const RawInstance& a, const RawInstance& b) {
+                        const int cellA = cellOf(a);
+                        const int cellB = cellOf(b);
+                        const int tileA = tileOf(cellA);
+                        const int tileB = tileOf(cellB);
+                        return tileA != tileB ? tileA < tileB : cellA < cellB;
+                });
+
+                const size_t numMeshes = meshBounds.size();
+                int currentTile = -1;
+                size_t first = 0;
+                while (first < instances.size()) {
+                        const int cellID = cellOf(instances[first]);
+                        InstanceCellGPU cell{};
+                        cell.boundsMin = glm::vec4(glm::vec3(instances[first].position), 0.0f);
+                        cell.boundsMax = cell.boundsMin;
+                        size_t last = first;
+                        for (; last < instances.size() && cellOf(instances[last]) == cellID; ++last) {
+                                const glm::vec3 position(instances[last].position);
+                                const glm::vec4 sphere = instanceSphere(instances[last], meshBounds[instances[last].meshID]);
+                                const glm::vec3 center(sphere);
+                                cell.boundsMin = glm::min(cell.boundsMin, glm::vec4(glm::min(position, center - sphere.w), 0.0f));
+                                cell.boundsMax = glm::max(cell.boundsMax, glm::vec4(glm::max(position, center + sphere.w), 0.0f));
+                        }
+                        cell.range = glm::uvec4(static_cast<uint32_t>(first), static_cast<uint32_t>(last - first), 0u, 0u);
+
+                        if (tileOf(cellID) != currentTile) {
+                                currentTile = tileOf(cellID);
+                                SCENE::InstanceFieldTile tile{};
+                                std::memcpy(tile.boundsMin, glm::value_ptr(cell.boundsMin), sizeof(tile.boundsMin));
+                                std::memcpy(tile.boundsMax, glm::value_ptr(cell.boundsMax), sizeof(tile.boundsMax));
+                                tile.firstChunk = static_cast<uint32_t>(cells.size());
+                                tile.firstRecord = static_cast<uint32_t>(first);
+                                tiles.push_back(tile);
+                                tileMeshCounts.resize(tileMeshCounts.size() + numMeshes, 0u);
+                        }
+                        SCENE::InstanceFieldTile& tile = tiles.back();
+                        for (int axis = 0; axis < 3; ++axis) {
+                                tile.boundsMin[axis] = std::min(tile.boundsMin[axis], cell.boundsMin[axis]);
+                                tile.boundsMax[axis] = std::max(tile.boundsMax[axis], cell.boundsMax[axis]);
+                        }
+                        tile.numChunks++;
+                        tile.numRecords += cell.range.y;
+                        for (size_t i = first; i < last; ++i) {
+                                tileMeshCounts[tileMeshCounts.size() - numMeshes + instances[i].meshID]++;
+                        }
+
+                        cells.push_back(cell);
+                        first = last;
+                }
+                return cells;
+        }
 }
 
 RenderingOrderExp::RenderingOrderExp() {
@@ -95,16 +766,37 @@ this->m_totalInstanceCount = 0u;
 }
 
 RenderingOrderExp::~RenderingOrderExp() {
+        // the loader's and the streamer's workers write into the loading state / read from the field
+        this->m_assetLoader.shutdown();
+        this->m_tileStreamer.shutdown();
+        delete this->m_loadingState;
+        delete this->m_bakedField;
+
         delete this->m_viewFrustum;
         delete this->m_horizontalGround;
         delete this->m_renderer;
         delete this->m_playerCamera;
+        delete this->m_simulationCamera;
         delete this->m_godCamera;
 
         delete this->m_foliageShader;
+        delete this->m_foliageDepthShader;
+        delete this->m_foliageShadeShader;
+        delete this->m_foliageDebugShader;
         delete this->m_slimeShader;
         delete this->m_computeShader;
-
+        delete this->m_cellCullShader;
+        delete this->m_compactShader;
+        delete this->m_drawListShader;
+        delete this->m_impostorShader;
+        delete this->m_impostorAtlas;
+
+        if (this->m_impostorVao != 0u) {
+                glDeleteVertexArrays(1, &this->m_impostorVao);
+        }
+        if (this->m_impostorIbo != 0u) {
+                glDeleteBuffers(1, &this->m_impostorIbo);
+        }
         if (this->m_foliageVao != 0u) {
                 glDeleteVertexArrays(1, &this->m_foliageVao);
         }
@@ -141,17 +833,67 @@ RenderingOrderExp::~RenderingOrderExp() {
         if (this->m_instanceStateSSBO != 0u) {
                 glDeleteBuffers(1, &this->m_instanceStateSSBO);
         }
+        if (this->m_occlusionCandidateSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_occlusionCandidateSSBO);
+        }
+        if (this->m_lateDispatchBuffer != 0u) {
+                glDeleteBuffers(1, &this->m_lateDispatchBuffer);
+        }
+        if (this->m_lateDrawCommandSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_lateDrawCommandSSBO);
+        }
+        if (this->m_meshBoundsSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_meshBoundsSSBO);
+        }
+        if (this->m_meshLodSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_meshLodSSBO);
+        }
+        if (this->m_instanceCellSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_instanceCellSSBO);
+        }
+        if (this->m_visibleCellSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_visibleCellSSBO);
+        }
+        if (this->m_cellDispatchBuffer != 0u) {
+                glDeleteBuffers(1, &this->m_cellDispatchBuffer);
+        }
+        if (this->m_cellCommandCountSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_cellCommandCountSSBO);
+        }
+        if (this->m_scanGroupTotalSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_scanGroupTotalSSBO);
+        }
+        if (this->m_tileSlotSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_tileSlotSSBO);
+        }
+        if (this->m_instanceSlotSSBO != 0u) {
+                glDeleteBuffers(1, &this->m_instanceSlotSSBO);
+        }
+        if (this->m_drawListBuffer != 0u) {
+                glDeleteBuffers(1, &this->m_drawListBuffer);
+        }
+        if (this->m_drawCountBuffer != 0u) {
+                glDeleteBuffers(1, &this->m_drawCountBuffer);
+        }
+        delete this->m_playerViewTarget;
+        delete this->m_multisampleTarget;
+        delete this->m_hiZPyramid;
+        delete this->m_overdrawCounter;
 }
 
 bool RenderingOrderExp::init(const int w, const int h) {
         OPENGL::RendererBase* renderer = new OPENGL::RendererBase();
-        const std::string vsFile = "shaders\\vertexShader_ogl_450.glsl";
-        const std::string fsFile = "shaders\\fragmentShader_ogl_450.glsl";
+        const std::string vsFile = "shaders/vertexShader_ogl_450.glsl";
+        const std::string fsFile = "shaders/fragmentShader_ogl_450.glsl";
         if (renderer->init(vsFile, fsFile, w, h) == false) {
                 return false;
         }
         this->m_renderer = renderer;
 
+        if (this->m_frameRing.init(FRAME_RING_BYTES) == false) {
+                return false;
+        }
+
         this->m_godCamera = new Camera(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f), 5.0f, 60.0f, 0.1f, 512.0f);
         this->m_godCamera->resize(w, h);
         this->m_godCamera->setViewOrg(glm::vec3(0.0f, 55.0f, 50.0f));
@@ -162,12 +904,7 @@ bool RenderingOrderExp::init(const int w, const int h) {
         this->m_playerCamera = new Camera(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 9.5f, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f, 45.0f, 1.0f, 150.0f);
         this->m_playerCamera->resize(w, h);
         this->m_playerCamera->update();
-
-        this->m_renderer->setCamera(
-                this->m_godCamera->projMatrix(),
-                this->m_godCamera->viewMatrix(),
-                this->m_godCamera->viewOrig()
-        );
+        this->m_simulationCamera = new Camera(glm::vec3(0.0f, 10.0f, 0.0f), glm::vec3(0.0f, 9.5f, -5.0f), glm::vec3(0.0f, 1.0f, 0.0f), 10.0f, 45.0f, 1.0f, 150.0f);
 
         this->m_viewFrustum = new SCENE::RViewFrustum(1, this->m_playerCamera);
         this->m_viewFrustum->resize(this->m_playerCamera);
@@ -179,260 +916,647 @@ bool RenderingOrderExp::init(const int w, const int h) {
         const glm::vec3 godDir = glm::normalize(this->m_godCamera->lookCenter() - this->m_godCamera->viewOrig());
         this->m_trackballYaw = std::atan2(godDir.x, godDir.z);
         this->m_trackballPitch = std::asin(glm::clamp(godDir.y, -1.0f, 1.0f));
+        this->m_godCameraDistance = this->m_godCamera->distance();
 
         this->initializeSceneResources();
         this->resize(w, h);
 
         this->m_slimeTrajectory.enable(true);
+        this->m_currentPose = this->capturePose();
+        this->m_previousPose = this->m_currentPose;
+        this->m_renderPose = this->m_currentPose;
+        this->applySnapshot(this->snapshot());
 
         return true;
 }
 
 void RenderingOrderExp::initializeSceneResources() {
-        this->initializeFoliage();
-        this->initializeTextureArray();
-        this->initializeInstanceBuffers();
+        this->m_loadingState = new LoadingState();
+        this->m_loadingState->start = std::chrono::steady_clock::now();
+
+        // the GL thread keeps drawing, one core is left to it
+        const int numThreads = std::max(1, std::min(static_cast<int>(std::thread::hardware_concurrency()) - 1, MAX_LOADER_THREADS));
+        this->m_assetLoader.init(numThreads);
+
+        // stb's flip flag is global, it is set once before any decoding job runs
+        stbi_set_flip_vertically_on_load(true);
+        // without a catalog only the ground and the slime are drawn
+        this->m_foliageCatalog.load(FOLIAGE_CATALOG_FILE);
+        const size_t numGeometries = this->m_foliageCatalog.geometries().size();
+        this->m_loadingState->meshes.resize(numGeometries);
+        for (size_t geometryIdx = 0; geometryIdx < numGeometries; ++geometryIdx) {
+                this->m_assetLoader.submit([this, geometryIdx]() { this->loadFoliageMesh(geometryIdx); }, [this, numGeometries]() {
+                        // the species share one vertex / index buffer, which is built once every geometry is parsed
+                        this->m_loadingState->numMeshesParsed++;
+                        if (this->m_loadingState->numMeshesParsed == static_cast<int>(numGeometries)) {
+                                this->initializeFoliage();
+                        }
+                });
+        }
+
+        // layers past the limit stay unloaded, the species using them sample the last layer
+        GLint maxLayers = 0;
+        glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+        const size_t numLayers = std::min(this->m_foliageCatalog.textures().size(), static_cast<size_t>(std::max(maxLayers, 1)));
+        if (numLayers < this->m_foliageCatalog.textures().size()) {
+                std::cerr << "Only the first " << numLayers << " of " << this->m_foliageCatalog.textures().size() << " foliage textures are used" << std::endl;
+        }
+        this->m_loadingState->layers.resize(numLayers);
+        glGenTextures(1, &this->m_foliageTextureArray);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->m_foliageTextureArray);
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, FOLIAGE_TEXTURE_LEVELS, FOLIAGE_TEXTURE_FORMAT, IMG_WIDTH, IMG_HEIGHT, static_cast<GLsizei>(std::max<size_t>(numLayers, 1u)));
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // only level 0 is sampled until every layer is in
+        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        for (size_t layer = 0; layer < numLayers; ++layer) {
+                this->m_assetLoader.submit([this, layer]() { this->loadFoliageTexture(layer); }, [this, layer]() { this->uploadFoliageTexture(layer); });
+        }
+
+        this->m_assetLoader.submit([this]() { this->loadSlime(); }, [this]() { this->initializeSlime(); });
+
         this->initializeComputeShader();
-        this->initializeSlime();
-        this->updateGodCameraTrackball();
+        this->initializeOcclusionCulling();
+        this->initializeDebugViews();
 }
 
-void RenderingOrderExp::initializeFoliage() {
-        const std::array<std::pair<std::string, uint32_t>, NUM_FOLIAGE_TEXTURES> meshInfos = { {
-                {"assets/models/foliages/grassB.obj", 0u},
-                {"assets/models/foliages/bush01_lod2.obj", 1u},
-                {"assets/models/foliages/bush05_lod2.obj", 2u}
-        } };
+void RenderingOrderExp::updateLoading() {
+        if (this->m_loadingState == nullptr || this->m_assetLoader.idle() == false || this->m_tileStreamer.pendingTiles() > 0) {
+                return;
+        }
+        const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->m_loadingState->start).count();
+        std::cout << "Scene assets loaded in " << loadMs << " ms" << std::endl;
+        delete this->m_loadingState;
+        this->m_loadingState = nullptr;
+}
+
+void RenderingOrderExp::finishLoading() {
+        this->m_assetLoader.finish();
+        this->m_tileStreamer.prefetch(this->m_playerCamera->viewOrig(), STREAMING_RADIUS);
+        this->updateLoading();
+}
 
-        std::vector<Vertex> vertices;
+void RenderingOrderExp::loadFoliageMesh(const size_t geometryIdx) {
+        const SCENE::FoliageGeometry& geometry = this->m_foliageCatalog.geometries()[geometryIdx];
+        LoadingState::MeshData& mesh = this->m_loadingState->meshes[geometryIdx];
+        mesh.loaded = loadProcessedMesh(geometry.meshFile, geometry.keepRatios, mesh.mesh);
+}
+
+void RenderingOrderExp::initializeFoliage() {
+        std::vector<unsigned char> vertices;
         std::vector<uint32_t> indices;
-        vertices.reserve(100000);
-        indices.reserve(150000);
         this->m_meshInfos.clear();
 
-        for (size_t meshIdx = 0; meshIdx < meshInfos.size(); ++meshIdx) {
-                const std::string& objFile = meshInfos[meshIdx].first;
-                tinyobj::attrib_t attrib;
-                std::vector<tinyobj::shape_t> shapes;
-                std::vector<tinyobj::material_t> materials;
-                std::string warn;
-                std::string err;
-                const std::string baseDir = directoryFromPath(objFile);
-                bool loaded = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, objFile.c_str(), baseDir.c_str(), true);
-                if (!warn.empty()) {
-                        std::cout << "[TinyObjLoader] " << warn << std::endl;
-                }
-                if (!loaded) {
-                        std::cerr << "Failed to load OBJ: " << objFile << " " << err << std::endl;
+        // every geometry once, at the vertex / index offsets its species draw from
+        std::vector<uint32_t> baseVertices(this->m_loadingState->meshes.size(), 0u);
+        std::vector<uint32_t> firstIndices(this->m_loadingState->meshes.size(), 0u);
+        for (size_t geometryIdx = 0; geometryIdx < this->m_loadingState->meshes.size(); ++geometryIdx) {
+                const LoadingState::MeshData& mesh = this->m_loadingState->meshes[geometryIdx];
+                baseVertices[geometryIdx] = static_cast<uint32_t>(vertices.size() / sizeof(VertexGPU));
+                firstIndices[geometryIdx] = static_cast<uint32_t>(indices.size());
+                vertices.insert(vertices.end(), mesh.mesh.vertices.begin(), mesh.mesh.vertices.end());
+                indices.insert(indices.end(), mesh.mesh.indices.begin(), mesh.mesh.indices.end());
+        }
+
+        // species whose geometry failed to load are left out, in catalog order
+        int numImpostorLayers = 0;
+        for (const SCENE::FoliageSpecies& species : this->m_foliageCatalog.species()) {
+                const LoadingState::MeshData& mesh = this->m_loadingState->meshes[species.geometry];
+                if (mesh.loaded == false) {
                         continue;
                 }
-
-                std::vector<Vertex> meshVertices;
-                std::vector<uint32_t> meshIndices;
-                meshVertices.reserve(shapes.size() * 64);
-                meshIndices.reserve(shapes.size() * 64);
-                uint32_t localVertexCounter = 0u;
-
-                for (const auto& shape : shapes) {
-                        for (const auto& idx : shape.mesh.indices) {
-                                Vertex vertex{};
-                                if (idx.vertex_index >= 0) {
-                                        vertex.position = glm::vec3(
-                                                attrib.vertices[3 * idx.vertex_index + 0],
-                                                attrib.vertices[3 * idx.vertex_index + 1],
-                                                attrib.vertices[3 * idx.vertex_index + 2]
-                                        );
-                                }
-                                if (idx.normal_index >= 0) {
-                                        vertex.normal = glm::vec3(
-                                                attrib.normals[3 * idx.normal_index + 0],
-                                                attrib.normals[3 * idx.normal_index + 1],
-                                                attrib.normals[3 * idx.normal_index + 2]
-                                        );
-                                }
-                                else {
-                                        vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                                }
-                                if (idx.texcoord_index >= 0) {
-                                        vertex.uv = glm::vec2(
-                                                attrib.texcoords[2 * idx.texcoord_index + 0],
-                                                attrib.texcoords[2 * idx.texcoord_index + 1]
-                                        );
-                                }
-                                else {
-                                        vertex.uv = glm::vec2(0.0f);
-                                }
-                                meshVertices.push_back(vertex);
-                                meshIndices.push_back(localVertexCounter);
-                                localVertexCounter = localVertexCounter + 1u;
-                        }
+                MeshInfo info;
+                info.name = species.name;
+                info.sampleFile = species.sampleFile;
+                info.baseVertex = baseVertices[species.geometry];
+                info.textureLayer = species.textureLayer;
+                info.density = species.density;
+                info.scaleJitter = species.scaleJitter;
+                info.cullDistance = species.cullDistance;
+                info.impostorDistance = species.impostorDistance;
+                info.impostorCrossfade = species.impostorCrossfade;
+                if (species.impostorDistance > 0.0f) {
+                        info.impostorLayer = numImpostorLayers++;
+                }
+                info.boundingSphere = glm::make_vec4(mesh.mesh.boundingSphere);
+                for (size_t lodIdx = 0; lodIdx < mesh.mesh.lods.size() && lodIdx < species.lodDistances.size(); ++lodIdx) {
+                        MeshLod lod{};
+                        lod.firstIndex = firstIndices[species.geometry] + mesh.mesh.lods[lodIdx].firstIndex;
+                        lod.indexCount = mesh.mesh.lods[lodIdx].indexCount;
+                        lod.maxDistance = species.lodDistances[lodIdx];
+                        info.lods.push_back(lod);
                 }
-
-                const uint32_t baseVertex = static_cast<uint32_t>(vertices.size());
-                const uint32_t firstIndex = static_cast<uint32_t>(indices.size());
-                vertices.insert(vertices.end(), meshVertices.begin(), meshVertices.end());
-                indices.insert(indices.end(), meshIndices.begin(), meshIndices.end());
-
-                MeshInfo info{};
-                info.name = objFile;
-                info.textureLayer = meshInfos[meshIdx].second;
-                info.baseVertex = baseVertex;
-                info.firstIndex = firstIndex;
-                info.indexCount = static_cast<uint32_t>(meshIndices.size());
                 this->m_meshInfos.push_back(info);
         }
+        this->m_loadingState->meshes.clear();
 
         glGenVertexArrays(1, &this->m_foliageVao);
         glBindVertexArray(this->m_foliageVao);
 
         glGenBuffers(1, &this->m_foliageVbo);
         glBindBuffer(GL_ARRAY_BUFFER, this->m_foliageVbo);
-        glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, vertices.size(), vertices.data(), GL_STATIC_DRAW);
 
         glGenBuffers(1, &this->m_foliageIbo);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->m_foliageIbo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
 
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(0));
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, position)));
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(sizeof(glm::vec3)));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, normal)));
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(sizeof(glm::vec3) * 2));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, uv)));
 
         glBindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
-        this->m_foliageShader = OPENGL::ShaderProgram::createShaderProgram("shaders/foliage_instancing.vert", "shaders/foliage_instancing.frag");
-        if (this->m_foliageShader == nullptr) {
-                        std::cerr << "Failed to create foliage shader program" << std::endl;
-                        return;
-        }
-        glUseProgram(this->m_foliageShader->programId());
-        this->m_foliageModelLoc = glGetUniformLocation(this->m_foliageShader->programId(), "modelMat");
-        this->m_foliageViewLoc = glGetUniformLocation(this->m_foliageShader->programId(), "viewMat");
-        this->m_foliageProjLoc = glGetUniformLocation(this->m_foliageShader->programId(), "projMat");
-        this->m_foliageCameraPosLoc = glGetUniformLocation(this->m_foliageShader->programId(), "cameraPos");
-        this->m_foliageLightDirLoc = glGetUniformLocation(this->m_foliageShader->programId(), "lightDir");
-        const GLint foliageSamplerLoc = glGetUniformLocation(this->m_foliageShader->programId(), "albedoTextureArray");
-        glUniform1i(foliageSamplerLoc, 0);
-        const glm::mat4 identityMat(1.0f);
-        glUniformMatrix4fv(this->m_foliageModelLoc, 1, GL_FALSE, glm::value_ptr(identityMat));
-        glUniform3fv(this->m_foliageLightDirLoc, 1, glm::value_ptr(LIGHT_DIRECTION));
-        glUseProgram(0);
+        // the instance field depends on the mesh bounds
+        this->initializeInstanceField();
+
+        this->m_foliageShader = createFoliageProgram("shaders/foliage_instancing.frag");
+        if (this->m_foliageShader == nullptr) {
+                std::cerr << "Failed to create foliage shader program" << std::endl;
+                return;
+        }
+        this->m_foliageImpostorCrossfadeLoc = glGetUniformLocation(this->m_foliageShader->programId(), "impostorCrossfade");
+
+        // the other foliage passes are optional, FoliagePass::ALPHA_TEST is used without them
+        this->m_foliageDepthShader = createFoliageProgram("shaders/foliage_depth.frag");
+        this->m_foliageShadeShader = createFoliageProgram("shaders/foliage_shade.frag");
+        if (this->m_foliageDepthShader == nullptr || this->m_foliageShadeShader == nullptr) {
+                std::cerr << "Failed to create foliage depth pre-pass / shading programs, foliage stays alpha tested" << std::endl;
+                delete this->m_foliageDepthShader;
+                delete this->m_foliageShadeShader;
+                this->m_foliageDepthShader = nullptr;
+                this->m_foliageShadeShader = nullptr;
+        }
+        else {
+                this->m_foliageDepthImpostorCrossfadeLoc = glGetUniformLocation(this->m_foliageDepthShader->programId(), "impostorCrossfade");
+                this->m_foliageShadeImpostorCrossfadeLoc = glGetUniformLocation(this->m_foliageShadeShader->programId(), "impostorCrossfade");
+                this->m_foliageShadeAlphaToCoverageLoc = glGetUniformLocation(this->m_foliageShadeShader->programId(), "alphaToCoverage");
+        }
+
+        if (numImpostorLayers > 0) {
+                this->initializeImpostors(numImpostorLayers);
+                this->bakeImpostors();
+        }
+}
+
+void RenderingOrderExp::initializeImpostors(const int numLayers) {
+        this->m_impostorShader = OPENGL::ShaderProgram::createShaderProgram("shaders/impostor.vert", "shaders/impostor.frag");
+        if (this->m_impostorShader == nullptr) {
+                std::cerr << "Failed to create impostor shader program, far foliage stays meshes" << std::endl;
+                return;
+        }
+        glUseProgram(this->m_impostorShader->programId());
+        glUniform1i(glGetUniformLocation(this->m_impostorShader->programId(), "impostorAlbedo"), IMPOSTOR_ALBEDO_UNIT);
+        glUniform1i(glGetUniformLocation(this->m_impostorShader->programId(), "impostorNormalDepth"), IMPOSTOR_NORMAL_DEPTH_UNIT);
+        glUniform1i(glGetUniformLocation(this->m_impostorShader->programId(), "framesPerSide"), OPENGL::ImpostorAtlas::FRAMES_PER_SIDE);
+        glUniform3fv(glGetUniformLocation(this->m_impostorShader->programId(), "lightDir"), 1, glm::value_ptr(LIGHT_DIRECTION));
+        glUseProgram(0);
+
+        this->m_impostorAtlas = new OPENGL::ImpostorAtlas();
+        if (this->m_impostorAtlas->init(numLayers) == false) {
+                std::cerr << "Failed to create impostor atlas, far foliage stays meshes" << std::endl;
+                delete this->m_impostorAtlas;
+                this->m_impostorAtlas = nullptr;
+                return;
+        }
+
+        // no vertex attributes, only the quad's indices
+        glGenVertexArrays(1, &this->m_impostorVao);
+        glBindVertexArray(this->m_impostorVao);
+        glGenBuffers(1, &this->m_impostorIbo);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->m_impostorIbo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(IMPOSTOR_QUAD_INDICES), IMPOSTOR_QUAD_INDICES, GL_STATIC_DRAW);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void RenderingOrderExp::bakeImpostors() {
+        // the frames are rendered from LOD 0 with the fully mipped foliage textures
+        const bool texturesReady = this->m_loadingState->numLayersUploaded == static_cast<int>(this->m_loadingState->layers.size());
+        if (this->m_impostorAtlas == nullptr || this->m_impostorsBaked || this->m_foliageVao == 0u || texturesReady == false) {
+                return;
+        }
+        for (const MeshInfo& info : this->m_meshInfos) {
+                if (info.impostorLayer < 0 || info.lods.empty()) {
+                        continue;
+                }
+                this->m_impostorAtlas->bake(info.impostorLayer, this->m_foliageVao, static_cast<GLsizei>(info.lods[0].indexCount), info.lods[0].firstIndex, static_cast<GLint>(info.baseVertex),
+                        info.boundingSphere, this->m_foliageTextureArray, info.textureLayer);
+        }
+        this->m_impostorAtlas->finish();
+        this->m_impostorsBaked = true;
+        const int framesPerLayer = OPENGL::ImpostorAtlas::FRAMES_PER_SIDE * OPENGL::ImpostorAtlas::FRAMES_PER_SIDE;
+        std::cout << "[Impostors] " << this->m_impostorAtlas->numLayers() << " atlas layers of " << framesPerLayer << " frames baked" << std::endl;
+}
+
+void RenderingOrderExp::loadFoliageTexture(const size_t layer) {
+        loadCompressedTexture(this->m_foliageCatalog.textures()[layer], this->m_loadingState->layers[layer]);
+}
+
+void RenderingOrderExp::uploadFoliageTexture(const size_t layer) {
+        SCENE::TextureCacheData& texture = this->m_loadingState->layers[layer];
+        glBindTexture(GL_TEXTURE_2D_ARRAY, this->m_foliageTextureArray);
+        for (size_t level = 0; level < texture.levels.size(); ++level) {
+                const GLsizei levelWidth = std::max(IMG_WIDTH >> level, 1);
+                const GLsizei levelHeight = std::max(IMG_HEIGHT >> level, 1);
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, static_cast<GLint>(level), 0, 0, static_cast<GLint>(layer), levelWidth, levelHeight, 1,
+                        FOLIAGE_TEXTURE_FORMAT, static_cast<GLsizei>(texture.levels[level].size()), texture.levels[level].data());
+        }
+        texture = SCENE::TextureCacheData();
+        this->m_loadingState->numLayersUploaded++;
+        if (this->m_loadingState->numLayersUploaded == static_cast<int>(this->m_loadingState->layers.size())) {
+                glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, FOLIAGE_TEXTURE_LEVELS - 1);
+        }
+        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        this->bakeImpostors();
 }
 
-void RenderingOrderExp::initializeTextureArray() {
-        stbi_set_flip_vertically_on_load(true);
-        const std::array<std::string, NUM_FOLIAGE_TEXTURES> textures = { {
-                "assets/textures/grassB_albedo.png",
-                "assets/textures/bush01.png",
-                "assets/textures/bush05.png"
-        } };
+uint32_t RenderingOrderExp::instanceFieldContentKey() const {
+        // the v1 sample files (size + modification time) and everything packInstance(), the cell
+        // bounds and the tiles depend on
+        uint32_t key = hashBytes(FNV_OFFSET_BASIS, &INSTANCE_CELL_SIZE, sizeof(INSTANCE_CELL_SIZE));
+        const float scaleRange[2] = { MIN_INSTANCE_SCALE, MAX_INSTANCE_SCALE };
+        key = hashBytes(key, scaleRange, sizeof(scaleRange));
+        key = hashBytes(key, &CELLS_PER_TILE_EDGE, sizeof(CELLS_PER_TILE_EDGE));
+        key = hashBytes(key, &this->m_worldRepeat, sizeof(this->m_worldRepeat));
+        for (size_t meshIdx = 0; meshIdx < this->m_meshInfos.size(); ++meshIdx) {
+                const MeshInfo& info = this->m_meshInfos[meshIdx];
+                key = hashBytes(key, &info.boundingSphere, sizeof(info.boundingSphere));
+                key = hashBytes(key, &info.scaleJitter, sizeof(info.scaleJitter));
+                key = hashBytes(key, &info.density, sizeof(info.density));
+                key = hashBytes(key, info.sampleFile.data(), info.sampleFile.size());
+
+                std::error_code error;
+                const uint64_t fileSize = static_cast<uint64_t>(std::filesystem::file_size(info.sampleFile, error));
+                const int64_t writeTime = static_cast<int64_t>(std::filesystem::last_write_time(info.sampleFile, error).time_since_epoch().count());
+                key = hashBytes(key, &fileSize, sizeof(fileSize));
+                key = hashBytes(key, &writeTime, sizeof(writeTime));
+        }
+        return key;
+}
 
-        const size_t layerSize = static_cast<size_t>(IMG_WIDTH) * IMG_HEIGHT * IMG_CHANNEL;
-        std::vector<unsigned char> merged(layerSize * NUM_FOLIAGE_TEXTURES, 0);
+void RenderingOrderExp::bakeInstanceField(const uint32_t contentKey, BakedInstanceField& baked) {
+        using namespace SCENE::EXPERIMENTAL;
+        const size_t numMeshes = this->m_meshInfos.size();
+        std::vector<SpatialSample*> samples(numMeshes, nullptr);
+        glm::vec2 sampleMin(std::numeric_limits<float>::max());
+        glm::vec2 sampleMax(-std::numeric_limits<float>::max());
+        for (size_t meshIdx = 0; meshIdx < numMeshes; ++meshIdx) {
+                // read by the loader's sample jobs, owned by the bake from here on
+                samples[meshIdx] = this->m_loadingState->samples[meshIdx];
+                this->m_loadingState->samples[meshIdx] = nullptr;
+                for (int i = 0; samples[meshIdx] != nullptr && i < samples[meshIdx]->numSample(); ++i) {
+                        const float* pos = samples[meshIdx]->position(i);
+                        sampleMin = glm::min(sampleMin, glm::vec2(pos[0], pos[2]));
+                        sampleMax = glm::max(sampleMax, glm::vec2(pos[0], pos[2]));
+                }
+        }
+        // m_worldRepeat^2 copies of the sample sets side by side, the original one at the origin
+        const glm::vec2 period = sampleMax - sampleMin;
+        const int repeat = std::max(this->m_worldRepeat, 1);
 
-        for (size_t i = 0; i < textures.size(); ++i) {
-                int width = 0;
-                int height = 0;
-                int channel = 0;
-                unsigned char* data = stbi_load(textures[i].c_str(), &width, &height, &channel, STBI_rgb_alpha);
-                if (data == nullptr) {
-                        std::cerr << "Failed to load texture: " << textures[i] << std::endl;
-                        continue;
+        std::vector<RawInstance> rawInstances;
+        rawInstances.reserve(200000);
+        for (size_t meshIdx = 0; meshIdx < numMeshes; ++meshIdx) {
+                const SpatialSample* sample = samples[meshIdx];
+                const size_t meshStart = rawInstances.size();
+                if (sample != nullptr) {
+                        const uint32_t numSample = static_cast<uint32_t>(sample->numSample());
+                        rawInstances.reserve(rawInstances.size() + numSample * static_cast<size_t>(repeat * repeat));
+                        // yaw is the rotation about the up axis (radians y); sample sets authored without
+                        // rotations get a hashed one. Tilt (radians x / z) is not represented.
+                        bool hasRotation = false;
+                        for (uint32_t i = 0u; i < numSample && hasRotation == false; ++i) {
+                                hasRotation = sample->radians(i)[1] != 0.0f;
+                        }
+                        const MeshInfo& meshInfo = this->m_meshInfos[meshIdx];
+                        // species with a density below 1 keep a hashed subset of the samples
+                        const uint32_t keepThreshold = static_cast<uint32_t>(static_cast<double>(meshInfo.density) * 4294967295.0);
+                        for (int copy = 0; copy < repeat * repeat; ++copy) {
+                                const glm::vec3 offset(static_cast<float>(copy % repeat - repeat / 2) * period.x, 0.0f, static_cast<float>(copy / repeat - repeat / 2) * period.y);
+                                for (uint32_t i = 0u; i < numSample; ++i) {
+                                        if (meshInfo.density < 1.0f && hashInstance(static_cast<uint32_t>(meshIdx) * 0x9E3779B9u + static_cast<uint32_t>(copy) * numSample + i) > keepThreshold) {
+                                                continue;
+                                        }
+                                        const float* pos = sample->position(i);
+                                        const uint32_t hash = hashInstance(static_cast<uint32_t>(rawInstances.size()));
+                                        const float yaw = hasRotation ? sample->radians(i)[1] : static_cast<float>(hash & 0xFFFFu) / 65536.0f * glm::two_pi<float>();
+                                        const float scale = 1.0f + meshInfo.scaleJitter * (static_cast<float>(hash >> 16) / 32767.5f - 1.0f);
+                                        RawInstance raw{};
+                                        raw.position = glm::vec3(pos[0], pos[1], pos[2]) + offset;
+                                        raw.meshID = static_cast<uint32_t>(meshIdx);
+                                        raw.transform = packInstanceTransform(yaw, scale);
+                                        rawInstances.push_back(raw);
+                                }
+                        }
+                        delete sample;
                 }
+                baked.meshInstanceCounts.push_back(static_cast<uint32_t>(rawInstances.size() - meshStart));
+        }
 
-                const int copyWidth = std::min(width, IMG_WIDTH);
-                const int copyHeight = std::min(height, IMG_HEIGHT);
-                for (int y = 0; y < copyHeight; ++y) {
-                        unsigned char* dst = merged.data() + i * layerSize + static_cast<size_t>(y) * IMG_WIDTH * IMG_CHANNEL;
-                        const unsigned char* src = data + static_cast<size_t>(y) * width * IMG_CHANNEL;
-                        std::memcpy(dst, src, static_cast<size_t>(copyWidth) * IMG_CHANNEL);
+        std::vector<glm::vec4> meshBounds;
+        meshBounds.reserve(numMeshes);
+        for (size_t meshIdx = 0; meshIdx < numMeshes; ++meshIdx) {
+                meshBounds.push_back(this->m_meshInfos[meshIdx].boundingSphere);
+        }
+        baked.cells = binInstancesIntoCells(rawInstances, meshBounds, baked.tiles, baked.tileMeshCounts);
+
+        // positions quantized inside the bounds of their cell, 12 instead of 32 bytes per instance
+        baked.records.resize(rawInstances.size());
+        for (const InstanceCellGPU& cell : baked.cells) {
+                for (uint32_t i = cell.range.x; i < cell.range.x + cell.range.y; ++i) {
+                        baked.records[i] = packInstance(rawInstances[i], cell);
                 }
-                stbi_image_free(data);
         }
 
-        glGenTextures(1, &this->m_foliageTextureArray);
-        glBindTexture(GL_TEXTURE_2D_ARRAY, this->m_foliageTextureArray);
-        glTexStorage3D(GL_TEXTURE_2D_ARRAY, 11, GL_RGBA8, IMG_WIDTH, IMG_HEIGHT, NUM_FOLIAGE_TEXTURES);
-        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, IMG_WIDTH, IMG_HEIGHT, NUM_FOLIAGE_TEXTURES, GL_RGBA, GL_UNSIGNED_BYTE, merged.data());
-        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
-        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+        SCENE::InstanceFieldHeader& header = baked.header;
+        header.contentKey = contentKey;
+        header.numMeshes = static_cast<uint32_t>(baked.meshInstanceCounts.size());
+        header.numChunks = static_cast<uint32_t>(baked.cells.size());
+        header.numInstances = static_cast<uint32_t>(baked.records.size());
+        header.recordStride = sizeof(PackedInstanceGPU);
+        header.numTiles = static_cast<uint32_t>(baked.tiles.size());
+        if (baked.cells.empty()) {
+                return;
+        }
+        glm::vec4 boundsMin = baked.cells[0].boundsMin;
+        glm::vec4 boundsMax = baked.cells[0].boundsMax;
+        for (const InstanceCellGPU& cell : baked.cells) {
+                boundsMin = glm::min(boundsMin, cell.boundsMin);
+                boundsMax = glm::max(boundsMax, cell.boundsMax);
+        }
+        std::memcpy(header.boundsMin, glm::value_ptr(boundsMin), sizeof(header.boundsMin));
+        std::memcpy(header.boundsMax, glm::value_ptr(boundsMax), sizeof(header.boundsMax));
+
+        // a missing cache only costs this bake on the next start
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(INSTANCE_FIELD_FILE).parent_path(), error);
+        if (SCENE::InstanceField::write(INSTANCE_FIELD_FILE, header, baked.meshInstanceCounts.data(), reinterpret_cast<const SCENE::InstanceFieldChunk*>(baked.cells.data()), baked.records.data(), baked.tiles.data(), baked.tileMeshCounts.data()) == false) {
+                std::cerr << "Failed to write instance field cache: " << INSTANCE_FIELD_FILE << std::endl;
+        }
+}
+
+void RenderingOrderExp::initializeInstanceField() {
+        const size_t numMeshes = this->m_meshInfos.size();
+        const uint32_t contentKey = this->instanceFieldContentKey();
+        this->m_loadingState->contentKey = contentKey;
+
+        // the SS2 v2 field is streamed straight from its mapping; it is rebuilt from the v1 sample
+        // files when it is missing or was built from different inputs or with another tile layout
+        if (this->m_instanceField.open(INSTANCE_FIELD_FILE) && this->m_instanceField.header().contentKey == contentKey && this->m_instanceField.header().numMeshes == numMeshes && this->m_instanceField.header().recordStride == sizeof(PackedInstanceGPU) && tilesFitTileSlots(this->m_instanceField.tiles(), this->m_instanceField.header().numTiles)) {
+                this->m_assetLoader.submit(SCENE::AssetLoader::Step(), [this]() { this->initializeInstanceBuffers(); });
+                return;
+        }
+
+        // the sample sets are read in parallel, the bake starts once all of them are there
+        this->m_bakedField = new BakedInstanceField();
+        const auto submitBake = [this]() {
+                this->m_assetLoader.submit([this]() { this->bakeInstanceField(this->m_loadingState->contentKey, *this->m_bakedField); }, [this]() { this->initializeInstanceBuffers(); });
+        };
+        if (numMeshes == 0) {
+                submitBake();
+                return;
+        }
+        this->m_loadingState->samples.assign(numMeshes, nullptr);
+        for (size_t meshIdx = 0; meshIdx < numMeshes; ++meshIdx) {
+                this->m_assetLoader.submit([this, meshIdx]() {
+                        this->m_loadingState->samples[meshIdx] = SCENE::EXPERIMENTAL::SpatialSample::importBinaryFile(this->m_meshInfos[meshIdx].sampleFile);
+                }, [this, numMeshes, submitBake]() {
+                        this->m_loadingState->numSamplesRead++;
+                        if (this->m_loadingState->numSamplesRead == static_cast<int>(numMeshes)) {
+                                submitBake();
+                        }
+                });
+        }
 }
 
 void RenderingOrderExp::initializeInstanceBuffers() {
-        using namespace SCENE::EXPERIMENTAL;
-        const std::array<std::string, NUM_FOLIAGE_TEXTURES> sampleFiles = { {
-                "assets/models/spatialSamples/poissonPoints_155304s.ss2",
-                "assets/models/spatialSamples/poissonPoints_1010s.ss2",
-                "assets/models/spatialSamples/poissonPoints_2797s.ss2"
-        } };
+        const size_t numMeshes = this->m_meshInfos.size();
+
+        // mapped SS2 v2 file, or the field initializeInstanceField() had to bake
+        const SCENE::InstanceFieldHeader* header = nullptr;
+        const uint32_t* meshInstanceCounts = nullptr;
+        const uint32_t* tileMeshCounts = nullptr;
+        SCENE::TiledInstanceSource source;
+        if (this->m_bakedField == nullptr) {
+                header = &this->m_instanceField.header();
+                meshInstanceCounts = this->m_instanceField.meshInstanceCounts();
+                tileMeshCounts = this->m_instanceField.tileMeshCounts();
+                source.tiles = this->m_instanceField.tiles();
+                source.chunks = this->m_instanceField.chunks();
+                source.records = this->m_instanceField.records();
+        }
+        else {
+                this->m_bakedField->meshInstanceCounts.resize(numMeshes, 0u);
+                header = &this->m_bakedField->header;
+                meshInstanceCounts = this->m_bakedField->meshInstanceCounts.data();
+                tileMeshCounts = this->m_bakedField->tileMeshCounts.data();
+                source.tiles = this->m_bakedField->tiles.data();
+                source.chunks = reinterpret_cast<const SCENE::InstanceFieldChunk*>(this->m_bakedField->cells.data());
+                source.records = reinterpret_cast<const unsigned char*>(this->m_bakedField->records.data());
+        }
+        source.numTiles = header->numTiles;
+        source.recordStride = header->recordStride;
+        if (header->numTiles > 0u) {
+                // picked up by the next simulate()
+                this->m_fieldBoundsMin = glm::vec2(header->boundsMin[0], header->boundsMin[2]);
+                this->m_fieldBoundsMax = glm::vec2(header->boundsMax[0], header->boundsMax[2]);
+                this->m_fieldBoundsReady.store(true, std::memory_order_release);
+        }
 
-        std::vector<RawInstancePropertiesGPU> rawInstances;
-        rawInstances.reserve(200000);
+        // Tile pool: a slot for every tile within the streaming radius of the player, each as large as
+        // the fullest tile. Its size follows the instance density, not the size of the world.
+        uint32_t recordsPerSlot = 0u;
+        for (uint32_t t = 0u; t < source.numTiles; ++t) {
+                recordsPerSlot = std::max(recordsPerSlot, source.tiles[t].numRecords);
+        }
+        if (tilesFitTileSlots(source.tiles, source.numTiles) == false) {
+                std::cerr << "Instance field tiles have more than " << CELLS_PER_TILE << " cells, no foliage" << std::endl;
+                this->m_totalInstanceCount = 0u;
+                return;
+        }
+        const int numSlots = std::min(static_cast<int>(source.numTiles), SCENE::TileStreamer::slotsForRadius(STREAMING_RADIUS + INSTANCE_CELL_SIZE, TILE_SIZE));
+        this->m_numInstanceCells = static_cast<uint32_t>(numSlots) * CELLS_PER_TILE;
+        this->m_instancePoolSize = static_cast<uint32_t>(numSlots) * recordsPerSlot;
 
-        uint32_t baseInstance = 0u;
+        uint32_t totalInstances = 0u;
+        uint32_t visibleCapacity = 0u;
+        uint32_t impostorCapacity = 0u;
         this->m_drawCommands.clear();
-        this->m_drawCommands.resize(this->m_meshInfos.size());
-
-        for (size_t meshIdx = 0; meshIdx < this->m_meshInfos.size() && meshIdx < sampleFiles.size(); ++meshIdx) {
-                SpatialSample* sample = SpatialSample::importBinaryFile(sampleFiles[meshIdx]);
-                uint32_t meshCount = 0u;
-                if (sample != nullptr) {
-                        meshCount = static_cast<uint32_t>(sample->numSample());
-                        rawInstances.reserve(rawInstances.size() + meshCount);
-                        for (uint32_t i = 0u; i < meshCount; ++i) {
-                                const float* pos = sample->position(i);
-                                RawInstancePropertiesGPU raw{};
-                                raw.position = glm::vec4(pos[0], pos[1], pos[2], static_cast<float>(this->m_meshInfos[meshIdx].textureLayer));
-                                raw.indices = glm::ivec4(static_cast<int>(meshIdx), static_cast<int>(this->m_meshInfos[meshIdx].textureLayer), 0, 0);
-                                rawInstances.push_back(raw);
-                        }
-                        delete sample;
+        this->m_impostorCommand = -1;
+
+        for (size_t meshIdx = 0; meshIdx < numMeshes; ++meshIdx) {
+                const uint32_t meshCount = meshInstanceCounts[meshIdx];
+                // the most instances of the mesh any numSlots resident tiles can hold
+                std::vector<uint32_t> countPerTile(source.numTiles);
+                for (uint32_t t = 0u; t < source.numTiles; ++t) {
+                        countPerTile[t] = tileMeshCounts[t * numMeshes + meshIdx];
                 }
+                std::sort(countPerTile.begin(), countPerTile.end(), std::greater<uint32_t>());
+                uint32_t meshCapacity = 0u;
+                for (int t = 0; t < numSlots; ++t) {
+                        meshCapacity += countPerTile[t];
+                }
+
                 MeshInfo& info = this->m_meshInfos[meshIdx];
-                info.rawOffset = baseInstance;
                 info.rawCount = meshCount;
+                info.firstCommand = static_cast<uint32_t>(this->m_drawCommands.size());
+
+                // one command per mesh x LOD, each with room for every resident instance of the mesh
+                for (const MeshLod& lod : info.lods) {
+                        DrawCommand cmd{};
+                        cmd.count = lod.indexCount;
+                        cmd.instanceCount = 0u;
+                        cmd.firstIndex = lod.firstIndex;
+                        cmd.baseVertex = info.baseVertex;
+                        cmd.baseInstance = visibleCapacity;
+                        this->m_drawCommands.push_back(cmd);
+                        visibleCapacity += meshCapacity;
+                }
+                if (info.impostorLayer >= 0) {
+                        impostorCapacity += meshCapacity;
+                }
+                totalInstances += meshCount;
+        }
 
+        // one quad command for the far instances of every species with an impostor, after the mesh commands
+        if (impostorCapacity > 0u && this->m_impostorAtlas != nullptr) {
                 DrawCommand cmd{};
-                cmd.count = info.indexCount;
-                cmd.instanceCount = 0u;
-                cmd.firstIndex = info.firstIndex;
-                cmd.baseVertex = info.baseVertex;
-                cmd.baseInstance = baseInstance;
-                this->m_drawCommands[meshIdx] = cmd;
-                baseInstance += meshCount;
+                cmd.count = static_cast<uint32_t>(sizeof(IMPOSTOR_QUAD_INDICES) / sizeof(GLuint));
+                cmd.baseInstance = visibleCapacity;
+                this->m_impostorCommand = static_cast<int>(this->m_drawCommands.size());
+                this->m_drawCommands.push_back(cmd);
+                visibleCapacity += impostorCapacity;
+        }
+
+        // every view gets its own copy of the commands and its own range of visible instances
+        this->m_commandsPerView = static_cast<uint32_t>(this->m_drawCommands.size());
+        for (int view = 1; view < NUM_CULL_VIEWS; ++view) {
+                for (uint32_t c = 0u; c < this->m_commandsPerView; ++c) {
+                        DrawCommand cmd = this->m_drawCommands[c];
+                        cmd.baseInstance += static_cast<uint32_t>(view) * visibleCapacity;
+                        this->m_drawCommands.push_back(cmd);
+                }
         }
+        visibleCapacity *= NUM_CULL_VIEWS;
 
-        this->m_totalInstanceCount = baseInstance;
+        this->m_totalInstanceCount = totalInstances;
 
-        if (this->m_totalInstanceCount == 0u) {
+        if (this->m_totalInstanceCount == 0u || header->numInstances != totalInstances || this->m_instancePoolSize == 0u) {
+                this->m_totalInstanceCount = 0u;
                 return;
         }
 
+        std::vector<glm::vec4> meshBounds;
+        meshBounds.reserve(this->m_meshInfos.size());
+        for (const MeshInfo& info : this->m_meshInfos) {
+                meshBounds.push_back(info.boundingSphere);
+        }
+
+        // filled by the tile streamer, copy destinations only
+        glGenBuffers(1, &this->m_instanceCellSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_instanceCellSSBO);
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(this->m_numInstanceCells) * sizeof(InstanceCellGPU), nullptr, 0);
+
         glGenBuffers(1, &this->m_rawInstanceSSBO);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_rawInstanceSSBO);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, rawInstances.size() * sizeof(RawInstancePropertiesGPU), rawInstances.data(), GL_STATIC_DRAW);
-
+        glBufferStorage(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(this->m_instancePoolSize) * sizeof(PackedInstanceGPU), nullptr, 0);
+
+        // x: cells of the tile in the slot (0 while empty or loading), y: tile
+        const std::vector<glm::uvec4> emptyTable(static_cast<size_t>(numSlots), glm::uvec4(0u));
+        glGenBuffers(1, &this->m_tileSlotSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_tileSlotSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, emptyTable.size() * sizeof(glm::uvec4), emptyTable.data(), GL_DYNAMIC_DRAW);
+
+        glGenBuffers(1, &this->m_visibleCellSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_visibleCellSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_numInstanceCells * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        // y and z stay 1, the cell pass only counts x (reset with glClearBufferSubData)
+        const GLuint cellDispatch[3] = { 0u, 1u, 1u };
+        glGenBuffers(1, &this->m_cellDispatchBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_cellDispatchBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(cellDispatch), cellDispatch, GL_DYNAMIC_DRAW);
+
+        // prefix sum compaction: survivors per cell x command, rank of every instance in every view
+        glGenBuffers(1, &this->m_cellCommandCountSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_cellCommandCountSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_numInstanceCells * MAX_DRAW_COMMANDS * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+        this->m_numCompactScanGroups = (this->m_numInstanceCells + COMPACT_SCAN_GROUP_SIZE - 1u) / COMPACT_SCAN_GROUP_SIZE;
+        glGenBuffers(1, &this->m_scanGroupTotalSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_scanGroupTotalSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_numCompactScanGroups * MAX_DRAW_COMMANDS * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        // a mesh and, with impostors, an impostor command slot per view
+        const size_t commandSlots = (this->m_impostorCommand >= 0 ? 2 : 1) * NUM_CULL_VIEWS;
+        glGenBuffers(1, &this->m_instanceSlotSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_instanceSlotSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, commandSlots * this->m_instancePoolSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        // zero filled on the GPU, no CPU side arrays of the pool size
         glGenBuffers(1, &this->m_visibleInstanceSSBO);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_visibleInstanceSSBO);
-        std::vector<InstancePropertiesGPU> emptyInstances(this->m_totalInstanceCount);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, emptyInstances.size() * sizeof(InstancePropertiesGPU), emptyInstances.data(), GL_DYNAMIC_DRAW);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(visibleCapacity) * sizeof(InstancePropertiesGPU), nullptr, GL_DYNAMIC_DRAW);
+        glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
 
+        // cleared per tile when it is streamed in
         glGenBuffers(1, &this->m_instanceStateSSBO);
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_instanceStateSSBO);
-        std::vector<uint32_t> initialState(this->m_totalInstanceCount, 0u);
-        glBufferData(GL_SHADER_STORAGE_BUFFER, initialState.size() * sizeof(uint32_t), initialState.data(), GL_DYNAMIC_DRAW);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_instancePoolSize * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        // every instance can be an occlusion candidate in the worst case, (instance, cell) pairs
+        glGenBuffers(1, &this->m_occlusionCandidateSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_occlusionCandidateSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_instancePoolSize * 2 * sizeof(uint32_t), nullptr, GL_DYNAMIC_DRAW);
+
+        // x and the candidate count are reset by the cell pass every frame
+        const LateDispatchGPU lateDispatch = { 0u, 1u, 1u, 0u };
+        glGenBuffers(1, &this->m_lateDispatchBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_lateDispatchBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(LateDispatchGPU), &lateDispatch, GL_DYNAMIC_DRAW);
+
+        glGenBuffers(1, &this->m_meshBoundsSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_meshBoundsSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, meshBounds.size() * sizeof(glm::vec4), meshBounds.data(), GL_STATIC_DRAW);
+
+        std::vector<MeshLodGPU> meshLods;
+        meshLods.reserve(this->m_meshInfos.size());
+        for (const MeshInfo& info : this->m_meshInfos) {
+                MeshLodGPU lods{};
+                lods.info = glm::uvec4(info.firstCommand, static_cast<uint32_t>(info.lods.size()), info.textureLayer, static_cast<uint32_t>(std::max(info.impostorLayer, 0)));
+                for (size_t lodIdx = 0; lodIdx < info.lods.size(); ++lodIdx) {
+                        lods.maxDistances[static_cast<int>(lodIdx)] = info.lods[lodIdx].maxDistance;
+                }
+                const float impostorDistance = info.impostorLayer >= 0 ? info.impostorDistance : 0.0f;
+                lods.far = glm::vec4(info.cullDistance, impostorDistance, info.impostorCrossfade, 0.0f);
+                meshLods.push_back(lods);
+        }
+        glGenBuffers(1, &this->m_meshLodSSBO);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_meshLodSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, meshLods.size() * sizeof(MeshLodGPU), meshLods.data(), GL_STATIC_DRAW);
 
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
         this->uploadDrawCommands();
+
+        SCENE::TilePoolBuffers pool;
+        pool.cells = this->m_instanceCellSSBO;
+        pool.records = this->m_rawInstanceSSBO;
+        pool.states = this->m_instanceStateSSBO;
+        pool.tileTable = this->m_tileSlotSSBO;
+        // the tiles around the player are requested by the next render()
+        if (this->m_tileStreamer.init(source, numSlots, CELLS_PER_TILE, recordsPerSlot, pool) == false) {
+                this->m_totalInstanceCount = 0u;
+                return;
+        }
 }
 
 void RenderingOrderExp::uploadDrawCommands() {
@@ -444,6 +1568,27 @@ void RenderingOrderExp::uploadDrawCommands() {
         }
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_drawCommandSSBO);
         glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_drawCommands.size() * sizeof(DrawCommand), this->m_drawCommands.data(), GL_DYNAMIC_DRAW);
+
+        // same layout, instances found visible by the late culling pass
+        if (this->m_lateDrawCommandSSBO == 0u) {
+                glGenBuffers(1, &this->m_lateDrawCommandSSBO);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_lateDrawCommandSSBO);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, this->m_drawCommands.size() * sizeof(DrawCommand), this->m_drawCommands.data(), GL_DYNAMIC_DRAW);
+
+        // written by foliage_draw_list.comp every frame, no initial data
+        if (this->m_drawListShader != nullptr) {
+                if (this->m_drawListBuffer == 0u) {
+                        glGenBuffers(1, &this->m_drawListBuffer);
+                }
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_drawListBuffer);
+                glBufferData(GL_SHADER_STORAGE_BUFFER, NUM_DRAW_LISTS * static_cast<size_t>(this->m_commandsPerView) * sizeof(DrawCommand), nullptr, GL_DYNAMIC_DRAW);
+                if (this->m_drawCountBuffer == 0u) {
+                        glGenBuffers(1, &this->m_drawCountBuffer);
+                }
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_drawCountBuffer);
+                glBufferData(GL_SHADER_STORAGE_BUFFER, NUM_DRAW_LISTS * sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+        }
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 }
 
@@ -454,79 +1599,106 @@ void RenderingOrderExp::initializeComputeShader() {
                 return;
         }
         glUseProgram(this->m_computeShader->programId());
-        this->m_computeViewLoc = glGetUniformLocation(this->m_computeShader->programId(), "playerView");
-        this->m_computeProjLoc = glGetUniformLocation(this->m_computeShader->programId(), "playerProj");
-        this->m_computeTotalInstanceLoc = glGetUniformLocation(this->m_computeShader->programId(), "totalInstanceCount");
-        this->m_computeNumMeshesLoc = glGetUniformLocation(this->m_computeShader->programId(), "numMeshes");
-        this->m_computeEraseRadiusLoc = glGetUniformLocation(this->m_computeShader->programId(), "eraseRadius");
-        this->m_computeSlimePosLoc = glGetUniformLocation(this->m_computeShader->programId(), "slimePosition");
+        this->m_computePrefixSumCompactionLoc = glGetUniformLocation(this->m_computeShader->programId(), "prefixSumCompaction");
+        this->m_computeCullPhaseLoc = glGetUniformLocation(this->m_computeShader->programId(), "cullPhase");
+        this->m_computeOcclusionEnabledLoc = glGetUniformLocation(this->m_computeShader->programId(), "occlusionEnabled");
+        this->m_computeOcclusionViewProjLoc = glGetUniformLocation(this->m_computeShader->programId(), "occlusionViewProj");
+        this->m_computeHiZSizeLoc = glGetUniformLocation(this->m_computeShader->programId(), "hiZSize");
+        this->m_computeHiZLevelsLoc = glGetUniformLocation(this->m_computeShader->programId(), "hiZLevels");
+        const GLint hiZSamplerLoc = glGetUniformLocation(this->m_computeShader->programId(), "hiZPyramid");
+        glUniform1i(hiZSamplerLoc, 0);
         glUseProgram(0);
+
+        this->m_cellCullShader = OPENGL::ShaderProgram::createShaderProgramForComputeShader("shaders/foliage_cell_cull.comp");
+        if (this->m_cellCullShader == nullptr) {
+                std::cerr << "Failed to create cell culling compute shader" << std::endl;
+                return;
+        }
+
+        this->m_compactShader = OPENGL::ShaderProgram::createShaderProgramForComputeShader("shaders/foliage_compact.comp");
+        if (this->m_compactShader == nullptr) {
+                std::cerr << "Failed to create compaction compute shader" << std::endl;
+                return;
+        }
+        glUseProgram(this->m_compactShader->programId());
+        this->m_compactPassLoc = glGetUniformLocation(this->m_compactShader->programId(), "compactPass");
+        glUseProgram(0);
+
+        // the draw lists are only consumed by glMultiDrawElementsIndirectCount (GL 4.6 or ARB_indirect_parameters)
+        if (glMultiDrawElementsIndirectCount == nullptr) {
+                std::cout << "No indirect count draws, foliage issues every draw command" << std::endl;
+                return;
+        }
+        this->m_drawListShader = OPENGL::ShaderProgram::createShaderProgramForComputeShader("shaders/foliage_draw_list.comp");
+        if (this->m_drawListShader == nullptr) {
+                std::cerr << "Failed to create draw list compute shader" << std::endl;
+                return;
+        }
+        this->m_drawListLateLoc = glGetUniformLocation(this->m_drawListShader->programId(), "lateDrawList");
 }
 
-void RenderingOrderExp::initializeSlime() {
-        tinyobj::attrib_t attrib;
-        std::vector<tinyobj::shape_t> shapes;
-        std::vector<tinyobj::material_t> materials;
-        std::string warn;
-        std::string err;
-        const std::string slimePath = "assets/models/foliages/slime.obj";
-        const std::string baseDir = directoryFromPath(slimePath);
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, slimePath.c_str(), baseDir.c_str(), true)) {
-                std::cerr << "Failed to load slime obj: " << err << std::endl;
-        }
-        if (!warn.empty()) {
-                std::cout << "[TinyObjLoader] " << warn << std::endl;
-        }
-
-        std::vector<Vertex> slimeVertices;
-        std::vector<uint32_t> slimeIndices;
-        uint32_t localVertexCounter = 0u;
-        for (const auto& shape : shapes) {
-                for (const auto& idx : shape.mesh.indices) {
-                        Vertex vertex{};
-                        if (idx.vertex_index >= 0) {
-                                vertex.position = glm::vec3(
-                                        attrib.vertices[3 * idx.vertex_index + 0],
-                                        attrib.vertices[3 * idx.vertex_index + 1],
-                                        attrib.vertices[3 * idx.vertex_index + 2]
-                                );
-                        }
-                        if (idx.normal_index >= 0) {
-                                vertex.normal = glm::vec3(
-                                        attrib.normals[3 * idx.normal_index + 0],
-                                        attrib.normals[3 * idx.normal_index + 1],
-                                        attrib.normals[3 * idx.normal_index + 2]
-                                );
-                        }
-                        else {
-                                vertex.normal = glm::vec3(0.0f, 1.0f, 0.0f);
-                        }
-                        if (idx.texcoord_index >= 0) {
-                                vertex.uv = glm::vec2(
-                                        attrib.texcoords[2 * idx.texcoord_index + 0],
-                                        attrib.texcoords[2 * idx.texcoord_index + 1]
-                                );
-                        }
-                        slimeVertices.push_back(vertex);
-                        slimeIndices.push_back(localVertexCounter++);
-                }
+void RenderingOrderExp::initializeOcclusionCulling() {
+        this->m_hiZPyramid = new OPENGL::HiZPyramid();
+        if (this->m_hiZPyramid->init() == false) {
+                std::cerr << "Occlusion culling disabled" << std::endl;
+                delete this->m_hiZPyramid;
+                this->m_hiZPyramid = nullptr;
+                return;
+        }
+        // sized in resize()
+        this->m_playerViewTarget = new OPENGL::OffscreenTarget();
+}
+
+void RenderingOrderExp::initializeDebugViews() {
+        this->m_overdrawCounter = new OPENGL::OverdrawCounter();
+        this->m_foliageDebugShader = createFoliageProgram("shaders/foliage_debug.frag");
+        if (this->m_overdrawCounter->init() == false || this->m_foliageDebugShader == nullptr) {
+                std::cerr << "Foliage debug views disabled" << std::endl;
+                delete this->m_overdrawCounter;
+                delete this->m_foliageDebugShader;
+                this->m_overdrawCounter = nullptr;
+                this->m_foliageDebugShader = nullptr;
+                return;
+        }
+        const GLuint programId = this->m_foliageDebugShader->programId();
+        this->m_foliageDebugImpostorCrossfadeLoc = glGetUniformLocation(programId, "impostorCrossfade");
+        this->m_foliageDebugViewLoc = glGetUniformLocation(programId, "debugView");
+        this->m_foliageDebugCountViewLoc = glGetUniformLocation(programId, "countView");
+        this->m_foliageDebugViewportOriginLoc = glGetUniformLocation(programId, "viewportOrigin");
+        // sized in resize()
+}
+
+void RenderingOrderExp::loadSlime() {
+        loadProcessedMesh(SLIME_MESH_FILE, std::vector<float>(1, 1.0f), this->m_loadingState->slimeMesh);
+
+        int channel = 0;
+        unsigned char* data = stbi_load(SLIME_TEXTURE_FILE, &this->m_loadingState->slimeWidth, &this->m_loadingState->slimeHeight, &channel, STBI_rgb_alpha);
+        if (data == nullptr) {
+                std::cerr << "Failed to load slime texture" << std::endl;
+                return;
         }
+        this->m_loadingState->slimePixels.assign(data, data + static_cast<size_t>(this->m_loadingState->slimeWidth) * this->m_loadingState->slimeHeight * 4);
+        stbi_image_free(data);
+}
 
+void RenderingOrderExp::initializeSlime() {
+        const std::vector<unsigned char>& slimeVertices = this->m_loadingState->slimeMesh.vertices;
+        const std::vector<uint32_t>& slimeIndices = this->m_loadingState->slimeMesh.indices;
         glGenVertexArrays(1, &this->m_slimeVao);
         glBindVertexArray(this->m_slimeVao);
         glGenBuffers(1, &this->m_slimeVbo);
         glBindBuffer(GL_ARRAY_BUFFER, this->m_slimeVbo);
-        glBufferData(GL_ARRAY_BUFFER, slimeVertices.size() * sizeof(Vertex), slimeVertices.data(), GL_STATIC_DRAW);
+        glBufferData(GL_ARRAY_BUFFER, slimeVertices.size(), slimeVertices.data(), GL_STATIC_DRAW);
         glGenBuffers(1, &this->m_slimeIbo);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->m_slimeIbo);
         glBufferData(GL_ELEMENT_ARRAY_BUFFER, slimeIndices.size() * sizeof(uint32_t), slimeIndices.data(), GL_STATIC_DRAW);
 
         glEnableVertexAttribArray(0);
-        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(0));
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, position)));
         glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(sizeof(glm::vec3)));
+        glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, normal)));
         glEnableVertexAttribArray(2);
-        glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(sizeof(glm::vec3) * 2));
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(VertexGPU), reinterpret_cast<void*>(offsetof(VertexGPU, uv)));
         glBindVertexArray(0);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -540,33 +1712,25 @@ void RenderingOrderExp::initializeSlime() {
         }
         glUseProgram(this->m_slimeShader->programId());
         this->m_slimeModelLoc = glGetUniformLocation(this->m_slimeShader->programId(), "modelMat");
-        this->m_slimeViewLoc = glGetUniformLocation(this->m_slimeShader->programId(), "viewMat");
-        this->m_slimeProjLoc = glGetUniformLocation(this->m_slimeShader->programId(), "projMat");
-        this->m_slimeCameraPosLoc = glGetUniformLocation(this->m_slimeShader->programId(), "cameraPos");
         this->m_slimeLightDirLoc = glGetUniformLocation(this->m_slimeShader->programId(), "lightDir");
         const GLint slimeSamplerLoc = glGetUniformLocation(this->m_slimeShader->programId(), "albedoTexture");
         glUniform1i(slimeSamplerLoc, 0);
         glUniform3fv(this->m_slimeLightDirLoc, 1, glm::value_ptr(LIGHT_DIRECTION));
         glUseProgram(0);
 
-        int width = 0;
-        int height = 0;
-        int channel = 0;
-        unsigned char* data = stbi_load("assets/textures/slime_albedo.jpg", &width, &height, &channel, STBI_rgb_alpha);
-        if (data == nullptr) {
-                std::cerr << "Failed to load slime texture" << std::endl;
+        const std::vector<unsigned char>& pixels = this->m_loadingState->slimePixels;
+        if (pixels.empty()) {
                 return;
         }
         glGenTextures(1, &this->m_slimeTexture);
         glBindTexture(GL_TEXTURE_2D, this->m_slimeTexture);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->m_loadingState->slimeWidth, this->m_loadingState->slimeHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
         glGenerateMipmap(GL_TEXTURE_2D);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
         glBindTexture(GL_TEXTURE_2D, 0);
-        stbi_image_free(data);
 }
 
 void RenderingOrderExp::resize(const int w, const int h) {
@@ -581,123 +1745,577 @@ void RenderingOrderExp::resize(const int w, const int h) {
 
         this->m_viewFrustum->resize(this->m_playerCamera);
         this->m_horizontalGround->resize(this->m_playerCamera);
+
+        if (this->m_playerViewTarget != nullptr && this->m_hiZPyramid != nullptr) {
+                if (this->m_playerViewTarget->init(rightWidth, h) == false) {
+                        std::cerr << "Failed to create player view target, occlusion culling disabled" << std::endl;
+                        delete this->m_playerViewTarget;
+                        this->m_playerViewTarget = nullptr;
+                }
+                this->m_hiZPyramid->resize(rightWidth, h);
+                this->m_hiZValid = false;
+        }
+        if (this->m_overdrawCounter != nullptr) {
+                this->m_overdrawCounter->resize(std::max(leftWidth, rightWidth), h);
+        }
+}
+
+bool RenderingOrderExp::updateMultisampleTarget() {
+        if (this->m_foliagePass != FoliagePass::ALPHA_TO_COVERAGE || this->m_foliageShadeShader == nullptr) {
+                return false;
+        }
+        // without the player view target (occlusion culling failed) the player view is not drawn offscreen
+        if (this->m_playerViewTarget == nullptr) {
+                this->m_foliagePass = FoliagePass::ALPHA_TEST;
+                this->m_foliagePassFallback.store(true, std::memory_order_release);
+                return false;
+        }
+        if (this->m_multisampleTarget == nullptr) {
+                this->m_multisampleTarget = new OPENGL::OffscreenTarget();
+        }
+        // follows the player view target through resizes
+        if (this->m_multisampleTarget->framebufferId() == 0u || this->m_multisampleTarget->width() != this->m_playerViewTarget->width() || this->m_multisampleTarget->height() != this->m_playerViewTarget->height()) {
+                GLint maxSamples = 0;
+                glGetIntegerv(GL_MAX_SAMPLES, &maxSamples);
+                const GLint samples = std::min(MULTISAMPLE_SAMPLES, maxSamples);
+                if (samples < 2 || this->m_multisampleTarget->init(this->m_playerViewTarget->width(), this->m_playerViewTarget->height(), samples) == false) {
+                        std::cerr << "Failed to create multisample player view target, alpha to coverage disabled" << std::endl;
+                        this->m_multisampleTarget->release();
+                        this->m_foliagePass = FoliagePass::ALPHA_TEST;
+                        this->m_foliagePassFallback.store(true, std::memory_order_release);
+                        return false;
+                }
+        }
+        return true;
+}
+
+void RenderingOrderExp::update(const double elapsedSeconds) {
+        this->simulate(elapsedSeconds);
+        this->applySnapshot(this->snapshot());
+}
+
+void RenderingOrderExp::simulate(const double elapsedSeconds) {
+        if (this->m_fieldBoundsReady.exchange(false, std::memory_order_acquire)) {
+                this->m_slimeTrajectory.setBounds(this->m_fieldBoundsMin, this->m_fieldBoundsMax);
+        }
+        // the GUI and the reports show the pass that is drawn; selecting it again retries it
+        if (this->m_foliagePassFallback.exchange(false, std::memory_order_acquire) && this->m_settings.foliagePass == FoliagePass::ALPHA_TO_COVERAGE) {
+                this->m_settings.foliagePass = FoliagePass::ALPHA_TEST;
+        }
+        const int numSteps = this->m_simulationClock.advance(elapsedSeconds);
+        for (int step = 0; step < numSteps; step++) {
+                this->m_previousPose = this->m_currentPose;
+                this->simulationStep();
+                this->m_currentPose = this->capturePose();
+        }
+        const float alpha = this->m_simulationClock.alpha();
+        this->m_renderPose.eye = glm::mix(this->m_previousPose.eye, this->m_currentPose.eye, alpha);
+        this->m_renderPose.lookCenter = glm::mix(this->m_previousPose.lookCenter, this->m_currentPose.lookCenter, alpha);
+        this->m_renderPose.slime = glm::mix(this->m_previousPose.slime, this->m_currentPose.slime, alpha);
 }
 
-void RenderingOrderExp::update() {
+void RenderingOrderExp::simulationStep() {
         this->updatePlayerCameraMovement();
-        this->m_playerCamera->forward(this->m_cameraForwardMagnitude, true);
-        this->m_playerCamera->update();
+        this->m_simulationCamera->forward(this->m_cameraForwardMagnitude, true);
+        this->m_simulationCamera->update();
+
+        this->m_slimeTrajectory.update();
+}
+
+RenderingOrderExp::SimulationPose RenderingOrderExp::capturePose() const {
+        SimulationPose pose;
+        pose.eye = this->m_simulationCamera->viewOrig();
+        pose.lookCenter = this->m_simulationCamera->lookCenter();
+        pose.slime = this->m_slimeTrajectory.position();
+        return pose;
+}
+
+FrameSnapshot RenderingOrderExp::snapshot() const {
+        FrameSnapshot snapshot;
+        snapshot.playerEye = this->m_renderPose.eye;
+        snapshot.playerLookCenter = this->m_renderPose.lookCenter;
+        snapshot.slimePosition = this->m_renderPose.slime;
+        // the trackball follows the mouse directly
+        snapshot.godEye = this->godCameraEye();
+        snapshot.godLookCenter = this->m_godCameraTarget;
+        snapshot.settings = this->m_settings;
+        return snapshot;
+}
 
-        this->updateGodCameraTrackball();
+void RenderingOrderExp::applySnapshot(const FrameSnapshot& snapshot) {
+        // the interpolated eye is not at the camera distance of the steps, the distance follows the pose
+        this->m_playerCamera->setViewOrg(snapshot.playerEye);
+        this->m_playerCamera->setLookCenter(snapshot.playerLookCenter);
+        this->m_playerCamera->setDistance(glm::length(snapshot.playerEye - snapshot.playerLookCenter));
+        this->m_playerCamera->update();
+        this->m_godCamera->setViewOrg(snapshot.godEye);
+        this->m_godCamera->setLookCenter(snapshot.godLookCenter);
+        this->m_godCamera->setDistance(glm::length(snapshot.godEye - snapshot.godLookCenter));
+        this->m_godCamera->update();
+        this->m_slimeRenderPosition = snapshot.slimePosition;
+
+        // only changes are applied, a fallback of the renderer (foliage pass) sticks until the setting changes again
+        const RenderSettings& settings = snapshot.settings;
+        const RenderSettings& applied = this->m_appliedSettings;
+        const bool force = this->m_settingsApplied == false;
+        if (force || settings.occlusionCulling != applied.occlusionCulling) {
+                this->m_occlusionCulling = settings.occlusionCulling;
+        }
+        if (force || settings.prefixSumCompaction != applied.prefixSumCompaction) {
+                this->m_prefixSumCompaction = settings.prefixSumCompaction;
+        }
+        if (force || settings.indirectCountDraws != applied.indirectCountDraws) {
+                this->m_indirectCountDraws = settings.indirectCountDraws;
+        }
+        if (force || settings.impostors != applied.impostors) {
+                this->m_impostors = settings.impostors;
+        }
+        if (force || settings.foliagePass != applied.foliagePass) {
+                this->m_foliagePass = settings.foliagePass;
+        }
+        if (force || settings.debugView != applied.debugView) {
+                this->m_debugView = settings.debugView;
+        }
+        this->m_appliedSettings = settings;
+        this->m_settingsApplied = true;
 
         this->m_viewFrustum->update(this->m_playerCamera);
         this->m_horizontalGround->update(this->m_playerCamera);
-
-        this->m_slimeTrajectory.update();
 }
 
 void RenderingOrderExp::render() {
+        this->m_profiler.beginFrame();
+        this->m_frameRing.beginFrame();
+        // window back buffer or the benchmark's offscreen target
+        GLint outputFramebuffer = 0;
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &outputFramebuffer);
+
+        // finished loading jobs are uploaded a few per frame
+        if (this->m_loadingState != nullptr) {
+                this->m_assetLoader.pumpUploads(UPLOAD_BUDGET_MS);
+        }
+
         this->m_renderer->clearRenderTarget();
         const int leftWidth = std::max(1, this->m_frameWidth / 2);
         const int rightWidth = std::max(1, this->m_frameWidth - leftWidth);
 
-        const glm::vec3 slimePos = this->m_slimeTrajectory.position();
-        this->dispatchCullingCompute(this->m_playerCamera, slimePos);
+        const bool occlusion = this->m_occlusionCulling && this->m_playerViewTarget != nullptr && this->m_hiZPyramid != nullptr;
+        if (occlusion == false) {
+                this->m_hiZValid = false;
+        }
+        // the debug views count single sampled alpha tested fragments
+        const bool debugView = this->m_debugView != OPENGL::DebugViewType::NONE && this->m_overdrawCounter != nullptr;
+        this->m_debugViewActive = debugView;
+        const bool alphaToCoverage = debugView == false && this->updateMultisampleTarget();
+        this->m_alphaToCoverageActive = alphaToCoverage;
+        if (this->m_overdrawCounter != nullptr) {
+                this->m_overdrawCounter->beginFrame();
+                if (debugView) {
+                        this->m_overdrawCounter->clear();
+                }
+        }
+
+        // tiles around the player are paged in (and far ones evicted) before this frame's culling
+        this->m_tileStreamer.update(this->m_playerCamera->viewOrig(), STREAMING_RADIUS);
+        this->updateLoading();
+        // uploads and streaming above bind through GL directly, the tracked part of the frame starts here
+        OPENGL::GLStateCache::beginFrame();
+
+        const glm::vec3 slimePos = this->m_slimeRenderPosition;
+        {
+                // both cameras get their own visibility set from one dispatch
+                const Camera* cullViews[NUM_CULL_VIEWS] = {};
+                cullViews[CULL_VIEW_PLAYER] = this->m_playerCamera;
+                cullViews[CULL_VIEW_GOD] = this->m_godCamera;
+                OPENGL::ProfileScope scope(&this->m_profiler, "cull");
+                this->dispatchCullingCompute(cullViews, NUM_CULL_VIEWS, slimePos);
+        }
+
+        if (occlusion == false && alphaToCoverage == false) {
+                this->renderViewport(this->m_godCamera, "god", slimePos, CULL_VIEW_GOD, 0, 0, leftWidth, this->m_frameHeight);
+                glClear(GL_DEPTH_BUFFER_BIT);
+                this->renderViewport(this->m_playerCamera, "player", slimePos, CULL_VIEW_PLAYER, leftWidth, 0, rightWidth, this->m_frameHeight);
+                this->finishDebugView(leftWidth, rightWidth);
+                this->m_frameRing.endFrame();
+                this->m_profiler.endFrame();
+                return;
+        }
+
+        // phase 0: instances visible against last frame's pyramid, drawn into the player's own depth buffer;
+        // a multisample player view is resolved into m_playerViewTarget for the pyramid and the output
+        const OPENGL::OffscreenTarget* playerTarget = alphaToCoverage ? this->m_multisampleTarget : this->m_playerViewTarget;
+        playerTarget->bind();
+        this->m_renderer->clearRenderTarget();
+        this->renderViewport(this->m_playerCamera, "player", slimePos, CULL_VIEW_PLAYER, 0, 0, rightWidth, this->m_frameHeight);
+        if (occlusion) {
+                OPENGL::ProfileScope occlusionScope(&this->m_profiler, "occlusion");
+                if (alphaToCoverage) {
+                        OPENGL::ProfileScope scope(&this->m_profiler, "resolve");
+                        resolveTarget(*this->m_multisampleTarget, *this->m_playerViewTarget);
+                        playerTarget->bind();
+                }
+                {
+                        // this frame's pyramid re-tests the rejected instances and is reused by the next frame's phase 0
+                        OPENGL::ProfileScope scope(&this->m_profiler, "hiz");
+                        this->m_hiZPyramid->build(this->m_playerViewTarget->depthTexture());
+                        this->m_hiZViewProj = this->m_playerCamera->projMatrix() * this->m_playerCamera->viewMatrix();
+                        this->m_hiZValid = true;
+                }
+                {
+                        // phase 1: disoccluded instances
+                        OPENGL::ProfileScope scope(&this->m_profiler, "cull");
+                        this->dispatchLateCullingCompute(this->m_playerCamera);
+                }
+                {
+                        OPENGL::ProfileScope scope(&this->m_profiler, "foliage");
+                        this->m_renderer->setViewport(0, 0, rightWidth, this->m_frameHeight);
+                        this->bindViewConstants(this->m_playerCamera);
+                        this->renderFoliage(LATE_DRAW_LIST);
+                }
+                {
+                        OPENGL::ProfileScope scope(&this->m_profiler, "impostors");
+                        this->renderImpostors(LATE_DRAW_LIST);
+                }
+        }
+        if (alphaToCoverage) {
+                OPENGL::ProfileScope scope(&this->m_profiler, "resolve");
+                resolveTarget(*this->m_multisampleTarget, *this->m_playerViewTarget);
+        }
 
-        this->renderViewport(this->m_godCamera, slimePos, 0, 0, leftWidth, this->m_frameHeight);
-        glClear(GL_DEPTH_BUFFER_BIT);
-        this->renderViewport(this->m_playerCamera, slimePos, leftWidth, 0, rightWidth, this->m_frameHeight);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, this->m_playerViewTarget->framebufferId());
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(outputFramebuffer));
+        glBlitFramebuffer(0, 0, rightWidth, this->m_frameHeight, leftWidth, 0, leftWidth + rightWidth, this->m_frameHeight, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(outputFramebuffer));
+
+        this->renderViewport(this->m_godCamera, "god", slimePos, CULL_VIEW_GOD, 0, 0, leftWidth, this->m_frameHeight);
+        this->finishDebugView(leftWidth, rightWidth);
+        this->m_frameRing.endFrame();
+        this->m_profiler.endFrame();
 }
 
-void RenderingOrderExp::dispatchCullingCompute(const Camera* playerCam, const glm::vec3& slimePos) {
-        if (this->m_computeShader == nullptr || this->m_totalInstanceCount == 0u) {
+void RenderingOrderExp::finishDebugView(const int leftWidth, const int rightWidth) {
+        if (this->m_overdrawCounter == nullptr) {
                 return;
         }
-        for (auto& cmd : this->m_drawCommands) {
-                cmd.instanceCount = 0u;
+        if (this->m_debugViewActive) {
+                OPENGL::ProfileScope scope(&this->m_profiler, "debug");
+                this->m_overdrawCounter->reduce(CULL_VIEW_GOD, "god", leftWidth, this->m_frameHeight);
+                this->m_overdrawCounter->reduce(CULL_VIEW_PLAYER, "player", rightWidth, this->m_frameHeight);
+                if (this->m_debugView == OPENGL::DebugViewType::OVERDRAW || this->m_debugView == OPENGL::DebugViewType::QUAD_OCCUPANCY) {
+                        // the player view is on the output by now, off screen or not
+                        this->m_renderer->setViewport(0, 0, leftWidth, this->m_frameHeight);
+                        this->m_overdrawCounter->draw(CULL_VIEW_GOD, this->m_debugView, 0, 0);
+                        this->m_renderer->setViewport(leftWidth, 0, rightWidth, this->m_frameHeight);
+                        this->m_overdrawCounter->draw(CULL_VIEW_PLAYER, this->m_debugView, leftWidth, 0);
+                }
+        }
+        this->m_overdrawCounter->endFrame();
+}
+
+void RenderingOrderExp::dispatchCullingCompute(const Camera* const* views, const int numViews, const glm::vec3& slimePos) {
+        this->m_drawListsValid = false;
+        this->m_impostorsActive = false;
+        if (this->m_computeShader == nullptr || this->m_cellCullShader == nullptr || this->m_totalInstanceCount == 0u) {
+                return;
+        }
+        if (numViews < 1 || numViews > NUM_CULL_VIEWS) {
+                std::cerr << "Unsupported number of cull views: " << numViews << std::endl;
+                return;
+        }
+        // draw command counts and the late dispatch are reset by the cell pass, only its own counter is cleared here
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_cellDispatchBuffer);
+        glClearBufferSubData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, 0, sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+
+        const uint32_t numCommands = static_cast<uint32_t>(numViews) * this->m_commandsPerView;
+        const bool prefixSum = this->m_prefixSumCompaction && this->m_compactShader != nullptr && numCommands <= MAX_DRAW_COMMANDS;
+        if (prefixSum) {
+                // cells that are not listed this frame must not contribute to the scan
+                glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_cellCommandCountSSBO);
+                glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
         }
-        glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->m_drawCommandSSBO);
-        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, this->m_drawCommands.size() * sizeof(DrawCommand), this->m_drawCommands.data());
         glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 
-        glUseProgram(this->m_computeShader->programId());
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, RAW_INSTANCE_BINDING, this->m_rawInstanceSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COMMAND_BINDING, this->m_drawCommandSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_STATE_BINDING, this->m_instanceStateSSBO);
-        glUniformMatrix4fv(this->m_computeViewLoc, 1, GL_FALSE, glm::value_ptr(playerCam->viewMatrix()));
-        glUniformMatrix4fv(this->m_computeProjLoc, 1, GL_FALSE, glm::value_ptr(playerCam->projMatrix()));
-        glUniform1ui(this->m_computeTotalInstanceLoc, static_cast<GLuint>(this->m_totalInstanceCount));
-        glUniform1i(this->m_computeNumMeshesLoc, static_cast<int>(this->m_meshInfos.size()));
-        glUniform1f(this->m_computeEraseRadiusLoc, this->m_eraseRadius);
-        glUniform3fv(this->m_computeSlimePosLoc, 1, glm::value_ptr(slimePos));
-
-        const GLuint groupSize = 256u;
-        const GLuint numGroups = static_cast<GLuint>((this->m_totalInstanceCount + groupSize - 1) / groupSize);
-        glDispatchCompute(numGroups, 1, 1);
+        // one constant block for every pass of this frame's culling
+        CullConstantsGPU constants{};
+        for (int view = 0; view < numViews; ++view) {
+                views[view]->viewFrustumPlanesInWorldSpace(constants.frustumPlanes + 6 * view);
+                constants.viewPositions[view] = glm::vec4(views[view]->viewOrig(), 1.0f);
+        }
+        constants.slimePosition = slimePos;
+        constants.eraseRadius = this->m_eraseRadius;
+        constants.numViews = numViews;
+        constants.numMeshes = static_cast<GLint>(this->m_meshInfos.size());
+        constants.commandsPerView = static_cast<GLint>(this->m_commandsPerView);
+        constants.instancePoolSize = this->m_instancePoolSize;
+        constants.numCells = this->m_numInstanceCells;
+        constants.cellsPerTileSlot = CELLS_PER_TILE;
+        // until the atlas is baked the far instances stay meshes
+        const bool impostors = this->m_impostors && this->m_impostorsBaked && this->m_impostorShader != nullptr && this->m_impostorCommand >= 0;
+        constants.impostorCommand = impostors ? this->m_impostorCommand : -1;
+        if (this->m_frameRing.bindUniformBlock(CULL_CONSTANTS_BINDING, &constants, sizeof(CullConstantsGPU)) == false) {
+                return;
+        }
+
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COMMAND_BINDING, this->m_drawCommandSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, LATE_DISPATCH_BINDING, this->m_lateDispatchBuffer);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, LATE_DRAW_COMMAND_BINDING, this->m_lateDrawCommandSSBO);
+
+        // coarse pass: list the cells the instance pass has to look at (and reset the command counts)
+        OPENGL::GLStateCache::useProgram(this->m_cellCullShader->programId());
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_CELL_BINDING, this->m_instanceCellSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_CELL_BINDING, this->m_visibleCellSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, CELL_DISPATCH_BINDING, this->m_cellDispatchBuffer);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, TILE_SLOT_BINDING, this->m_tileSlotSSBO);
+        const GLuint cellThreads = std::max(this->m_numInstanceCells, numCommands);
+        glDispatchCompute((cellThreads + CELL_CULL_GROUP_SIZE - 1) / CELL_CULL_GROUP_SIZE, 1, 1);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        // fine pass: instances of the listed cells, one work group per cell
+        OPENGL::GLStateCache::useProgram(this->m_computeShader->programId());
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, RAW_INSTANCE_BINDING, this->m_rawInstanceSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_STATE_BINDING, this->m_instanceStateSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, OCCLUSION_CANDIDATE_BINDING, this->m_occlusionCandidateSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_BOUNDS_BINDING, this->m_meshBoundsSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_LOD_BINDING, this->m_meshLodSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, CELL_COMMAND_COUNT_BINDING, this->m_cellCommandCountSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, INSTANCE_SLOT_BINDING, this->m_instanceSlotSSBO);
+        glUniform1i(this->m_computePrefixSumCompactionLoc, prefixSum ? 1 : 0);
+
+        // phase 0 tests the player view against the previous frame's pyramid with the matrix it was built with
+        const bool occlusion = this->m_occlusionCulling && this->m_hiZValid && views[CULL_VIEW_PLAYER] == this->m_playerCamera;
+        glUniform1i(this->m_computeCullPhaseLoc, 0);
+        glUniform1i(this->m_computeOcclusionEnabledLoc, occlusion ? 1 : 0);
+        if (occlusion) {
+                glUniformMatrix4fv(this->m_computeOcclusionViewProjLoc, 1, GL_FALSE, glm::value_ptr(this->m_hiZViewProj));
+                glUniform2f(this->m_computeHiZSizeLoc, static_cast<float>(this->m_hiZPyramid->width()), static_cast<float>(this->m_hiZPyramid->height()));
+                glUniform1i(this->m_computeHiZLevelsLoc, this->m_hiZPyramid->numLevels());
+                OPENGL::GLStateCache::bindTexture(0, GL_TEXTURE_2D, this->m_hiZPyramid->texture());
+        }
+
+        OPENGL::GLStateCache::bindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->m_cellDispatchBuffer);
+        glDispatchComputeIndirect(0);
+        glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        if (prefixSum) {
+                // cell counts -> offsets within the scan groups, group totals -> group offsets + instanceCount,
+                // then scatter in instance order
+                OPENGL::GLStateCache::useProgram(this->m_compactShader->programId());
+                OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, SCAN_GROUP_TOTAL_BINDING, this->m_scanGroupTotalSSBO);
+                glUniform1i(this->m_compactPassLoc, 0);
+                glDispatchCompute(this->m_numCompactScanGroups, numCommands, 1);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                glUniform1i(this->m_compactPassLoc, 1);
+                glDispatchCompute(1, numCommands, 1);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+                glUniform1i(this->m_compactPassLoc, 2);
+                glDispatchComputeIndirect(0);
+                glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+        }
+
+        if (this->m_indirectCountDraws && this->m_drawListShader != nullptr) {
+                this->dispatchDrawListCompaction(-1, static_cast<GLuint>(numViews));
+                this->m_drawListsValid = true;
+        }
+        this->m_impostorsActive = impostors;
+}
+
+void RenderingOrderExp::dispatchLateCullingCompute(const Camera* playerCam) {
+        if (this->m_computeShader == nullptr || this->m_totalInstanceCount == 0u) {
+                return;
+        }
+        // bindings are still those of phase 0
+        OPENGL::GLStateCache::useProgram(this->m_computeShader->programId());
+        glUniform1i(this->m_computeCullPhaseLoc, 1);
+        const glm::mat4 viewProj = playerCam->projMatrix() * playerCam->viewMatrix();
+        glUniformMatrix4fv(this->m_computeOcclusionViewProjLoc, 1, GL_FALSE, glm::value_ptr(viewProj));
+        glUniform2f(this->m_computeHiZSizeLoc, static_cast<float>(this->m_hiZPyramid->width()), static_cast<float>(this->m_hiZPyramid->height()));
+        glUniform1i(this->m_computeHiZLevelsLoc, this->m_hiZPyramid->numLevels());
+        OPENGL::GLStateCache::bindTexture(0, GL_TEXTURE_2D, this->m_hiZPyramid->texture());
+
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COMMAND_BINDING, this->m_drawCommandSSBO);
+        OPENGL::GLStateCache::bindBuffer(GL_DISPATCH_INDIRECT_BUFFER, this->m_lateDispatchBuffer);
+        glDispatchComputeIndirect(0);
         glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
+
+        if (this->m_drawListsValid) {
+                this->dispatchDrawListCompaction(LATE_DRAW_LIST, 1u);
+        }
 }
 
-void RenderingOrderExp::renderViewport(const Camera* camera, const glm::vec3& slimePos, const int viewportX, const int viewportY, const int viewportWidth, const int viewportHeight) {
+void RenderingOrderExp::dispatchDrawListCompaction(const int lateDrawList, const GLuint numLists) {
+        // the (late) draw commands are still bound by the culling passes
+        OPENGL::GLStateCache::useProgram(this->m_drawListShader->programId());
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_LIST_BINDING, this->m_drawListBuffer);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COUNT_BINDING, this->m_drawCountBuffer);
+        glUniform1i(this->m_drawListLateLoc, lateDrawList);
+        glDispatchCompute(numLists, 1, 1);
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+}
+
+void RenderingOrderExp::renderViewport(const Camera* camera, const char* passName, const glm::vec3& slimePos, const int cullView, const int viewportX, const int viewportY, const int viewportWidth, const int viewportHeight) {
+        OPENGL::ProfileScope viewportScope(&this->m_profiler, passName);
+
         // Make sure the renderer's shader program is bound before updating any of its uniforms.
         // Otherwise, uniforms would be uploaded to whichever shader program happened to be bound last
         // (e.g., the compute shader or the foliage/slime programs), which results in the grid ground and
         // frustum not being rendered. Binding here guarantees the renderer state is valid for the draw.
+        // The camera of every pass below, the ground and frustum included, comes from the view constants.
         this->m_renderer->bindProgram();
-        this->m_renderer->setCamera(camera->projMatrix(), camera->viewMatrix(), camera->viewOrig());
         this->m_renderer->setViewport(viewportX, viewportY, viewportWidth, viewportHeight);
-        this->m_renderer->setShadingModel(OPENGL::ShadingModelType::PROCEDURAL_GRID);
-        this->m_horizontalGround->render();
+        this->m_debugViewportOrigin = glm::ivec2(viewportX, viewportY);
+        this->bindViewConstants(camera);
+        {
+                OPENGL::ProfileScope scope(&this->m_profiler, "ground");
+                this->m_renderer->setShadingModel(OPENGL::ShadingModelType::PROCEDURAL_GRID);
+                this->m_horizontalGround->render();
+        }
 
         if (camera == this->m_godCamera) {
+                OPENGL::ProfileScope scope(&this->m_profiler, "frustum");
                 this->m_renderer->setShadingModel(OPENGL::ShadingModelType::UNLIT);
                 this->m_viewFrustum->render();
         }
 
-        this->renderSlime(camera, slimePos);
-        this->renderFoliage(camera);
+        {
+                OPENGL::ProfileScope scope(&this->m_profiler, "slime");
+                this->renderSlime(slimePos);
+        }
+        {
+                OPENGL::ProfileScope scope(&this->m_profiler, "foliage");
+                this->renderFoliage(cullView);
+        }
+        {
+                OPENGL::ProfileScope scope(&this->m_profiler, "impostors");
+                this->renderImpostors(cullView);
+        }
+}
+
+void RenderingOrderExp::bindViewConstants(const Camera* camera) {
+        ViewConstantsGPU constants{};
+        constants.viewMat = camera->viewMatrix();
+        constants.projMat = camera->projMatrix();
+        constants.cameraPos = glm::vec4(camera->viewOrig(), 1.0f);
+        this->m_frameRing.bindUniformBlock(VIEW_CONSTANTS_BINDING, &constants, sizeof(ViewConstantsGPU));
 }
 
-void RenderingOrderExp::renderFoliage(const Camera* camera) {
+void RenderingOrderExp::renderFoliage(const int drawList) {
         if (this->m_foliageShader == nullptr || this->m_totalInstanceCount == 0u) {
                 return;
         }
-        glUseProgram(this->m_foliageShader->programId());
-        glUniformMatrix4fv(this->m_foliageViewLoc, 1, GL_FALSE, glm::value_ptr(camera->viewMatrix()));
-        glUniformMatrix4fv(this->m_foliageProjLoc, 1, GL_FALSE, glm::value_ptr(camera->projMatrix()));
-        glUniform3fv(this->m_foliageCameraPosLoc, 1, glm::value_ptr(camera->viewOrig()));
+        FoliagePass pass = this->m_foliagePass;
+        if (this->m_foliageShadeShader == nullptr || (pass == FoliagePass::ALPHA_TO_COVERAGE && (this->m_alphaToCoverageActive == false || drawList == CULL_VIEW_GOD))) {
+                pass = FoliagePass::ALPHA_TEST;
+        }
+        const GLint crossfade = this->m_impostorsActive ? 1 : 0;
+
+        if (this->m_debugViewActive) {
+                // the late list adds to the player's counts
+                OPENGL::GLStateCache::useProgram(this->m_foliageDebugShader->programId());
+                glUniform1i(this->m_foliageDebugImpostorCrossfadeLoc, crossfade);
+                glUniform1i(this->m_foliageDebugViewLoc, static_cast<int>(this->m_debugView));
+                glUniform1i(this->m_foliageDebugCountViewLoc, drawList == LATE_DRAW_LIST ? CULL_VIEW_PLAYER : drawList);
+                glUniform2i(this->m_foliageDebugViewportOriginLoc, this->m_debugViewportOrigin.x, this->m_debugViewportOrigin.y);
+                this->m_overdrawCounter->bindImage();
+                this->drawFoliageCommands(drawList);
+                return;
+        }
+        if (pass == FoliagePass::DEPTH_PREPASS) {
+                {
+                        OPENGL::ProfileScope scope(&this->m_profiler, "depth");
+                        OPENGL::GLStateCache::useProgram(this->m_foliageDepthShader->programId());
+                        glUniform1i(this->m_foliageDepthImpostorCrossfadeLoc, crossfade);
+                        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                        this->drawFoliageCommands(drawList);
+                        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                }
+                {
+                        // every visible texel is shaded once, the depth test rejects the rest before the shader
+                        OPENGL::ProfileScope scope(&this->m_profiler, "shade");
+                        OPENGL::GLStateCache::useProgram(this->m_foliageShadeShader->programId());
+                        glUniform1i(this->m_foliageShadeImpostorCrossfadeLoc, crossfade);
+                        glUniform1i(this->m_foliageShadeAlphaToCoverageLoc, 0);
+                        glDepthFunc(GL_EQUAL);
+                        glDepthMask(GL_FALSE);
+                        this->drawFoliageCommands(drawList);
+                        glDepthMask(GL_TRUE);
+                        glDepthFunc(GL_LESS);
+                }
+                return;
+        }
+        if (pass == FoliagePass::ALPHA_TO_COVERAGE) {
+                OPENGL::GLStateCache::useProgram(this->m_foliageShadeShader->programId());
+                glUniform1i(this->m_foliageShadeImpostorCrossfadeLoc, crossfade);
+                glUniform1i(this->m_foliageShadeAlphaToCoverageLoc, 1);
+                glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+                this->drawFoliageCommands(drawList);
+                glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
+                return;
+        }
+        OPENGL::GLStateCache::useProgram(this->m_foliageShader->programId());
+        glUniform1i(this->m_foliageImpostorCrossfadeLoc, crossfade);
+        this->drawFoliageCommands(drawList);
+}
 
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
-        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_COMMAND_BINDING, this->m_drawCommandSSBO);
+void RenderingOrderExp::drawFoliageCommands(const int drawList) {
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_LOD_BINDING, this->m_meshLodSSBO);
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D_ARRAY, this->m_foliageTextureArray);
+        OPENGL::GLStateCache::bindTexture(0, GL_TEXTURE_2D_ARRAY, this->m_foliageTextureArray);
 
-        glBindVertexArray(this->m_foliageVao);
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, this->m_drawCommandSSBO);
-        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, static_cast<GLsizei>(this->m_meshInfos.size()), 0);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
-        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        OPENGL::GLStateCache::bindVertexArray(this->m_foliageVao);
+        if (this->m_drawListsValid) {
+                // only the commands with instances, the count never leaves the GPU
+                OPENGL::GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, this->m_drawListBuffer);
+                OPENGL::GLStateCache::bindBuffer(GL_PARAMETER_BUFFER, this->m_drawCountBuffer);
+                const size_t listOffset = static_cast<size_t>(drawList) * this->m_commandsPerView * sizeof(DrawCommand);
+                glMultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(listOffset), static_cast<GLintptr>(drawList * sizeof(GLuint)), static_cast<GLsizei>(this->m_commandsPerView), 0);
+                return;
+        }
+
+        // every mesh command of the view, including those without instances
+        const bool late = drawList == LATE_DRAW_LIST;
+        const int cullView = late ? CULL_VIEW_PLAYER : drawList;
+        const int meshCommands = this->m_impostorCommand >= 0 ? this->m_impostorCommand : static_cast<int>(this->m_commandsPerView);
+        OPENGL::GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, late ? this->m_lateDrawCommandSSBO : this->m_drawCommandSSBO);
+        const size_t commandOffset = static_cast<size_t>(cullView) * this->m_commandsPerView * sizeof(DrawCommand);
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(commandOffset), static_cast<GLsizei>(meshCommands), 0);
+}
+
+void RenderingOrderExp::renderImpostors(const int drawList) {
+        if (this->m_impostorsActive == false) {
+                return;
+        }
+        OPENGL::GLStateCache::useProgram(this->m_impostorShader->programId());
+
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, VISIBLE_INSTANCE_BINDING, this->m_visibleInstanceSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_BOUNDS_BINDING, this->m_meshBoundsSSBO);
+        OPENGL::GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, MESH_LOD_BINDING, this->m_meshLodSSBO);
+
+        OPENGL::GLStateCache::bindTexture(IMPOSTOR_ALBEDO_UNIT, GL_TEXTURE_2D_ARRAY, this->m_impostorAtlas->albedoTexture());
+        OPENGL::GLStateCache::bindTexture(IMPOSTOR_NORMAL_DEPTH_UNIT, GL_TEXTURE_2D_ARRAY, this->m_impostorAtlas->normalDepthTexture());
+
+        // the impostor command is left out of the compacted lists, its instance count is read straight from the culled commands
+        const bool late = drawList == LATE_DRAW_LIST;
+        const int cullView = late ? CULL_VIEW_PLAYER : drawList;
+        OPENGL::GLStateCache::bindVertexArray(this->m_impostorVao);
+        OPENGL::GLStateCache::bindBuffer(GL_DRAW_INDIRECT_BUFFER, late ? this->m_lateDrawCommandSSBO : this->m_drawCommandSSBO);
+        const size_t commandOffset = (static_cast<size_t>(cullView) * this->m_commandsPerView + static_cast<size_t>(this->m_impostorCommand)) * sizeof(DrawCommand);
+        glDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(commandOffset));
 }
 
-void RenderingOrderExp::renderSlime(const Camera* camera, const glm::vec3& slimePos) {
+void RenderingOrderExp::renderSlime(const glm::vec3& slimePos) {
         if (this->m_slimeShader == nullptr || this->m_slimeIndexCount == 0) {
                 return;
         }
-        glUseProgram(this->m_slimeShader->programId());
+        OPENGL::GLStateCache::useProgram(this->m_slimeShader->programId());
         glm::mat4 model = glm::translate(glm::mat4(1.0f), slimePos);
         glUniformMatrix4fv(this->m_slimeModelLoc, 1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(this->m_slimeViewLoc, 1, GL_FALSE, glm::value_ptr(camera->viewMatrix()));
-        glUniformMatrix4fv(this->m_slimeProjLoc, 1, GL_FALSE, glm::value_ptr(camera->projMatrix()));
-        glUniform3fv(this->m_slimeCameraPosLoc, 1, glm::value_ptr(camera->viewOrig()));
 
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, this->m_slimeTexture);
-        glBindVertexArray(this->m_slimeVao);
+        OPENGL::GLStateCache::bindTexture(0, GL_TEXTURE_2D, this->m_slimeTexture);
+        OPENGL::GLStateCache::bindVertexArray(this->m_slimeVao);
         glDrawElements(GL_TRIANGLES, this->m_slimeIndexCount, GL_UNSIGNED_INT, nullptr);
-        glBindVertexArray(0);
-        glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void RenderingOrderExp::updatePlayerCameraMovement() {
@@ -712,25 +2330,43 @@ void RenderingOrderExp::updatePlayerCameraMovement() {
 
         const float rotateSpeed = 0.01f;
         if (this->m_rotateLeft) {
-                this->m_playerCamera->rotateLookCenterAccordingToViewOrg(rotateSpeed);
+                this->m_simulationCamera->rotateLookCenterAccordingToViewOrg(rotateSpeed);
         }
         if (this->m_rotateRight) {
-                this->m_playerCamera->rotateLookCenterAccordingToViewOrg(-rotateSpeed);
+                this->m_simulationCamera->rotateLookCenterAccordingToViewOrg(-rotateSpeed);
         }
 }
 
-void RenderingOrderExp::updateGodCameraTrackball() {
-        const float radius = this->m_godCamera->distance();
+glm::vec3 RenderingOrderExp::godCameraEye() const {
         const float cosPitch = std::cos(this->m_trackballPitch);
         glm::vec3 dir(
                 std::sin(this->m_trackballYaw) * cosPitch,
                 std::sin(this->m_trackballPitch),
                 std::cos(this->m_trackballYaw) * cosPitch
         );
-        const glm::vec3 eye = this->m_godCameraTarget - dir * radius;
-        this->m_godCamera->setLookCenter(this->m_godCameraTarget);
-        this->m_godCamera->setViewOrg(eye);
-        this->m_godCamera->update();
+        return this->m_godCameraTarget - dir * this->m_godCameraDistance;
+}
+
+void RenderingOrderExp::setPlayerPose(const glm::vec3& eye, const glm::vec3& lookCenter) {
+        this->m_simulationCamera->setViewOrg(eye);
+        this->m_simulationCamera->setLookCenter(lookCenter);
+        this->m_simulationCamera->setDistance(glm::length(eye - lookCenter));
+        this->m_simulationCamera->update();
+        // scripted poses are not interpolated
+        this->m_currentPose.eye = this->m_simulationCamera->viewOrig();
+        this->m_currentPose.lookCenter = this->m_simulationCamera->lookCenter();
+        this->m_previousPose.eye = this->m_currentPose.eye;
+        this->m_previousPose.lookCenter = this->m_currentPose.lookCenter;
+        this->m_renderPose.eye = this->m_currentPose.eye;
+        this->m_renderPose.lookCenter = this->m_currentPose.lookCenter;
+}
+
+void RenderingOrderExp::setSlimePosition(const glm::vec3& position) {
+        this->m_slimeTrajectory.enable(false);
+        this->m_slimeTrajectory.setStartPosition(position);
+        this->m_currentPose.slime = position;
+        this->m_previousPose.slime = position;
+        this->m_renderPose.slime = position;
 }
 
 void RenderingOrderExp::handleKey(const int key, const int action) {
@@ -776,12 +2412,10 @@ void RenderingOrderExp::handleCursor(const double cursorX, const double cursorY)
         this->m_trackballYaw -= delta.x * sensitivity;
         this->m_trackballPitch -= delta.y * sensitivity;
         this->m_trackballPitch = glm::clamp(this->m_trackballPitch, -1.3f, 1.3f);
-        this->updateGodCameraTrackball();
 }
 
 void RenderingOrderExp::handleScroll(const double yoffset) {
-        this->m_godCamera->distanceOffset(static_cast<float>(-yoffset));
-        this->updateGodCameraTrackball();
+        this->m_godCameraDistance = std::max(this->m_godCameraDistance - static_cast<float>(yoffset), MIN_GOD_CAMERA_DISTANCE);
 }
 
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <vector>
 #include <array>
 
@@ -16,10 +17,23 @@
 #include <glm/mat4x4.hpp>
 
 #include "../Rendering/Camera/Camera.h"
+#include "../Rendering/FrameRingBuffer.h"
+#include "../Rendering/GpuProfiler.h"
+#include "../Rendering/HiZPyramid.h"
+#include "../Rendering/ImpostorAtlas.h"
+#include "../Rendering/OffscreenTarget.h"
+#include "../Rendering/OverdrawCounter.h"
 #include "../Rendering/RendererBase.h"
+#include "../Scene/AssetLoader.h"
+#include "../Scene/FoliageCatalog.h"
+#include "../Scene/InstanceField.h"
 #include "../Scene/RViewFrustum.h"
 #include "../Scene/RHorizonGround.h"
+#include "../Scene/SimulationClock.h"
+#include "../Scene/TileStreamer.h"
 #include "../Scene/Trajectory.h"
+#include "FoliagePass.h"
+#include "FrameSnapshot.h"
 
 namespace INANOA {
         class RenderingOrderExp
@@ -31,28 +45,131 @@ namespace INANOA {
         public:
                 bool init(const int w, const int h);
                 void resize(const int w, const int h);
-                void update();
+                // one frame on one thread: simulate() and applySnapshot(snapshot())
+                void update(const double elapsedSeconds);
                 void render();
 
+                // The simulation (input, slime, cameras, settings) and the GL side only meet in FrameSnapshot:
+                // simulate(), snapshot(), the handle* methods and the setters never touch GL or the render
+                // state, applySnapshot(), resize() and render() never touch the simulation, so the two
+                // halves can run on different threads.
+                // advances the slime and the player camera by the whole simulation steps in elapsedSeconds
+                // and interpolates their render pose between the last two steps
+                void simulate(const double elapsedSeconds);
+                FrameSnapshot snapshot() const;
+                // the poses and settings the following render() calls draw with
+                void applySnapshot(const FrameSnapshot& snapshot);
+
                 void handleKey(const int key, const int action);
                 void handleMouseButton(const int button, const int action, const double cursorX, const double cursorY);
                 void handleCursor(const double cursorX, const double cursorY);
                 void handleScroll(const double yoffset);
 
+                // scripted playback (benchmark), disables the random slime trajectory
+                void setPlayerPose(const glm::vec3& eye, const glm::vec3& lookCenter);
+                void setSlimePosition(const glm::vec3& position);
+
+                inline OPENGL::GpuProfiler* profiler() { return &this->m_profiler; }
+                inline const SCENE::SimulationClock* simulationClock() const { return &this->m_simulationClock; }
+
+                // the settings below are simulation side, they reach the renderer with the next snapshot
+                // two-phase Hi-Z occlusion culling of the player view
+                inline void setOcclusionCulling(const bool flag) { this->m_settings.occlusionCulling = flag; }
+                inline bool occlusionCulling() const { return this->m_settings.occlusionCulling; }
+                // stable prefix sum compaction of the culling survivors instead of atomic appends
+                inline void setPrefixSumCompaction(const bool flag) { this->m_settings.prefixSumCompaction = flag; }
+                inline bool prefixSumCompaction() const { return this->m_settings.prefixSumCompaction; }
+                // foliage is drawn from compacted command lists with a GPU written draw count
+                // (glMultiDrawElementsIndirectCount), every command of the view is issued otherwise
+                inline void setIndirectCountDraws(const bool flag) { this->m_settings.indirectCountDraws = flag; }
+                inline bool indirectCountDraws() const { return this->m_settings.indirectCountDraws; }
+                // false when the context has neither GL 4.6 nor ARB_indirect_parameters
+                inline bool indirectCountSupported() const { return this->m_drawListShader != nullptr; }
+                // instances past their species' impostor distance (foliage catalog) are drawn as octahedral
+                // impostors once the atlas is baked, as meshes otherwise
+                inline void setImpostors(const bool flag) { this->m_settings.impostors = flag; }
+                inline bool impostors() const { return this->m_settings.impostors; }
+                // the renderer falls back to ALPHA_TEST when a pass' shaders or targets are not available
+                inline void setFoliagePass(const FoliagePass pass) { this->m_settings.foliagePass = pass; }
+                inline FoliagePass foliagePass() const { return this->m_settings.foliagePass; }
+                // GL side: the pass render() draws with
+                inline FoliagePass activeFoliagePass() const { return this->m_foliagePass; }
+                // debug shading of the foliage; every debug view replaces the foliage pass with an alpha
+                // tested one that counts its fragments, the impostors are neither recolored nor counted
+                inline void setDebugView(const OPENGL::DebugViewType view) { this->m_settings.debugView = view; }
+                inline OPENGL::DebugViewType debugView() const { return this->m_settings.debugView; }
+                // overdraw / quad occupancy of the frames drawn with a debug view, nullptr when not supported
+                inline OPENGL::OverdrawCounter* overdrawCounter() { return this->m_overdrawCounter; }
+                // before init(): the world is repeat x repeat copies of the sample field
+                inline void setWorldRepeat(const int repeat) { this->m_worldRepeat = repeat; }
+                inline const SCENE::TileStreamer* tileStreamer() const { return &this->m_tileStreamer; }
+
+                // the scene assets are loaded in the background after init(); until then only the
+                // ground, the frustum and whatever is already uploaded are drawn
+                inline bool loading() const { return this->m_loadingState != nullptr; }
+                inline const SCENE::AssetLoader* assetLoader() const { return &this->m_assetLoader; }
+                // blocks until every asset is uploaded and the tiles around the player are resident
+                void finishLoading();
+
         private:
+                struct BakedInstanceField;
+                struct LoadingState;
+
+                // compiles the shaders and submits the loading jobs of the meshes, textures and the
+                // instance field; methods named load* run on the loader's workers, the rest on the GL thread
                 void initializeSceneResources();
+                // one geometry of the foliage catalog; initializeFoliage() builds the species from them
+                void loadFoliageMesh(const size_t geometryIdx);
                 void initializeFoliage();
+                void initializeImpostors(const int numLayers);
+                // renders the impostor atlas once the foliage geometry and every texture layer are uploaded
+                void bakeImpostors();
+                void loadSlime();
                 void initializeSlime();
-                void initializeTextureArray();
+                void loadFoliageTexture(const size_t layer);
+                void uploadFoliageTexture(const size_t layer);
+                // once the meshes are there: maps the SS2 v2 field, or reads the sample sets and bakes it
+                void initializeInstanceField();
                 void initializeInstanceBuffers();
+                // drops the staging memory once every loading job is done
+                void updateLoading();
+                uint32_t instanceFieldContentKey() const;
+                // builds the field from the v1 sample files and writes it as SS2 v2
+                void bakeInstanceField(const uint32_t contentKey, BakedInstanceField& baked);
                 void initializeComputeShader();
+                void initializeOcclusionCulling();
+                void initializeDebugViews();
                 void uploadDrawCommands();
-                void dispatchCullingCompute(const Camera* playerCam, const glm::vec3& slimePos);
-                void renderViewport(const Camera* camera, const glm::vec3& slimePos, const int viewportX, const int viewportY, const int viewportWidth, const int viewportHeight);
-                void renderFoliage(const Camera* camera);
-                void renderSlime(const Camera* camera, const glm::vec3& slimePos);
+                // culls every view with one dispatch, view i fills draw commands [i * m_commandsPerView, (i + 1) * m_commandsPerView)
+                void dispatchCullingCompute(const Camera* const* views, const int numViews, const glm::vec3& slimePos);
+                void dispatchLateCullingCompute(const Camera* playerCam);
+                // drops the commands without instances from numLists command ranges into the draw lists
+                void dispatchDrawListCompaction(const int lateDrawList, const GLuint numLists);
+                void renderViewport(const Camera* camera, const char* passName, const glm::vec3& slimePos, const int cullView, const int viewportX, const int viewportY, const int viewportWidth, const int viewportHeight);
+                // camera constants of the foliage / slime shaders for the following draws
+                void bindViewConstants(const Camera* camera);
+                // drawList: a cull view (phase 0 instances) or LATE_DRAW_LIST (player, phase 1 instances)
+                void renderFoliage(const int drawList);
+                // the culled commands of a view / the late list with the bound foliage program
+                void drawFoliageCommands(const int drawList);
+                // the impostor command of the same view / late list
+                void renderImpostors(const int drawList);
+                // (re)creates the multisample player view target for FoliagePass::ALPHA_TO_COVERAGE, false
+                // when the player view is drawn single sampled this frame
+                bool updateMultisampleTarget();
+                // sums the counts of both viewports and draws the OVERDRAW / QUAD_OCCUPANCY heatmaps over the output
+                void finishDebugView(const int leftWidth, const int rightWidth);
+                void renderSlime(const glm::vec3& slimePos);
+                struct SimulationPose {
+                        glm::vec3 eye;
+                        glm::vec3 lookCenter;
+                        glm::vec3 slime;
+                };
+                // one fixed step of the slime trajectory and the keyboard camera movement
+                void simulationStep();
+                SimulationPose capturePose() const;
                 void updatePlayerCameraMovement();
-                void updateGodCameraTrackball();
+                glm::vec3 godCameraEye() const;
 
                 SCENE::RViewFrustum* m_viewFrustum = nullptr;
                 SCENE::EXPERIMENTAL::HorizonGround* m_horizontalGround = nullptr;
@@ -77,13 +194,18 @@ namespace INANOA {
                 int m_frameHeight;
 
                 OPENGL::RendererBase* m_renderer = nullptr;
+                OPENGL::GpuProfiler m_profiler;
+                // per frame uniform blocks
+                OPENGL::FrameRingBuffer m_frameRing;
 
+                struct MeshLod;
                 struct MeshInfo;
                 struct DrawCommand;
-                struct Vertex;
 
+                SCENE::FoliageCatalog m_foliageCatalog;
                 std::vector<MeshInfo> m_meshInfos;
                 std::vector<DrawCommand> m_drawCommands;
+                uint32_t m_commandsPerView = 0u;
 
                 GLuint m_foliageVao = 0u;
                 GLuint m_foliageVbo = 0u;
@@ -104,35 +226,129 @@ namespace INANOA {
                 GLuint m_visibleInstanceSSBO = 0u;
                 GLuint m_drawCommandSSBO = 0u;
                 GLuint m_instanceStateSSBO = 0u;
+                GLuint m_occlusionCandidateSSBO = 0u;
+                GLuint m_lateDispatchBuffer = 0u;
+                GLuint m_lateDrawCommandSSBO = 0u;
+                GLuint m_meshBoundsSSBO = 0u;
+                GLuint m_meshLodSSBO = 0u;
+                GLuint m_instanceCellSSBO = 0u;
+                GLuint m_visibleCellSSBO = 0u;
+                GLuint m_cellDispatchBuffer = 0u;
+                uint32_t m_numInstanceCells = 0u;
+                GLuint m_cellCommandCountSSBO = 0u;
+                // per scan group and command sums / offsets of the compaction scan
+                GLuint m_scanGroupTotalSSBO = 0u;
+                uint32_t m_numCompactScanGroups = 0u;
+                GLuint m_instanceSlotSSBO = 0u;
+                bool m_prefixSumCompaction = true;
+                // NUM_DRAW_LISTS x m_commandsPerView compacted commands + a draw count per list
+                GLuint m_drawListBuffer = 0u;
+                GLuint m_drawCountBuffer = 0u;
+                bool m_indirectCountDraws = true;
+                // set by the culling passes of the current frame
+                bool m_drawListsValid = false;
+
+                // one atlas layer per species with an impostor distance; their far instances share one
+                // draw command per view, m_impostorCommand within the view (-1: no species has one)
+                OPENGL::ImpostorAtlas* m_impostorAtlas = nullptr;
+                bool m_impostorsBaked = false;
+                int m_impostorCommand = -1;
+                GLuint m_impostorVao = 0u;
+                GLuint m_impostorIbo = 0u;
+                bool m_impostors = true;
+                // set by the culling passes of the current frame
+                bool m_impostorsActive = false;
+
+                // tiled world: the field (mapped file, or baked in memory) is streamed into a fixed
+                // size pool of tile slots, the cell and instance buffers above are that pool
+                SCENE::InstanceField m_instanceField;
+                BakedInstanceField* m_bakedField = nullptr;
+                SCENE::TileStreamer m_tileStreamer;
+                GLuint m_tileSlotSSBO = 0u;
+                uint32_t m_instancePoolSize = 0u;
+                int m_worldRepeat = 1;
+
+                SCENE::AssetLoader m_assetLoader;
+                // staging memory of the loading jobs, nullptr once loading is done
+                LoadingState* m_loadingState = nullptr;
+
+                // the player view is rendered off screen so its depth can feed the Hi-Z pyramid
+                OPENGL::OffscreenTarget* m_playerViewTarget = nullptr;
+                OPENGL::HiZPyramid* m_hiZPyramid = nullptr;
+                glm::mat4 m_hiZViewProj = glm::mat4(1.0f);
+                bool m_hiZValid = false;
+                bool m_occlusionCulling = true;
+                // with alpha to coverage the player view is drawn here and resolved into m_playerViewTarget
+                OPENGL::OffscreenTarget* m_multisampleTarget = nullptr;
+                FoliagePass m_foliagePass = FoliagePass::ALPHA_TEST;
+                // set by render() for the current frame
+                bool m_alphaToCoverageActive = false;
+                OPENGL::OverdrawCounter* m_overdrawCounter = nullptr;
+                OPENGL::DebugViewType m_debugView = OPENGL::DebugViewType::NONE;
+                // set by render() for the current frame
+                bool m_debugViewActive = false;
+                // lower left corner of the viewport being drawn, the counts of every viewport start at 0
+                glm::ivec2 m_debugViewportOrigin = glm::ivec2(0);
 
                 size_t m_totalInstanceCount = 0u;
 
                 OPENGL::ShaderProgram* m_foliageShader = nullptr;
+                OPENGL::ShaderProgram* m_foliageDepthShader = nullptr;
+                OPENGL::ShaderProgram* m_foliageShadeShader = nullptr;
+                OPENGL::ShaderProgram* m_foliageDebugShader = nullptr;
                 OPENGL::ShaderProgram* m_slimeShader = nullptr;
                 OPENGL::ShaderProgram* m_computeShader = nullptr;
-
-                GLint m_foliageModelLoc = -1;
-                GLint m_foliageViewLoc = -1;
-                GLint m_foliageProjLoc = -1;
-                GLint m_foliageCameraPosLoc = -1;
-                GLint m_foliageLightDirLoc = -1;
+                OPENGL::ShaderProgram* m_cellCullShader = nullptr;
+                OPENGL::ShaderProgram* m_compactShader = nullptr;
+                OPENGL::ShaderProgram* m_drawListShader = nullptr;
+                OPENGL::ShaderProgram* m_impostorShader = nullptr;
+
+                GLint m_foliageImpostorCrossfadeLoc = -1;
+                GLint m_foliageDepthImpostorCrossfadeLoc = -1;
+                GLint m_foliageShadeImpostorCrossfadeLoc = -1;
+                GLint m_foliageShadeAlphaToCoverageLoc = -1;
+                GLint m_foliageDebugImpostorCrossfadeLoc = -1;
+                GLint m_foliageDebugViewLoc = -1;
+                GLint m_foliageDebugCountViewLoc = -1;
+                GLint m_foliageDebugViewportOriginLoc = -1;
 
                 GLint m_slimeModelLoc = -1;
-                GLint m_slimeViewLoc = -1;
-                GLint m_slimeProjLoc = -1;
-                GLint m_slimeCameraPosLoc = -1;
                 GLint m_slimeLightDirLoc = -1;
 
-                GLint m_computeViewLoc = -1;
-                GLint m_computeProjLoc = -1;
-                GLint m_computeTotalInstanceLoc = -1;
-                GLint m_computeNumMeshesLoc = -1;
-                GLint m_computeEraseRadiusLoc = -1;
-                GLint m_computeSlimePosLoc = -1;
+                GLint m_computePrefixSumCompactionLoc = -1;
+                GLint m_computeCullPhaseLoc = -1;
+                GLint m_computeOcclusionEnabledLoc = -1;
+                GLint m_computeOcclusionViewProjLoc = -1;
+                GLint m_computeHiZSizeLoc = -1;
+                GLint m_computeHiZLevelsLoc = -1;
+
+                GLint m_compactPassLoc = -1;
+                GLint m_drawListLateLoc = -1;
 
                 float m_eraseRadius = 3.0f;
 
                 SCENE::EXPERIMENTAL::Trajectory m_slimeTrajectory;
+
+                // simulation side: the player camera of the fixed steps, m_playerCamera is the rendered one
+                Camera* m_simulationCamera = nullptr;
+                SCENE::SimulationClock m_simulationClock;
+                SimulationPose m_previousPose;
+                SimulationPose m_currentPose;
+                SimulationPose m_renderPose;
+                float m_godCameraDistance = 70.0f;
+                RenderSettings m_settings;
+                // the instance field is read on the GL side, its bounds reach the slime trajectory through these
+                glm::vec2 m_fieldBoundsMin = glm::vec2(0.0f);
+                glm::vec2 m_fieldBoundsMax = glm::vec2(0.0f);
+                std::atomic<bool> m_fieldBoundsReady = { false };
+                // set by the GL side when alpha to coverage had to fall back to ALPHA_TEST, simulate() writes
+                // the fallback into m_settings
+                std::atomic<bool> m_foliagePassFallback = { false };
+
+                // GL side: the last applied snapshot
+                glm::vec3 m_slimeRenderPosition = glm::vec3(0.0f);
+                RenderSettings m_appliedSettings;
+                bool m_settingsApplied = false;
         };
 
 }
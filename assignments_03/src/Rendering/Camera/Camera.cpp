@@ -1,8 +1,8 @@
 #include "Camera.h"
 #define GLM_ENABLE_EXPERIMENTAL
 
-#include <glm\gtx\transform.hpp>
-#include <glm\gtx\quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+#include <glm/gtx/quaternion.hpp>
 
 namespace INANOA {
 
@@ -130,6 +130,25 @@ namespace INANOA {
 		}
 	}
 
+	void Camera::viewFrustumPlanesInWorldSpace(glm::vec4* planes) const {
+		// Gribb-Hartmann: rows of the view-projection matrix
+		const glm::mat4 vp = this->m_projMat * this->m_viewMat;
+		const glm::vec4 row0(vp[0][0], vp[1][0], vp[2][0], vp[3][0]);
+		const glm::vec4 row1(vp[0][1], vp[1][1], vp[2][1], vp[3][1]);
+		const glm::vec4 row2(vp[0][2], vp[1][2], vp[2][2], vp[3][2]);
+		const glm::vec4 row3(vp[0][3], vp[1][3], vp[2][3], vp[3][3]);
+
+		planes[0] = row3 + row0;
+		planes[1] = row3 - row0;
+		planes[2] = row3 + row1;
+		planes[3] = row3 - row1;
+		planes[4] = row3 + row2;
+		planes[5] = row3 - row2;
+		for (int i = 0; i < 6; i++) {
+			planes[i] = planes[i] / glm::length(glm::vec3(planes[i]));
+		}
+	}
+
 
 }
 
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <glm\mat4x4.hpp>
+#include <glm/mat4x4.hpp>
 
 namespace INANOA {
 
@@ -84,6 +84,8 @@ namespace INANOA {
 	public:
 		// return the view space corners
 		void viewFrustumClipPlaneCornersInViewSpace(const float depth, float* corners) const;
+		// left, right, bottom, top, near, far planes in world space (xyz unit normal pointing inside, w distance)
+		void viewFrustumPlanesInWorldSpace(glm::vec4* planes) const;
 
 	private:
 		glm::vec3 m_viewOrg;
@@ -0,0 +1,40 @@
+#include "FramePacer.h"
+
+#include <thread>
+
+namespace INANOA {
+	namespace OPENGL {
+		namespace {
+			// sleep() overshoots by up to a scheduler tick, the last part is yielded away
+			const std::chrono::microseconds SPIN_MARGIN(1000);
+		}
+
+		FramePacer::FramePacer() {}
+		FramePacer::~FramePacer() {}
+
+		void FramePacer::setTargetFps(const double fps) {
+			this->m_targetFps = fps > 0.0 ? fps : 0.0;
+			this->m_period = this->m_targetFps > 0.0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / this->m_targetFps)) : std::chrono::steady_clock::duration::zero();
+			this->m_started = false;
+		}
+
+		void FramePacer::wait() {
+			if (this->m_targetFps <= 0.0) {
+				return;
+			}
+			const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+			if (this->m_started == false || now > this->m_deadline + this->m_period) {
+				this->m_deadline = now + this->m_period;
+				this->m_started = true;
+				return;
+			}
+			if (this->m_deadline - now > SPIN_MARGIN) {
+				std::this_thread::sleep_until(this->m_deadline - SPIN_MARGIN);
+			}
+			while (std::chrono::steady_clock::now() < this->m_deadline) {
+				std::this_thread::yield();
+			}
+			this->m_deadline = this->m_deadline + this->m_period;
+		}
+	}
+}
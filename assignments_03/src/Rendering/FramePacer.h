@@ -0,0 +1,31 @@
+#pragma once
+
+#include <chrono>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Frame rate limiter: wait() returns at most targetFps times per second. A frame that misses its
+		// deadline restarts the schedule instead of letting the next frames run back to back.
+		class FramePacer
+		{
+		public:
+			explicit FramePacer();
+			virtual ~FramePacer();
+
+		public:
+			// 0: unlimited
+			void setTargetFps(const double fps);
+			// at the end of a frame, before the next one starts
+			void wait();
+
+		public:
+			inline double targetFps() const { return this->m_targetFps; }
+
+		private:
+			double m_targetFps = 0.0;
+			std::chrono::steady_clock::duration m_period = std::chrono::steady_clock::duration::zero();
+			std::chrono::steady_clock::time_point m_deadline;
+			bool m_started = false;
+		};
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Bounded single producer / single consumer queue of frames, lock free. The slots are filled and
+		// read in place and reused, the queue never allocates:
+		//   producer: acquireWrite() -> fill -> commitWrite()
+		//   consumer: acquireRead() -> use -> releaseRead()
+		// Capacity frames can be in flight, the producer sees a full queue once it is that far ahead.
+		template <typename T, size_t Capacity>
+		class FrameQueue
+		{
+		public:
+			explicit FrameQueue() {}
+			virtual ~FrameQueue() {}
+
+			FrameQueue(const FrameQueue&) = delete;
+			FrameQueue& operator=(const FrameQueue&) = delete;
+
+		public:
+			// nullptr while the queue is full
+			T* acquireWrite() {
+				const size_t tail = this->m_tail.load(std::memory_order_relaxed);
+				if (tail - this->m_head.load(std::memory_order_acquire) == Capacity) {
+					return nullptr;
+				}
+				return &this->m_slots[tail % Capacity];
+			}
+			void commitWrite() {
+				this->m_tail.store(this->m_tail.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+			}
+
+			// oldest committed frame, nullptr while the queue is empty
+			T* acquireRead() {
+				const size_t head = this->m_head.load(std::memory_order_relaxed);
+				if (head == this->m_tail.load(std::memory_order_acquire)) {
+					return nullptr;
+				}
+				return &this->m_slots[head % Capacity];
+			}
+			void releaseRead() {
+				this->m_head.store(this->m_head.load(std::memory_order_relaxed) + 1u, std::memory_order_release);
+			}
+
+		private:
+			T m_slots[Capacity];
+			// frames read / written so far, only the consumer / producer writes its counter
+			std::atomic<size_t> m_head = { 0u };
+			std::atomic<size_t> m_tail = { 0u };
+		};
+	}
+}
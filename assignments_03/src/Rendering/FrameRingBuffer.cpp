@@ -0,0 +1,100 @@
+#include "FrameRingBuffer.h"
+#include "GLStateCache.h"
+
+#include <cstring>
+#include <iostream>
+
+namespace INANOA {
+	namespace OPENGL {
+		FrameRingBuffer::FrameRingBuffer() {}
+		FrameRingBuffer::~FrameRingBuffer() {
+			for (GLsync& fence : this->m_fences) {
+				if (fence != nullptr) {
+					glDeleteSync(fence);
+					fence = nullptr;
+				}
+			}
+			if (this->m_buffer != 0u) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffer);
+				glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				glDeleteBuffers(1, &this->m_buffer);
+			}
+		}
+
+		bool FrameRingBuffer::init(const GLsizeiptr bytesPerFrame) {
+			glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &this->m_uniformAlignment);
+			// every region starts on a uniform block boundary
+			this->m_bytesPerFrame = (bytesPerFrame + this->m_uniformAlignment - 1) / this->m_uniformAlignment * this->m_uniformAlignment;
+
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			const GLsizeiptr totalSize = this->m_bytesPerFrame * NUM_FRAME_SLOTS;
+			glGenBuffers(1, &this->m_buffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffer);
+			glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+			this->m_mapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags));
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			if (this->m_mapped == nullptr) {
+				std::cerr << "Failed to map frame ring buffer" << std::endl;
+				glDeleteBuffers(1, &this->m_buffer);
+				this->m_buffer = 0u;
+				return false;
+			}
+			return true;
+		}
+
+		void FrameRingBuffer::beginFrame() {
+			GLsync& fence = this->m_fences[this->m_currentSlot];
+			if (fence != nullptr) {
+				// only blocks when the CPU is NUM_FRAME_SLOTS frames ahead of the GPU
+				GLbitfield waitFlags = 0;
+				GLuint64 timeout = 0;
+				while (true) {
+					const GLenum status = glClientWaitSync(fence, waitFlags, timeout);
+					if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+						break;
+					}
+					if (status == GL_WAIT_FAILED) {
+						std::cerr << "Frame ring buffer fence wait failed" << std::endl;
+						break;
+					}
+					waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+					timeout = 1000000000u;
+				}
+				glDeleteSync(fence);
+				fence = nullptr;
+			}
+			this->m_frameOffset = 0;
+		}
+
+		void FrameRingBuffer::endFrame() {
+			this->m_fences[this->m_currentSlot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			this->m_currentSlot = (this->m_currentSlot + 1) % NUM_FRAME_SLOTS;
+		}
+
+		void* FrameRingBuffer::allocate(const GLsizeiptr size, const GLsizeiptr alignment, GLintptr& offset) {
+			if (this->m_mapped == nullptr) {
+				return nullptr;
+			}
+			const GLsizeiptr begin = (this->m_frameOffset + alignment - 1) / alignment * alignment;
+			if (begin + size > this->m_bytesPerFrame) {
+				std::cerr << "Frame ring buffer is full (" << this->m_bytesPerFrame << " bytes per frame)" << std::endl;
+				return nullptr;
+			}
+			this->m_frameOffset = begin + size;
+			offset = static_cast<GLintptr>(this->m_currentSlot) * this->m_bytesPerFrame + begin;
+			return this->m_mapped + offset;
+		}
+
+		bool FrameRingBuffer::bindUniformBlock(const GLuint binding, const void* data, const GLsizeiptr size) {
+			GLintptr offset = 0;
+			void* dst = this->allocate(size, this->m_uniformAlignment, offset);
+			if (dst == nullptr) {
+				return false;
+			}
+			std::memcpy(dst, data, static_cast<size_t>(size));
+			GLStateCache::bindBufferRange(GL_UNIFORM_BUFFER, binding, this->m_buffer, offset, size);
+			return true;
+		}
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Persistently mapped (coherent) buffer split into one region per frame in flight.
+		// Per-frame data such as uniform blocks is written straight into the mapping, no
+		// glBufferSubData / glUniform* calls. Every region is fenced at the end of its frame and
+		// beginFrame() waits for that fence before the region is reused, so the CPU never
+		// overwrites data the GPU may still read.
+		class FrameRingBuffer
+		{
+		public:
+			explicit FrameRingBuffer();
+			virtual ~FrameRingBuffer();
+
+			FrameRingBuffer(const FrameRingBuffer&) = delete;
+			FrameRingBuffer& operator=(const FrameRingBuffer&) = delete;
+
+		public:
+			bool init(const GLsizeiptr bytesPerFrame);
+			void beginFrame();
+			void endFrame();
+
+			// returns nullptr when the frame's region is full
+			void* allocate(const GLsizeiptr size, const GLsizeiptr alignment, GLintptr& offset);
+			// copies data into the ring and binds it to a GL_UNIFORM_BUFFER binding point
+			bool bindUniformBlock(const GLuint binding, const void* data, const GLsizeiptr size);
+
+		public:
+			inline GLuint buffer() const { return this->m_buffer; }
+			inline GLsizeiptr bytesPerFrame() const { return this->m_bytesPerFrame; }
+
+		private:
+			static const int NUM_FRAME_SLOTS = 3;
+
+			GLuint m_buffer = 0u;
+			unsigned char* m_mapped = nullptr;
+			GLsizeiptr m_bytesPerFrame = 0;
+			GLsizeiptr m_frameOffset = 0;
+			GLint m_uniformAlignment = 256;
+
+			GLsync m_fences[NUM_FRAME_SLOTS] = {};
+			int m_currentSlot = 0;
+		};
+	}
+}
@@ -0,0 +1,27 @@
+#include "GLExtensions.h"
+
+#include <cstring>
+
+namespace INANOA {
+	namespace OPENGL {
+		void GLExtensions::load(GLADloadproc loader) {
+			// a GL 4.6 context already has the core entry points
+			if (glad_glMultiDrawElementsIndirectCount == nullptr && GLExtensions::supported("GL_ARB_indirect_parameters")) {
+				glad_glMultiDrawArraysIndirectCount = reinterpret_cast<PFNGLMULTIDRAWARRAYSINDIRECTCOUNTPROC>(loader("glMultiDrawArraysIndirectCountARB"));
+				glad_glMultiDrawElementsIndirectCount = reinterpret_cast<PFNGLMULTIDRAWELEMENTSINDIRECTCOUNTPROC>(loader("glMultiDrawElementsIndirectCountARB"));
+			}
+		}
+
+		bool GLExtensions::supported(const char* extension) {
+			GLint numExtensions = 0;
+			glGetIntegerv(GL_NUM_EXTENSIONS, &numExtensions);
+			for (GLint i = 0; i < numExtensions; ++i) {
+				const GLubyte* name = glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i));
+				if (name != nullptr && std::strcmp(reinterpret_cast<const char*>(name), extension) == 0) {
+					return true;
+				}
+			}
+			return false;
+		}
+	}
+}
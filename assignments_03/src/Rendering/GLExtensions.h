@@ -0,0 +1,19 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Entry points the generated glad loader does not cover, resolved with the loader glad was
+		// initialized with. The ARB_indirect_parameters draws have the signature and semantics of their
+		// GL 4.6 versions and are installed under the core names, so callers only check e.g.
+		// glMultiDrawElementsIndirectCount != nullptr.
+		class GLExtensions
+		{
+		public:
+			// after gladLoadGLLoader, with the same loader
+			static void load(GLADloadproc loader);
+			static bool supported(const char* extension);
+		};
+	}
+}
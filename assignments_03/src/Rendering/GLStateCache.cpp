@@ -0,0 +1,192 @@
+#include "GLStateCache.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		namespace {
+			// binding not known, the next bind is always issued
+			constexpr GLuint UNKNOWN = 0xFFFFFFFFu;
+			constexpr int NUM_INDIRECT_TARGETS = 3;
+			constexpr int NUM_TEXTURE_TARGETS = 2;
+
+			struct IndexedBinding {
+				GLuint buffer = UNKNOWN;
+				GLintptr offset = 0;
+				// 0: glBindBufferBase
+				GLsizeiptr size = 0;
+			};
+
+			struct State {
+				GLuint program;
+				GLuint vertexArray;
+				GLuint indirectBuffers[NUM_INDIRECT_TARGETS];
+				IndexedBinding storageBuffers[GLStateCache::MAX_INDEXED_BINDINGS];
+				IndexedBinding uniformBuffers[GLStateCache::MAX_INDEXED_BINDINGS];
+				GLuint activeUnit;
+				GLuint textures[GLStateCache::MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+
+				GLStateCache::Stats frameStats;
+				GLStateCache::Stats lastFrameStats;
+
+				State() {
+					this->resetBindings();
+				}
+
+				void resetBindings() {
+					this->program = UNKNOWN;
+					this->vertexArray = UNKNOWN;
+					for (GLuint& buffer : this->indirectBuffers) {
+						buffer = UNKNOWN;
+					}
+					for (GLuint i = 0u; i < GLStateCache::MAX_INDEXED_BINDINGS; ++i) {
+						this->storageBuffers[i] = IndexedBinding();
+						this->uniformBuffers[i] = IndexedBinding();
+					}
+					this->activeUnit = UNKNOWN;
+					for (GLuint unit = 0u; unit < GLStateCache::MAX_TEXTURE_UNITS; ++unit) {
+						for (int target = 0; target < NUM_TEXTURE_TARGETS; ++target) {
+							this->textures[unit][target] = UNKNOWN;
+						}
+					}
+				}
+			};
+
+			State& state() {
+				static State current;
+				return current;
+			}
+
+			int indirectTargetIndex(const GLenum target) {
+				switch (target) {
+				case GL_DRAW_INDIRECT_BUFFER:
+					return 0;
+				case GL_DISPATCH_INDIRECT_BUFFER:
+					return 1;
+				case GL_PARAMETER_BUFFER:
+					return 2;
+				default:
+					return -1;
+				}
+			}
+
+			int textureTargetIndex(const GLenum target) {
+				switch (target) {
+				case GL_TEXTURE_2D:
+					return 0;
+				case GL_TEXTURE_2D_ARRAY:
+					return 1;
+				default:
+					return -1;
+				}
+			}
+
+			IndexedBinding* indexedBinding(const GLenum target, const GLuint index) {
+				if (index >= GLStateCache::MAX_INDEXED_BINDINGS) {
+					return nullptr;
+				}
+				if (target == GL_SHADER_STORAGE_BUFFER) {
+					return &state().storageBuffers[index];
+				}
+				if (target == GL_UNIFORM_BUFFER) {
+					return &state().uniformBuffers[index];
+				}
+				return nullptr;
+			}
+
+			// true when the call can be skipped, counts it either way
+			bool redundant(const bool alreadyBound) {
+				if (alreadyBound) {
+					state().frameStats.skippedCalls++;
+				}
+				else {
+					state().frameStats.issuedCalls++;
+				}
+				return alreadyBound;
+			}
+		}
+
+		void GLStateCache::beginFrame() {
+			State& current = state();
+			current.lastFrameStats = current.frameStats;
+			current.frameStats = Stats();
+			GLStateCache::invalidate();
+		}
+
+		void GLStateCache::invalidate() {
+			state().resetBindings();
+		}
+
+		void GLStateCache::useProgram(const GLuint program) {
+			if (redundant(state().program == program)) {
+				return;
+			}
+			glUseProgram(program);
+			state().program = program;
+		}
+
+		void GLStateCache::bindVertexArray(const GLuint vertexArray) {
+			if (redundant(state().vertexArray == vertexArray)) {
+				return;
+			}
+			glBindVertexArray(vertexArray);
+			state().vertexArray = vertexArray;
+		}
+
+		void GLStateCache::bindBuffer(const GLenum target, const GLuint buffer) {
+			const int targetIndex = indirectTargetIndex(target);
+			if (redundant(targetIndex >= 0 && state().indirectBuffers[targetIndex] == buffer)) {
+				return;
+			}
+			glBindBuffer(target, buffer);
+			if (targetIndex >= 0) {
+				state().indirectBuffers[targetIndex] = buffer;
+			}
+		}
+
+		void GLStateCache::bindBufferBase(const GLenum target, const GLuint index, const GLuint buffer) {
+			IndexedBinding* binding = indexedBinding(target, index);
+			if (redundant(binding != nullptr && binding->buffer == buffer && binding->size == 0)) {
+				return;
+			}
+			glBindBufferBase(target, index, buffer);
+			if (binding != nullptr) {
+				binding->buffer = buffer;
+				binding->offset = 0;
+				binding->size = 0;
+			}
+		}
+
+		void GLStateCache::bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size) {
+			IndexedBinding* binding = indexedBinding(target, index);
+			if (redundant(binding != nullptr && binding->buffer == buffer && binding->offset == offset && binding->size == size)) {
+				return;
+			}
+			glBindBufferRange(target, index, buffer, offset, size);
+			if (binding != nullptr) {
+				binding->buffer = buffer;
+				binding->offset = offset;
+				binding->size = size;
+			}
+		}
+
+		void GLStateCache::bindTexture(const GLuint unit, const GLenum target, const GLuint texture) {
+			State& current = state();
+			const int targetIndex = unit < MAX_TEXTURE_UNITS ? textureTargetIndex(target) : -1;
+			if (redundant(targetIndex >= 0 && current.textures[unit][targetIndex] == texture)) {
+				return;
+			}
+			if (current.activeUnit != unit) {
+				glActiveTexture(GL_TEXTURE0 + unit);
+				current.activeUnit = unit;
+				current.frameStats.issuedCalls++;
+			}
+			glBindTexture(target, texture);
+			if (targetIndex >= 0) {
+				current.textures[unit][targetIndex] = texture;
+			}
+		}
+
+		GLStateCache::Stats GLStateCache::lastFrameStats() {
+			return state().lastFrameStats;
+		}
+	}
+}
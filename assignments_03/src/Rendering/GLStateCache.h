@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Shadow copy of the bindings the per-frame render paths change: program, vertex array,
+		// indirect buffers, indexed SSBO / UBO bindings and the textures of the first units. A bind
+		// to what is already bound is skipped. Code that binds behind its back (loading, resizing,
+		// ImGui) runs outside the tracked part of the frame, beginFrame() forgets every binding.
+		// There is one GL context in this app, the state is per process.
+		class GLStateCache
+		{
+		public:
+			struct Stats {
+				uint32_t issuedCalls = 0u;
+				uint32_t skippedCalls = 0u;
+			};
+
+		public:
+			// publishes the counters of the previous frame and invalidates every binding
+			static void beginFrame();
+			static void invalidate();
+
+			static void useProgram(const GLuint program);
+			static void bindVertexArray(const GLuint vertexArray);
+			// GL_DRAW_INDIRECT_BUFFER, GL_DISPATCH_INDIRECT_BUFFER and GL_PARAMETER_BUFFER are tracked,
+			// other targets are passed through
+			static void bindBuffer(const GLenum target, const GLuint buffer);
+			// GL_SHADER_STORAGE_BUFFER / GL_UNIFORM_BUFFER bindings below MAX_INDEXED_BINDINGS are tracked
+			static void bindBufferBase(const GLenum target, const GLuint index, const GLuint buffer);
+			static void bindBufferRange(const GLenum target, const GLuint index, const GLuint buffer, const GLintptr offset, const GLsizeiptr size);
+			// GL_TEXTURE_2D / GL_TEXTURE_2D_ARRAY on units below MAX_TEXTURE_UNITS are tracked
+			static void bindTexture(const GLuint unit, const GLenum target, const GLuint texture);
+
+			static Stats lastFrameStats();
+
+		public:
+			static const GLuint MAX_INDEXED_BINDINGS = 32u;
+			static const GLuint MAX_TEXTURE_UNITS = 8u;
+		};
+	}
+}
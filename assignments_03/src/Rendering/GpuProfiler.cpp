@@ -0,0 +1,195 @@
+#include "GpuProfiler.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		GpuProfiler::GpuProfiler() {}
+		GpuProfiler::~GpuProfiler() {
+			for (FrameSlot& slot : this->m_slots) {
+				if (slot.queryPool.empty() == false) {
+					glDeleteQueries(static_cast<GLsizei>(slot.queryPool.size()), slot.queryPool.data());
+				}
+			}
+		}
+
+		void GpuProfiler::beginFrame() {
+			if (this->m_enabled == false) {
+				return;
+			}
+			const int slotIdx = this->m_frameCounter % NUM_FRAME_SLOTS;
+			FrameSlot& slot = this->m_slots[slotIdx];
+			if (slot.pending && this->resolveSlot(slot, false) == false) {
+				// results are still in flight after NUM_FRAME_SLOTS frames, drop them rather than stall
+				this->m_droppedFrames = this->m_droppedFrames + 1;
+			}
+			slot.frameIndex = this->m_frameCounter;
+			slot.pending = false;
+			slot.scopes.clear();
+			slot.usedQueries = 0u;
+
+			this->m_currentSlot = slotIdx;
+			this->m_scopeStack.clear();
+			this->beginScope("frame");
+		}
+
+		void GpuProfiler::endFrame() {
+			if (this->m_currentSlot < 0) {
+				return;
+			}
+			while (this->m_scopeStack.empty() == false) {
+				this->endScope();
+			}
+			this->m_slots[this->m_currentSlot].pending = true;
+			this->m_currentSlot = -1;
+			this->m_frameCounter = this->m_frameCounter + 1;
+
+			// resolve whatever is ready, oldest first so results stay in frame order
+			for (int frame = this->m_frameCounter - NUM_FRAME_SLOTS; frame < this->m_frameCounter; frame++) {
+				if (frame < 0) {
+					continue;
+				}
+				FrameSlot& slot = this->m_slots[frame % NUM_FRAME_SLOTS];
+				if (slot.pending == false || slot.frameIndex != frame) {
+					continue;
+				}
+				if (this->resolveSlot(slot, false) == false) {
+					break;
+				}
+			}
+		}
+
+		void GpuProfiler::beginScope(const char* name) {
+			if (this->m_currentSlot < 0) {
+				return;
+			}
+			FrameSlot& slot = this->m_slots[this->m_currentSlot];
+
+			Scope scope;
+			scope.parent = this->m_scopeStack.empty() ? -1 : this->m_scopeStack.back();
+			scope.depth = static_cast<int>(this->m_scopeStack.size());
+			// the frame scope is not part of the path
+			scope.name = scope.parent > 0 ? slot.scopes[scope.parent].name + "/" + name : name;
+			scope.beginQuery = this->acquireQuery(slot);
+			scope.endQuery = this->acquireQuery(slot);
+			glQueryCounter(scope.beginQuery, GL_TIMESTAMP);
+			scope.cpuBegin = std::chrono::steady_clock::now();
+
+			slot.scopes.push_back(scope);
+			this->m_scopeStack.push_back(static_cast<int>(slot.scopes.size() - 1));
+		}
+
+		void GpuProfiler::endScope() {
+			if (this->m_currentSlot < 0 || this->m_scopeStack.empty()) {
+				return;
+			}
+			Scope& scope = this->m_slots[this->m_currentSlot].scopes[this->m_scopeStack.back()];
+			this->m_scopeStack.pop_back();
+			glQueryCounter(scope.endQuery, GL_TIMESTAMP);
+			scope.cpuEnd = std::chrono::steady_clock::now();
+		}
+
+		void GpuProfiler::flush() {
+			for (int frame = this->m_frameCounter - NUM_FRAME_SLOTS; frame < this->m_frameCounter; frame++) {
+				if (frame < 0) {
+					continue;
+				}
+				FrameSlot& slot = this->m_slots[frame % NUM_FRAME_SLOTS];
+				if (slot.pending && slot.frameIndex == frame) {
+					this->resolveSlot(slot, true);
+				}
+			}
+		}
+
+		bool GpuProfiler::popFrame(FrameResult& result) {
+			if (this->m_resolvedFrames.empty()) {
+				return false;
+			}
+			result = this->m_resolvedFrames.front();
+			this->m_resolvedFrames.pop_front();
+			return true;
+		}
+
+		GLuint GpuProfiler::acquireQuery(FrameSlot& slot) {
+			if (slot.usedQueries == slot.queryPool.size()) {
+				GLuint query = 0u;
+				glGenQueries(1, &query);
+				slot.queryPool.push_back(query);
+			}
+			const GLuint query = slot.queryPool[slot.usedQueries];
+			slot.usedQueries = slot.usedQueries + 1u;
+			return query;
+		}
+
+		bool GpuProfiler::resolveSlot(FrameSlot& slot, const bool wait) {
+			if (slot.scopes.empty()) {
+				slot.pending = false;
+				return true;
+			}
+			if (wait == false) {
+				// the frame scope's end query is issued last, once it is available all the others are too
+				GLuint available = GL_FALSE;
+				glGetQueryObjectuiv(slot.scopes.front().endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+				if (available == GL_FALSE) {
+					return false;
+				}
+			}
+
+			FrameResult frame;
+			frame.frameIndex = slot.frameIndex;
+			frame.scopes.reserve(slot.scopes.size());
+			for (const Scope& scope : slot.scopes) {
+				GLuint64 beginNs = 0u;
+				GLuint64 endNs = 0u;
+				glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &beginNs);
+				glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &endNs);
+
+				ScopeResult result;
+				result.name = scope.name;
+				result.depth = scope.depth;
+				result.gpuMs = endNs > beginNs ? (endNs - beginNs) / 1.0e6 : 0.0;
+				result.cpuMs = std::chrono::duration<double, std::milli>(scope.cpuEnd - scope.cpuBegin).count();
+				frame.scopes.push_back(result);
+			}
+			slot.pending = false;
+
+			this->accumulate(frame);
+			this->m_resolvedFrames.push_back(frame);
+			if (this->m_resolvedFrames.size() > MAX_QUEUED_FRAMES) {
+				this->m_resolvedFrames.pop_front();
+			}
+			return true;
+		}
+
+		void GpuProfiler::accumulate(const FrameResult& frame) {
+			this->m_window.push_back(frame);
+			if (this->m_window.size() > static_cast<size_t>(ROLLING_WINDOW)) {
+				this->m_window.pop_front();
+			}
+
+			// scopes keep the order they first appeared in, averages are over the frames they were present in
+			this->m_rollingAverage.clear();
+			std::vector<int> counts;
+			for (const FrameResult& f : this->m_window) {
+				for (const ScopeResult& scope : f.scopes) {
+					size_t idx = 0u;
+					while (idx < this->m_rollingAverage.size() && this->m_rollingAverage[idx].name != scope.name) {
+						idx = idx + 1u;
+					}
+					if (idx == this->m_rollingAverage.size()) {
+						ScopeResult entry;
+						entry.name = scope.name;
+						entry.depth = scope.depth;
+						this->m_rollingAverage.push_back(entry);
+						counts.push_back(0);
+					}
+					this->m_rollingAverage[idx].cpuMs += scope.cpuMs;
+					this->m_rollingAverage[idx].gpuMs += scope.gpuMs;
+					counts[idx] = counts[idx] + 1;
+				}
+			}
+			for (size_t i = 0; i < this->m_rollingAverage.size(); i++) {
+				this->m_rollingAverage[i].cpuMs /= counts[i];
+				this->m_rollingAverage[i].gpuMs /= counts[i];
+			}
+		}
+	}
+}
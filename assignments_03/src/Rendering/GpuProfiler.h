@@ -0,0 +1,118 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Scoped CPU + GPU pass timer.
+		// Every scope writes two GL_TIMESTAMP queries (so scopes can nest, unlike GL_TIME_ELAPSED).
+		// Queries of a frame are read back NUM_FRAME_SLOTS frames later and only if the driver
+		// reports them available, so profiling never stalls the pipeline; a frame that is not ready
+		// in time is dropped instead of waited for.
+		class GpuProfiler
+		{
+		public:
+			struct ScopeResult {
+				std::string name;		// full path, e.g. "player/foliage"
+				int depth = 0;
+				double cpuMs = 0.0;
+				double gpuMs = 0.0;
+			};
+			struct FrameResult {
+				int frameIndex = -1;
+				std::vector<ScopeResult> scopes;
+			};
+
+		public:
+			explicit GpuProfiler();
+			virtual ~GpuProfiler();
+
+			GpuProfiler(const GpuProfiler&) = delete;
+			GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		public:
+			void beginFrame();
+			void endFrame();
+			void beginScope(const char* name);
+			void endScope();
+
+			// block until every submitted frame is resolved (end of a benchmark run)
+			void flush();
+			// oldest resolved frame that has not been consumed yet
+			bool popFrame(FrameResult& result);
+
+		public:
+			inline void setEnabled(const bool flag) { this->m_enabled = flag; }
+			inline bool enabled() const { return this->m_enabled; }
+			// rolling average over the last ROLLING_WINDOW resolved frames
+			inline const std::vector<ScopeResult>& rollingAverage() const { return this->m_rollingAverage; }
+			inline int droppedFrames() const { return this->m_droppedFrames; }
+
+		private:
+			struct Scope {
+				std::string name;
+				int depth = 0;
+				int parent = -1;
+				GLuint beginQuery = 0u;
+				GLuint endQuery = 0u;
+				std::chrono::steady_clock::time_point cpuBegin;
+				std::chrono::steady_clock::time_point cpuEnd;
+			};
+			struct FrameSlot {
+				int frameIndex = -1;
+				bool pending = false;
+				std::vector<Scope> scopes;
+				std::vector<GLuint> queryPool;
+				size_t usedQueries = 0u;
+			};
+
+			GLuint acquireQuery(FrameSlot& slot);
+			bool resolveSlot(FrameSlot& slot, const bool wait);
+			void accumulate(const FrameResult& frame);
+
+		private:
+			static const int NUM_FRAME_SLOTS = 4;
+			static const int ROLLING_WINDOW = 60;
+			static const size_t MAX_QUEUED_FRAMES = 16u;
+
+			FrameSlot m_slots[NUM_FRAME_SLOTS];
+			int m_frameCounter = 0;
+			int m_currentSlot = -1;
+			std::vector<int> m_scopeStack;
+
+			std::deque<FrameResult> m_resolvedFrames;
+			std::deque<FrameResult> m_window;
+			std::vector<ScopeResult> m_rollingAverage;
+
+			int m_droppedFrames = 0;
+			bool m_enabled = true;
+		};
+
+		// RAII helper, tolerates a null profiler
+		class ProfileScope
+		{
+		public:
+			explicit ProfileScope(GpuProfiler* profiler, const char* name) : m_profiler(profiler) {
+				if (this->m_profiler != nullptr) {
+					this->m_profiler->beginScope(name);
+				}
+			}
+			~ProfileScope() {
+				if (this->m_profiler != nullptr) {
+					this->m_profiler->endScope();
+				}
+			}
+
+			ProfileScope(const ProfileScope&) = delete;
+			ProfileScope& operator=(const ProfileScope&) = delete;
+
+		private:
+			GpuProfiler* m_profiler;
+		};
+	}
+}
@@ -0,0 +1,136 @@
+#include "HeadlessContext.h"
+
+#ifdef CG_HAS_EGL
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#endif
+
+#include <cstring>
+
+namespace INANOA {
+	namespace OPENGL {
+		HeadlessContext::HeadlessContext() {}
+		HeadlessContext::~HeadlessContext() {
+			this->destroy();
+		}
+
+#ifdef CG_HAS_EGL
+		namespace {
+			bool hasExtension(const char* extensions, const char* name) {
+				if (extensions == nullptr) {
+					return false;
+				}
+				const size_t len = std::strlen(name);
+				const char* p = extensions;
+				while ((p = std::strstr(p, name)) != nullptr) {
+					if ((p == extensions || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) {
+						return true;
+					}
+					p = p + len;
+				}
+				return false;
+			}
+		}
+
+		bool HeadlessContext::create(const int majorVersion, const int minorVersion) {
+			// prefer the surfaceless platform so no X/Wayland display is required
+			EGLDisplay display = EGL_NO_DISPLAY;
+			const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+			if (hasExtension(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+				PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+				if (getPlatformDisplay != nullptr) {
+					display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+				}
+			}
+			if (display == EGL_NO_DISPLAY) {
+				display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+			}
+			EGLint eglMajor = 0;
+			EGLint eglMinor = 0;
+			if (display == EGL_NO_DISPLAY || eglInitialize(display, &eglMajor, &eglMinor) == EGL_FALSE) {
+				this->m_errorLog = "eglInitialize failed";
+				return false;
+			}
+			this->m_display = display;
+
+			if (eglBindAPI(EGL_OPENGL_API) == EGL_FALSE) {
+				this->m_errorLog = "eglBindAPI(EGL_OPENGL_API) failed";
+				this->destroy();
+				return false;
+			}
+
+			const EGLint configAttribs[] = {
+				EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+				EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+				EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+				EGL_NONE
+			};
+			EGLConfig config = nullptr;
+			EGLint numConfig = 0;
+			eglChooseConfig(display, configAttribs, &config, 1, &numConfig);
+
+			// try the requested version first, then walk down to 4.5 (llvmpipe tops out there)
+			EGLContext context = EGL_NO_CONTEXT;
+			for (int minor = minorVersion; minor >= 5 && context == EGL_NO_CONTEXT; --minor) {
+				const EGLint contextAttribs[] = {
+					EGL_CONTEXT_MAJOR_VERSION, majorVersion,
+					EGL_CONTEXT_MINOR_VERSION, minor,
+					EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+					EGL_NONE
+				};
+				context = eglCreateContext(display, numConfig > 0 ? config : nullptr, EGL_NO_CONTEXT, contextAttribs);
+			}
+			if (context == EGL_NO_CONTEXT) {
+				this->m_errorLog = "eglCreateContext failed";
+				this->destroy();
+				return false;
+			}
+			this->m_context = context;
+
+			// all rendering goes to an FBO, the surface only exists when surfaceless contexts are not supported
+			EGLSurface surface = EGL_NO_SURFACE;
+			if (hasExtension(eglQueryString(display, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context") == false && numConfig > 0) {
+				const EGLint pbufferAttribs[] = { EGL_WIDTH, 16, EGL_HEIGHT, 16, EGL_NONE };
+				surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+				this->m_surface = surface;
+			}
+			if (eglMakeCurrent(display, surface, surface, context) == EGL_FALSE) {
+				this->m_errorLog = "eglMakeCurrent failed";
+				this->destroy();
+				return false;
+			}
+			return true;
+		}
+
+		void HeadlessContext::destroy() {
+			if (this->m_display == nullptr) {
+				return;
+			}
+			eglMakeCurrent(this->m_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+			if (this->m_surface != nullptr) {
+				eglDestroySurface(this->m_display, this->m_surface);
+			}
+			if (this->m_context != nullptr) {
+				eglDestroyContext(this->m_display, this->m_context);
+			}
+			eglTerminate(this->m_display);
+			this->m_surface = nullptr;
+			this->m_context = nullptr;
+			this->m_display = nullptr;
+		}
+
+		void* HeadlessContext::procAddress(const char* name) {
+			return (void*)eglGetProcAddress(name);
+		}
+#else
+		bool HeadlessContext::create(const int majorVersion, const int minorVersion) {
+			this->m_errorLog = "headless mode requires EGL (rebuild with CG_HAS_EGL)";
+			return false;
+		}
+		void HeadlessContext::destroy() {}
+		void* HeadlessContext::procAddress(const char* name) {
+			return nullptr;
+		}
+#endif
+	}
+}
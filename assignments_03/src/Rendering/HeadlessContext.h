@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Window-less OpenGL context created through EGL (surfaceless Mesa platform when available).
+		// Used by the benchmark mode so it can run on machines without a display or GPU (llvmpipe).
+		// Only available when the project is built with CG_HAS_EGL, otherwise create() always fails.
+		class HeadlessContext
+		{
+		public:
+			explicit HeadlessContext();
+			virtual ~HeadlessContext();
+
+			HeadlessContext(const HeadlessContext&) = delete;
+			HeadlessContext& operator=(const HeadlessContext&) = delete;
+
+		public:
+			bool create(const int majorVersion, const int minorVersion);
+			void destroy();
+
+		public:
+			inline const std::string& errorLog() const { return this->m_errorLog; }
+
+		public:
+			// matches the signature of GLADloadproc
+			static void* procAddress(const char* name);
+
+		private:
+			void* m_display = nullptr;
+			void* m_context = nullptr;
+			void* m_surface = nullptr;
+
+			std::string m_errorLog;
+		};
+	}
+}
@@ -0,0 +1,85 @@
+#include "HiZPyramid.h"
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace INANOA {
+	namespace OPENGL {
+		HiZPyramid::HiZPyramid() {}
+		HiZPyramid::~HiZPyramid() {
+			this->release();
+			delete this->m_buildShader;
+		}
+
+		bool HiZPyramid::init() {
+			this->m_buildShader = ShaderProgram::createShaderProgramForComputeShader("shaders/hiz_build.comp");
+			if (this->m_buildShader == nullptr) {
+				std::cerr << "Failed to create Hi-Z build shader" << std::endl;
+				return false;
+			}
+			glUseProgram(this->m_buildShader->programId());
+			this->m_copyDepthLoc = glGetUniformLocation(this->m_buildShader->programId(), "copyDepth");
+			glUniform1i(glGetUniformLocation(this->m_buildShader->programId(), "depthTexture"), 0);
+			glUseProgram(0);
+			return true;
+		}
+
+		void HiZPyramid::release() {
+			if (this->m_texture != 0u) {
+				glDeleteTextures(1, &this->m_texture);
+				this->m_texture = 0u;
+			}
+		}
+
+		void HiZPyramid::resize(const int width, const int height) {
+			if (width == this->m_width && height == this->m_height && this->m_texture != 0u) {
+				return;
+			}
+			this->release();
+			this->m_width = std::max(width, 1);
+			this->m_height = std::max(height, 1);
+
+			int levels = 1;
+			while ((std::max(this->m_width, this->m_height) >> levels) > 0) {
+				levels = levels + 1;
+			}
+			this->m_numLevels = levels;
+
+			glGenTextures(1, &this->m_texture);
+			glBindTexture(GL_TEXTURE_2D, this->m_texture);
+			glTexStorage2D(GL_TEXTURE_2D, this->m_numLevels, GL_R32F, this->m_width, this->m_height);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			glBindTexture(GL_TEXTURE_2D, 0);
+		}
+
+		void HiZPyramid::build(const GLuint depthTexture) {
+			if (this->m_buildShader == nullptr || this->m_texture == 0u) {
+				return;
+			}
+			const GLuint groupSize = 8u;
+			GLStateCache::useProgram(this->m_buildShader->programId());
+
+			// level 0: copy of the depth buffer
+			GLStateCache::bindTexture(0, GL_TEXTURE_2D, depthTexture);
+			glUniform1i(this->m_copyDepthLoc, 1);
+			glBindImageTexture(1, this->m_texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+			glDispatchCompute((this->m_width + groupSize - 1) / groupSize, (this->m_height + groupSize - 1) / groupSize, 1);
+
+			// max-reduce level by level
+			glUniform1i(this->m_copyDepthLoc, 0);
+			for (int level = 1; level < this->m_numLevels; level++) {
+				glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+				const GLuint w = std::max(this->m_width >> level, 1);
+				const GLuint h = std::max(this->m_height >> level, 1);
+				glBindImageTexture(0, this->m_texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+				glBindImageTexture(1, this->m_texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+				glDispatchCompute((w + groupSize - 1) / groupSize, (h + groupSize - 1) / groupSize, 1);
+			}
+			glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+		}
+	}
+}
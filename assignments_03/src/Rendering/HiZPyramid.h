@@ -0,0 +1,46 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Shader.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		// Hierarchical-Z depth pyramid (R32F mip chain, each texel = farthest depth of its footprint).
+		// Level 0 has the size of the source depth buffer; the last texel of a row/column of every
+		// level also covers the texel left over when the previous level has an odd size, so
+		// "pixel >> level" (clamped to the level size) is always a conservative lookup.
+		class HiZPyramid
+		{
+		public:
+			explicit HiZPyramid();
+			virtual ~HiZPyramid();
+
+			HiZPyramid(const HiZPyramid&) = delete;
+			HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+		public:
+			bool init();
+			void resize(const int width, const int height);
+			void build(const GLuint depthTexture);
+
+		public:
+			inline GLuint texture() const { return this->m_texture; }
+			inline int width() const { return this->m_width; }
+			inline int height() const { return this->m_height; }
+			inline int numLevels() const { return this->m_numLevels; }
+
+		private:
+			void release();
+
+		private:
+			ShaderProgram* m_buildShader = nullptr;
+			GLint m_copyDepthLoc = -1;
+
+			GLuint m_texture = 0u;
+			int m_width = 0;
+			int m_height = 0;
+			int m_numLevels = 0;
+		};
+	}
+}
@@ -0,0 +1,119 @@
+#include "ImpostorAtlas.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <initializer_list>
+#include <iostream>
+
+namespace INANOA {
+	namespace OPENGL {
+		ImpostorAtlas::ImpostorAtlas() {}
+		ImpostorAtlas::~ImpostorAtlas() {
+			delete this->m_bakeShader;
+			if (this->m_fbo != 0u) {
+				glDeleteFramebuffers(1, &this->m_fbo);
+			}
+			if (this->m_depthBuffer != 0u) {
+				glDeleteRenderbuffers(1, &this->m_depthBuffer);
+			}
+			if (this->m_albedoTexture != 0u) {
+				glDeleteTextures(1, &this->m_albedoTexture);
+			}
+			if (this->m_normalDepthTexture != 0u) {
+				glDeleteTextures(1, &this->m_normalDepthTexture);
+			}
+		}
+
+		bool ImpostorAtlas::init(const int numLayers) {
+			this->m_bakeShader = ShaderProgram::createShaderProgram("shaders/impostor_bake.vert", "shaders/impostor_bake.frag");
+			if (this->m_bakeShader == nullptr) {
+				std::cerr << "Failed to create impostor bake shader" << std::endl;
+				return false;
+			}
+			glUseProgram(this->m_bakeShader->programId());
+			this->m_boundingSphereLoc = glGetUniformLocation(this->m_bakeShader->programId(), "boundingSphere");
+			this->m_frameLoc = glGetUniformLocation(this->m_bakeShader->programId(), "frame");
+			this->m_textureLayerLoc = glGetUniformLocation(this->m_bakeShader->programId(), "textureLayer");
+			glUniform1i(glGetUniformLocation(this->m_bakeShader->programId(), "framesPerSide"), FRAMES_PER_SIDE);
+			glUniform1i(glGetUniformLocation(this->m_bakeShader->programId(), "albedoTextureArray"), 0);
+			glUseProgram(0);
+
+			this->m_numLayers = numLayers;
+			glGenTextures(1, &this->m_albedoTexture);
+			glGenTextures(1, &this->m_normalDepthTexture);
+			for (const GLuint texture : { this->m_albedoTexture, this->m_normalDepthTexture }) {
+				glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+				glTexStorage3D(GL_TEXTURE_2D_ARRAY, LEVELS, GL_RGBA8, ATLAS_SIZE, ATLAS_SIZE, numLayers);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+			}
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+			glGenRenderbuffers(1, &this->m_depthBuffer);
+			glBindRenderbuffer(GL_RENDERBUFFER, this->m_depthBuffer);
+			glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, ATLAS_SIZE, ATLAS_SIZE);
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			glGenFramebuffers(1, &this->m_fbo);
+			return true;
+		}
+
+		void ImpostorAtlas::bake(const int layer, const GLuint vertexArray, const GLsizei indexCount, const GLuint firstIndex, const GLint baseVertex, const glm::vec4& boundingSphere, const GLuint albedoTextureArray, const GLuint textureLayer) {
+			if (this->m_bakeShader == nullptr || layer < 0 || layer >= this->m_numLayers) {
+				return;
+			}
+			// runs between frames (loading uploads), the caller's framebuffer and viewport are restored
+			GLint prevFramebuffer = 0;
+			GLint prevViewport[4] = {};
+			glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &prevFramebuffer);
+			glGetIntegerv(GL_VIEWPORT, prevViewport);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, this->m_fbo);
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, this->m_albedoTexture, 0, layer);
+			glFramebufferTextureLayer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, this->m_normalDepthTexture, 0, layer);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->m_depthBuffer);
+			const GLenum drawBuffers[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
+			glDrawBuffers(2, drawBuffers);
+			if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+				std::cerr << "Impostor atlas framebuffer incomplete" << std::endl;
+				glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFramebuffer));
+				return;
+			}
+			const GLfloat clearColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			const GLfloat clearDepth[1] = { 1.0f };
+			glClearBufferfv(GL_COLOR, 0, clearColor);
+			glClearBufferfv(GL_COLOR, 1, clearColor);
+			glClearBufferfv(GL_DEPTH, 0, clearDepth);
+
+			glUseProgram(this->m_bakeShader->programId());
+			glUniform4fv(this->m_boundingSphereLoc, 1, glm::value_ptr(boundingSphere));
+			glUniform1f(this->m_textureLayerLoc, static_cast<float>(textureLayer));
+			glActiveTexture(GL_TEXTURE0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, albedoTextureArray);
+			glBindVertexArray(vertexArray);
+			const void* indexOffset = reinterpret_cast<const void*>(static_cast<size_t>(firstIndex) * sizeof(GLuint));
+			for (int j = 0; j < FRAMES_PER_SIDE; ++j) {
+				for (int i = 0; i < FRAMES_PER_SIDE; ++i) {
+					glViewport(i * FRAME_SIZE, j * FRAME_SIZE, FRAME_SIZE, FRAME_SIZE);
+					glUniform2i(this->m_frameLoc, i, j);
+					glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, indexOffset, baseVertex);
+				}
+			}
+			glBindVertexArray(0);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+			glUseProgram(0);
+
+			glBindFramebuffer(GL_FRAMEBUFFER, static_cast<GLuint>(prevFramebuffer));
+			glViewport(prevViewport[0], prevViewport[1], prevViewport[2], prevViewport[3]);
+		}
+
+		void ImpostorAtlas::finish() {
+			for (const GLuint texture : { this->m_albedoTexture, this->m_normalDepthTexture }) {
+				glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+				glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+			}
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include <glm/vec4.hpp>
+
+#include "Shader.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		// Octahedral impostors: every layer holds FRAMES_PER_SIDE^2 orthographic views of one mesh. Frame
+		// (i, j) looks at the mesh's bounding sphere from the upper hemisphere direction at the frame center,
+		// hemi-octahedral mapping (see impostor_bake.vert / impostor.vert). Two RGBA8 arrays, both
+		// premultiplied by coverage so their mips only average covered texels:
+		//   albedo:       albedo, coverage
+		//   normal depth: mesh space normal, depth along the view direction (in [0, 1] over the sphere)
+		class ImpostorAtlas
+		{
+		public:
+			static const int FRAMES_PER_SIDE = 8;
+			static const int FRAME_SIZE = 128;
+			static const int ATLAS_SIZE = FRAMES_PER_SIDE * FRAME_SIZE;
+			// the frames would bleed into each other below 8 x 8 texels
+			static const int LEVELS = 5;
+
+		public:
+			explicit ImpostorAtlas();
+			virtual ~ImpostorAtlas();
+
+			ImpostorAtlas(const ImpostorAtlas&) = delete;
+			ImpostorAtlas& operator=(const ImpostorAtlas&) = delete;
+
+		public:
+			bool init(const int numLayers);
+			// renders every frame of a layer from indexed triangles of vertexArray (position, normal, uv at
+			// locations 0, 1, 2), alpha tested against textureLayer of albedoTextureArray
+			void bake(const int layer, const GLuint vertexArray, const GLsizei indexCount, const GLuint firstIndex, const GLint baseVertex, const glm::vec4& boundingSphere, const GLuint albedoTextureArray, const GLuint textureLayer);
+			// builds the mips once every layer is baked
+			void finish();
+
+		public:
+			inline GLuint albedoTexture() const { return this->m_albedoTexture; }
+			inline GLuint normalDepthTexture() const { return this->m_normalDepthTexture; }
+			inline int numLayers() const { return this->m_numLayers; }
+
+		private:
+			ShaderProgram* m_bakeShader = nullptr;
+			GLint m_boundingSphereLoc = -1;
+			GLint m_frameLoc = -1;
+			GLint m_textureLayerLoc = -1;
+
+			GLuint m_albedoTexture = 0u;
+			GLuint m_normalDepthTexture = 0u;
+			GLuint m_depthBuffer = 0u;
+			GLuint m_fbo = 0u;
+			int m_numLayers = 0;
+		};
+	}
+}
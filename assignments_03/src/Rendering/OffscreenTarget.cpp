@@ -0,0 +1,86 @@
+#include "OffscreenTarget.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		OffscreenTarget::OffscreenTarget() {}
+		OffscreenTarget::~OffscreenTarget() {
+			this->release();
+		}
+
+		bool OffscreenTarget::init(const int width, const int height, const int samples) {
+			this->release();
+			this->m_width = width;
+			this->m_height = height;
+			this->m_samples = samples;
+
+			glGenRenderbuffers(1, &this->m_colorBuffer);
+			glBindRenderbuffer(GL_RENDERBUFFER, this->m_colorBuffer);
+			if (samples > 1) {
+				glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_RGBA8, width, height);
+			}
+			else {
+				glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+			}
+			glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+			if (samples > 1) {
+				// same format as the depth texture, so it resolves into a single sample target with a blit
+				glGenRenderbuffers(1, &this->m_depthBuffer);
+				glBindRenderbuffer(GL_RENDERBUFFER, this->m_depthBuffer);
+				glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, GL_DEPTH_COMPONENT32F, width, height);
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+				glGenFramebuffers(1, &this->m_fbo);
+				glBindFramebuffer(GL_FRAMEBUFFER, this->m_fbo);
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->m_colorBuffer);
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->m_depthBuffer);
+				const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+				glBindFramebuffer(GL_FRAMEBUFFER, 0);
+				return status == GL_FRAMEBUFFER_COMPLETE;
+			}
+
+			glGenTextures(1, &this->m_depthTexture);
+			glBindTexture(GL_TEXTURE_2D, this->m_depthTexture);
+			glTexStorage2D(GL_TEXTURE_2D, 1, GL_DEPTH_COMPONENT32F, width, height);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			glGenFramebuffers(1, &this->m_fbo);
+			glBindFramebuffer(GL_FRAMEBUFFER, this->m_fbo);
+			glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, this->m_colorBuffer);
+			glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, this->m_depthTexture, 0);
+			const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+			return status == GL_FRAMEBUFFER_COMPLETE;
+		}
+
+		void OffscreenTarget::release() {
+			if (this->m_fbo != 0u) {
+				glDeleteFramebuffers(1, &this->m_fbo);
+				this->m_fbo = 0u;
+			}
+			if (this->m_colorBuffer != 0u) {
+				glDeleteRenderbuffers(1, &this->m_colorBuffer);
+				this->m_colorBuffer = 0u;
+			}
+			if (this->m_depthTexture != 0u) {
+				glDeleteTextures(1, &this->m_depthTexture);
+				this->m_depthTexture = 0u;
+			}
+			if (this->m_depthBuffer != 0u) {
+				glDeleteRenderbuffers(1, &this->m_depthBuffer);
+				this->m_depthBuffer = 0u;
+			}
+		}
+
+		void OffscreenTarget::bind() const {
+			glBindFramebuffer(GL_FRAMEBUFFER, this->m_fbo);
+		}
+		void OffscreenTarget::unbind() const {
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		}
+	}
+}
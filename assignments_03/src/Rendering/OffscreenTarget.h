@@ -0,0 +1,45 @@
+#pragma once
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		// Color + depth framebuffer object. Used as the render target when there is no default framebuffer
+		// and for views whose depth is consumed later (the depth attachment is a sampleable texture).
+		// A multisample target has a depth renderbuffer instead, it is read by resolving it into a
+		// single sample target of the same size.
+		class OffscreenTarget
+		{
+		public:
+			explicit OffscreenTarget();
+			virtual ~OffscreenTarget();
+
+			OffscreenTarget(const OffscreenTarget&) = delete;
+			OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+		public:
+			bool init(const int width, const int height, const int samples = 1);
+			void release();
+			void bind() const;
+			void unbind() const;
+
+		public:
+			inline GLuint framebufferId() const { return this->m_fbo; }
+			// 0 for a multisample target
+			inline GLuint depthTexture() const { return this->m_depthTexture; }
+			inline int width() const { return this->m_width; }
+			inline int height() const { return this->m_height; }
+			inline int samples() const { return this->m_samples; }
+
+		private:
+			GLuint m_fbo = 0u;
+			GLuint m_colorBuffer = 0u;
+			GLuint m_depthTexture = 0u;
+			GLuint m_depthBuffer = 0u;
+
+			int m_width = 0;
+			int m_height = 0;
+			int m_samples = 1;
+		};
+	}
+}
@@ -0,0 +1,231 @@
+#include "OverdrawCounter.h"
+
+#include "GLStateCache.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace INANOA {
+	namespace OPENGL {
+		namespace {
+			// must match overdraw_reduce.comp
+			const GLuint RESULT_BINDING = 0u;
+			const int REDUCE_GROUP_SIZE = 16;
+			// per view: fragments, max fragments, covered pixels, lane units
+			const GLsizeiptr RESULT_BUFFER_SIZE = OverdrawCounter::MAX_VIEWS * 4 * sizeof(GLuint);
+		}
+
+		OverdrawCounter::OverdrawCounter() {}
+		OverdrawCounter::~OverdrawCounter() {
+			delete this->m_reduceShader;
+			delete this->m_viewShader;
+			for (FrameSlot& slot : this->m_slots) {
+				if (slot.fence != nullptr) {
+					glDeleteSync(slot.fence);
+				}
+				if (slot.resultBuffer != 0u) {
+					glDeleteBuffers(1, &slot.resultBuffer);
+				}
+			}
+			if (this->m_countTexture != 0u) {
+				glDeleteTextures(1, &this->m_countTexture);
+			}
+			if (this->m_emptyVao != 0u) {
+				glDeleteVertexArrays(1, &this->m_emptyVao);
+			}
+		}
+
+		bool OverdrawCounter::init() {
+			this->m_reduceShader = ShaderProgram::createShaderProgramForComputeShader("shaders/overdraw_reduce.comp");
+			this->m_viewShader = ShaderProgram::createShaderProgram("shaders/overdraw_view.vert", "shaders/overdraw_view.frag");
+			if (this->m_reduceShader == nullptr || this->m_viewShader == nullptr) {
+				std::cerr << "Failed to create overdraw shaders" << std::endl;
+				return false;
+			}
+			this->m_reduceViewLoc = glGetUniformLocation(this->m_reduceShader->programId(), "view");
+			this->m_reduceViewportSizeLoc = glGetUniformLocation(this->m_reduceShader->programId(), "viewportSize");
+			this->m_viewViewLoc = glGetUniformLocation(this->m_viewShader->programId(), "view");
+			this->m_viewTypeLoc = glGetUniformLocation(this->m_viewShader->programId(), "debugView");
+			this->m_viewViewportOriginLoc = glGetUniformLocation(this->m_viewShader->programId(), "viewportOrigin");
+			glUseProgram(this->m_viewShader->programId());
+			glUniform1ui(glGetUniformLocation(this->m_viewShader->programId(), "laneUnits"), LANE_UNITS);
+			glUseProgram(0);
+
+			for (FrameSlot& slot : this->m_slots) {
+				glGenBuffers(1, &slot.resultBuffer);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, slot.resultBuffer);
+				glBufferData(GL_COPY_WRITE_BUFFER, RESULT_BUFFER_SIZE, nullptr, GL_DYNAMIC_READ);
+			}
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glGenVertexArrays(1, &this->m_emptyVao);
+			return true;
+		}
+
+		void OverdrawCounter::resize(const int width, const int height) {
+			if (this->m_countTexture != 0u) {
+				glDeleteTextures(1, &this->m_countTexture);
+			}
+			this->m_width = width;
+			this->m_height = height;
+			glGenTextures(1, &this->m_countTexture);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, this->m_countTexture);
+			glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R32UI, width, height, MAX_VIEWS * 2);
+			glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		}
+
+		void OverdrawCounter::beginFrame() {
+			const int slotIdx = this->m_frameCounter % NUM_FRAME_SLOTS;
+			FrameSlot& slot = this->m_slots[slotIdx];
+			if (slot.fence != nullptr && this->resolveSlot(slot, false) == false) {
+				// still in flight after NUM_FRAME_SLOTS frames, drop it rather than stall
+				glDeleteSync(slot.fence);
+				slot.fence = nullptr;
+				this->m_droppedFrames = this->m_droppedFrames + 1;
+			}
+			slot.frameIndex = this->m_frameCounter;
+			slot.reduced = false;
+			this->m_currentSlot = slotIdx;
+		}
+
+		void OverdrawCounter::endFrame() {
+			if (this->m_currentSlot < 0) {
+				return;
+			}
+			FrameSlot& current = this->m_slots[this->m_currentSlot];
+			if (current.reduced) {
+				glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);
+				current.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			}
+			this->m_currentSlot = -1;
+			this->m_frameCounter = this->m_frameCounter + 1;
+
+			// oldest first so results stay in frame order
+			for (int frame = this->m_frameCounter - NUM_FRAME_SLOTS; frame < this->m_frameCounter; frame++) {
+				if (frame < 0) {
+					continue;
+				}
+				FrameSlot& slot = this->m_slots[frame % NUM_FRAME_SLOTS];
+				if (slot.fence == nullptr || slot.frameIndex != frame) {
+					continue;
+				}
+				if (this->resolveSlot(slot, false) == false) {
+					break;
+				}
+			}
+		}
+
+		void OverdrawCounter::clear() {
+			if (this->m_countTexture != 0u) {
+				glClearTexImage(this->m_countTexture, 0, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+			}
+		}
+
+		void OverdrawCounter::bindImage() const {
+			glBindImageTexture(IMAGE_UNIT, this->m_countTexture, 0, GL_TRUE, 0, GL_READ_WRITE, GL_R32UI);
+		}
+
+		void OverdrawCounter::reduce(const int view, const char* name, const int width, const int height) {
+			if (this->m_currentSlot < 0 || this->m_reduceShader == nullptr || view < 0 || view >= MAX_VIEWS) {
+				return;
+			}
+			FrameSlot& slot = this->m_slots[this->m_currentSlot];
+			if (slot.reduced == false) {
+				glBindBuffer(GL_COPY_WRITE_BUFFER, slot.resultBuffer);
+				glClearBufferData(GL_COPY_WRITE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+				glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+				for (int v = 0; v < MAX_VIEWS; ++v) {
+					slot.names[v] = nullptr;
+				}
+				slot.reduced = true;
+			}
+			const int w = std::min(width, this->m_width);
+			const int h = std::min(height, this->m_height);
+			slot.names[view] = name;
+			slot.sizes[view][0] = w;
+			slot.sizes[view][1] = h;
+
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			GLStateCache::useProgram(this->m_reduceShader->programId());
+			glUniform1i(this->m_reduceViewLoc, view);
+			glUniform2i(this->m_reduceViewportSizeLoc, w, h);
+			this->bindImage();
+			GLStateCache::bindBufferBase(GL_SHADER_STORAGE_BUFFER, RESULT_BINDING, slot.resultBuffer);
+			glDispatchCompute(static_cast<GLuint>((w + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE), static_cast<GLuint>((h + REDUCE_GROUP_SIZE - 1) / REDUCE_GROUP_SIZE), 1u);
+		}
+
+		void OverdrawCounter::draw(const int view, const DebugViewType type, const int x, const int y) {
+			if (this->m_viewShader == nullptr) {
+				return;
+			}
+			glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+			GLStateCache::useProgram(this->m_viewShader->programId());
+			glUniform1i(this->m_viewViewLoc, view);
+			glUniform1i(this->m_viewTypeLoc, static_cast<int>(type));
+			glUniform2i(this->m_viewViewportOriginLoc, x, y);
+			this->bindImage();
+			GLStateCache::bindVertexArray(this->m_emptyVao);
+			glDisable(GL_DEPTH_TEST);
+			glDrawArrays(GL_TRIANGLES, 0, 3);
+			glEnable(GL_DEPTH_TEST);
+		}
+
+		void OverdrawCounter::flush() {
+			for (int frame = this->m_frameCounter - NUM_FRAME_SLOTS; frame < this->m_frameCounter; frame++) {
+				if (frame < 0) {
+					continue;
+				}
+				FrameSlot& slot = this->m_slots[frame % NUM_FRAME_SLOTS];
+				if (slot.fence != nullptr && slot.frameIndex == frame) {
+					this->resolveSlot(slot, true);
+				}
+			}
+		}
+
+		bool OverdrawCounter::popFrame(FrameResult& result) {
+			if (this->m_resolvedFrames.empty()) {
+				return false;
+			}
+			result = this->m_resolvedFrames.front();
+			this->m_resolvedFrames.pop_front();
+			return true;
+		}
+
+		bool OverdrawCounter::resolveSlot(FrameSlot& slot, const bool wait) {
+			const GLuint64 timeoutNs = wait ? 1000000000u : 0u;
+			const GLenum status = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+			if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+				return false;
+			}
+			glDeleteSync(slot.fence);
+			slot.fence = nullptr;
+
+			GLuint sums[MAX_VIEWS][4] = {};
+			glBindBuffer(GL_COPY_READ_BUFFER, slot.resultBuffer);
+			glGetBufferSubData(GL_COPY_READ_BUFFER, 0, RESULT_BUFFER_SIZE, sums);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+			FrameResult frame;
+			frame.frameIndex = slot.frameIndex;
+			for (int v = 0; v < MAX_VIEWS; ++v) {
+				const double numPixels = static_cast<double>(slot.sizes[v][0]) * slot.sizes[v][1];
+				if (slot.names[v] == nullptr || numPixels <= 0.0) {
+					continue;
+				}
+				ViewStats& stats = frame.views[v];
+				stats.valid = true;
+				stats.name = slot.names[v];
+				stats.averageOverdraw = sums[v][0] / numPixels;
+				stats.coveredOverdraw = sums[v][2] > 0u ? sums[v][0] / static_cast<double>(sums[v][2]) : 0.0;
+				stats.maxOverdraw = sums[v][1];
+				stats.quadOccupancy = sums[v][3] > 0u ? sums[v][0] * static_cast<double>(LANE_UNITS) / sums[v][3] : 0.0;
+			}
+
+			this->m_latest = frame;
+			this->m_resolvedFrames.push_back(frame);
+			if (this->m_resolvedFrames.size() > MAX_QUEUED_FRAMES) {
+				this->m_resolvedFrames.pop_front();
+			}
+			return true;
+		}
+	}
+}
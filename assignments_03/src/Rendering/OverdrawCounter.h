@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+
+#include <glad/glad.h>
+
+#include "RendererBase.h"
+#include "Shader.h"
+
+namespace INANOA {
+	namespace OPENGL {
+		// Per-pixel fragment counts of the foliage debug views. foliage_debug.frag adds to two r32ui
+		// layers per view: the fragments, and the quad lanes they occupied in units of 1 / LANE_UNITS
+		// (a fragment of a quad with n covered lanes adds 4 * LANE_UNITS / n). reduce() sums a view's
+		// viewport on the GPU; the sums of a frame are read back NUM_FRAME_SLOTS frames later and only if
+		// the fence has passed, like the GpuProfiler a frame that is not ready in time is dropped.
+		class OverdrawCounter
+		{
+		public:
+			static const int MAX_VIEWS = 2;
+			static const uint32_t LANE_UNITS = 12u;
+			// image unit of the count layers in foliage_debug.frag / overdraw_view.frag / overdraw_reduce.comp
+			static const GLuint IMAGE_UNIT = 0u;
+
+			struct ViewStats {
+				bool valid = false;
+				const char* name = "";
+				// fragments per pixel of the viewport, and per pixel with at least one fragment
+				double averageOverdraw = 0.0;
+				double coveredOverdraw = 0.0;
+				uint32_t maxOverdraw = 0u;
+				// covered / shaded quad lanes
+				double quadOccupancy = 0.0;
+			};
+			struct FrameResult {
+				int frameIndex = -1;
+				ViewStats views[MAX_VIEWS];
+			};
+
+		public:
+			explicit OverdrawCounter();
+			virtual ~OverdrawCounter();
+
+			OverdrawCounter(const OverdrawCounter&) = delete;
+			OverdrawCounter& operator=(const OverdrawCounter&) = delete;
+
+		public:
+			bool init();
+			// the largest viewport
+			void resize(const int width, const int height);
+
+			// every render() call: picks up the finished readbacks
+			void beginFrame();
+			void endFrame();
+			// zeroes the counts, before the first counted draw of a frame
+			void clear();
+			void bindImage() const;
+			// sums the counts of a view's viewport (its fragments start at the viewport origin of the layers)
+			void reduce(const int view, const char* name, const int width, const int height);
+			// heatmap of the counts over the bound viewport (lower left corner x, y), OVERDRAW or QUAD_OCCUPANCY
+			void draw(const int view, const DebugViewType type, const int x, const int y);
+
+			// block until every submitted frame is read back (end of a benchmark run)
+			void flush();
+			// oldest read back frame that has not been consumed yet
+			bool popFrame(FrameResult& result);
+
+		public:
+			inline const FrameResult& latest() const { return this->m_latest; }
+			inline int droppedFrames() const { return this->m_droppedFrames; }
+
+		private:
+			struct FrameSlot {
+				int frameIndex = -1;
+				bool reduced = false;
+				GLsync fence = nullptr;
+				GLuint resultBuffer = 0u;
+				const char* names[MAX_VIEWS] = {};
+				int sizes[MAX_VIEWS][2] = {};
+			};
+
+			bool resolveSlot(FrameSlot& slot, const bool wait);
+
+		private:
+			static const int NUM_FRAME_SLOTS = 4;
+			static const size_t MAX_QUEUED_FRAMES = 16u;
+
+			ShaderProgram* m_reduceShader = nullptr;
+			ShaderProgram* m_viewShader = nullptr;
+			GLint m_reduceViewLoc = -1;
+			GLint m_reduceViewportSizeLoc = -1;
+			GLint m_viewViewLoc = -1;
+			GLint m_viewTypeLoc = -1;
+			GLint m_viewViewportOriginLoc = -1;
+
+			GLuint m_countTexture = 0u;
+			// the heatmap is a full screen triangle without attributes
+			GLuint m_emptyVao = 0u;
+			int m_width = 0;
+			int m_height = 0;
+
+			FrameSlot m_slots[NUM_FRAME_SLOTS];
+			int m_frameCounter = 0;
+			int m_currentSlot = -1;
+
+			std::deque<FrameResult> m_resolvedFrames;
+			FrameResult m_latest;
+			int m_droppedFrames = 0;
+		};
+	}
+}
@@ -0,0 +1,137 @@
+#include "ProgramBinaryCache.h"
+#include "Shader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace INANOA {
+	namespace OPENGL {
+		namespace {
+			const char* const PROGRAM_CACHE_DIRECTORY = "cache/programs/";
+
+			// FNV-1a
+			uint32_t hashBytes(uint32_t hash, const void* data, const size_t size) {
+				const unsigned char* bytes = static_cast<const unsigned char*>(data);
+				for (size_t i = 0; i < size; ++i) {
+					hash = (hash ^ bytes[i]) * 16777619u;
+				}
+				return hash;
+			}
+
+			uint32_t hashGLString(const uint32_t hash, const GLenum name) {
+				const GLubyte* value = glGetString(name);
+				if (value == nullptr) {
+					return hash;
+				}
+				return hashBytes(hash, value, std::char_traits<char>::length(reinterpret_cast<const char*>(value)));
+			}
+
+			bool formatSupported(const GLenum binaryFormat) {
+				GLint numFormats = 0;
+				glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+				if (numFormats <= 0) {
+					return false;
+				}
+				std::vector<GLint> formats(static_cast<size_t>(numFormats));
+				glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, formats.data());
+				return std::find(formats.begin(), formats.end(), static_cast<GLint>(binaryFormat)) != formats.end();
+			}
+		}
+
+		uint32_t ProgramBinaryCache::contentKey(const std::vector<Shader*>& shaders) {
+			uint32_t key = 2166136261u;
+			key = hashGLString(key, GL_VENDOR);
+			key = hashGLString(key, GL_RENDERER);
+			key = hashGLString(key, GL_VERSION);
+			key = hashGLString(key, GL_SHADING_LANGUAGE_VERSION);
+			for (const Shader* shader : shaders) {
+				const GLenum type = shader->shaderType();
+				key = hashBytes(key, &type, sizeof(type));
+				key = hashBytes(key, shader->shaderCode().data(), shader->shaderCode().size());
+			}
+			return key;
+		}
+
+		std::string ProgramBinaryCache::cacheFile(const std::vector<std::string>& resources) {
+			std::string name;
+			for (const std::string& resource : resources) {
+				if (name.empty() == false) {
+					name += "+";
+				}
+				name += std::filesystem::path(resource).filename().string();
+			}
+			return std::string(PROGRAM_CACHE_DIRECTORY) + name + ".bin";
+		}
+
+		bool ProgramBinaryCache::load(const std::string& filename, const uint32_t contentKey, const GLuint programId) {
+			std::ifstream input(filename, std::ios::binary);
+			if (!input.is_open()) {
+				return false;
+			}
+			ProgramBinaryHeader header{};
+			input.read(reinterpret_cast<char*>(&header), sizeof(ProgramBinaryHeader));
+			if (!input || header.magic != MAGIC) {
+				std::cerr << filename << ": not a program binary cache file" << std::endl;
+				return false;
+			}
+			if (header.version != VERSION || header.contentKey != contentKey || formatSupported(header.binaryFormat) == false) {
+				return false;
+			}
+			std::vector<char> binary(header.binaryLength);
+			input.read(binary.data(), static_cast<std::streamsize>(binary.size()));
+			if (!input) {
+				std::cerr << filename << ": truncated program binary cache file" << std::endl;
+				return false;
+			}
+
+			// the driver may still reject it (e.g. after an update that kept the version string)
+			glProgramBinary(programId, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+			GLint linked = GL_FALSE;
+			glGetProgramiv(programId, GL_LINK_STATUS, &linked);
+			return linked == GL_TRUE;
+		}
+
+		bool ProgramBinaryCache::store(const std::string& filename, const uint32_t contentKey, const GLuint programId) {
+			GLint binaryLength = 0;
+			glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+			if (binaryLength <= 0) {
+				return false;
+			}
+			std::vector<char> binary(static_cast<size_t>(binaryLength));
+			GLenum binaryFormat = 0u;
+			GLsizei written = 0;
+			glGetProgramBinary(programId, binaryLength, &written, &binaryFormat, binary.data());
+			if (written <= 0) {
+				return false;
+			}
+
+			ProgramBinaryHeader header{};
+			header.magic = MAGIC;
+			header.version = VERSION;
+			header.contentKey = contentKey;
+			header.binaryFormat = binaryFormat;
+			header.binaryLength = static_cast<uint32_t>(written);
+
+			std::error_code error;
+			std::filesystem::create_directories(PROGRAM_CACHE_DIRECTORY, error);
+			// written next to the target and renamed, a reader never sees a half written file
+			const std::string tempFile = filename + ".tmp";
+			std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) {
+				return false;
+			}
+			output.write(reinterpret_cast<const char*>(&header), sizeof(ProgramBinaryHeader));
+			output.write(binary.data(), written);
+			output.close();
+			if (!output) {
+				std::remove(tempFile.c_str());
+				return false;
+			}
+			std::remove(filename.c_str());
+			return std::rename(tempFile.c_str(), filename.c_str()) == 0;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+
+namespace INANOA {
+	namespace OPENGL {
+		class Shader;
+
+		// Linked program binaries (glGetProgramBinary) on disk, one file per program:
+		//   ProgramBinaryHeader
+		//   binary[binaryLength]
+		// A binary is only valid for the driver that produced it, the key covers the driver strings.
+		struct ProgramBinaryHeader {
+			uint32_t magic;
+			uint32_t version;
+			uint32_t contentKey;
+			uint32_t binaryFormat;
+			uint32_t binaryLength;
+			uint32_t reserved;
+		};
+		static_assert(sizeof(ProgramBinaryHeader) == 24, "ProgramBinaryHeader layout");
+
+		class ProgramBinaryCache
+		{
+		public:
+			// "SPRG"
+			static const uint32_t MAGIC = 0x47525053u;
+			static const uint32_t VERSION = 1u;
+
+		public:
+			// hash of the shader types and sources and of the current context's vendor / renderer / version
+			static uint32_t contentKey(const std::vector<Shader*>& shaders);
+			// cache/programs/<file names of the shaders>.bin
+			static std::string cacheFile(const std::vector<std::string>& resources);
+
+			// true when the driver accepted the cached binary and programId is linked; false when the
+			// file is missing, stale or rejected, programId then still takes shaders and a regular link
+			static bool load(const std::string& filename, const uint32_t contentKey, const GLuint programId);
+			// programId must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set
+			static bool store(const std::string& filename, const uint32_t contentKey, const GLuint programId);
+		};
+	}
+}
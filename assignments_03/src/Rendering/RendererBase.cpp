@@ -1,15 +1,9 @@
 #include "RendererBase.h"
 #include "ShaderParameterBindingPoint.h"
 
-#include <glm/gtc/type_ptr.hpp>
-
 namespace INANOA {
 	namespace OPENGL {
-		RendererBase::RendererBase() {
-			this->m_viewMat = glm::mat4x4(1.0f);
-			this->m_projMat = glm::mat4x4(1.0f);
-			this->m_viewPosition = glm::vec4(0.0f);
-		}
+		RendererBase::RendererBase() {}
 		RendererBase::~RendererBase() {}
 
 		bool RendererBase::init(const std::string& vsResource, const std::string& fsResource, const int width, const int height) {
@@ -27,15 +21,6 @@ namespace INANOA {
 			return true;
 		}		
 
-void RendererBase::setCamera(const glm::mat4& projMat, const glm::mat4& viewMat, const glm::vec3& viewOrg) {
-                        this->m_projMat = projMat;
-                        this->m_viewMat = viewMat;
-                        this->m_viewPosition = glm::vec4(viewOrg, 1.0f);
-
-                        glUniformMatrix4fv(SHADER_PARAMETER_BINDING::VIEW_MAT_LOCATION, 1, false, glm::value_ptr(this->m_viewMat));
-                        glUniformMatrix4fv(SHADER_PARAMETER_BINDING::PROJ_MAT_LOCATION, 1, false, glm::value_ptr(this->m_projMat));
-                }
-
                 void RendererBase::bindProgram() const {
                         if (this->m_shaderProgram != nullptr) {
                                 this->m_shaderProgram->useProgram();
@@ -1,7 +1,8 @@
 #pragma once
 
+#include <string>
+
 #include <glad/glad.h>
-#include <glm/mat4x4.hpp>
 
 #include "Shader.h"
 #include "ShaderParameterBindingPoint.h"
@@ -13,6 +14,47 @@ namespace INANOA {
 			UNLIT = 5
 		};
 
+		// debug shading of the foliage meshes (foliage_debug.frag, overdraw_view.frag); every debug view
+		// also counts the foliage fragments per pixel, see OverdrawCounter
+		enum class DebugViewType : int {
+			NONE = 0,
+			// foliage fragments per pixel, summed over every layer
+			OVERDRAW = 1,
+			// hashed color per instance
+			INSTANCE = 2,
+			// color per LOD
+			LOD = 3,
+			// covered / shaded lanes of the 2x2 quads of the pixel's fragments
+			QUAD_OCCUPANCY = 4
+		};
+		constexpr int NUM_DEBUG_VIEWS = 5;
+
+		// command line / benchmark report names
+		inline const char* debugViewName(const DebugViewType view) {
+			switch (view) {
+			case DebugViewType::OVERDRAW:
+				return "overdraw";
+			case DebugViewType::INSTANCE:
+				return "instance";
+			case DebugViewType::LOD:
+				return "lod";
+			case DebugViewType::QUAD_OCCUPANCY:
+				return "quad";
+			default:
+				return "none";
+			}
+		}
+
+		inline bool parseDebugView(const std::string& name, DebugViewType& view) {
+			for (int i = 0; i < NUM_DEBUG_VIEWS; ++i) {
+				if (name == debugViewName(static_cast<DebugViewType>(i))) {
+					view = static_cast<DebugViewType>(i);
+					return true;
+				}
+			}
+			return false;
+		}
+
 		class RendererBase
 		{
 		public:
@@ -27,7 +69,6 @@ namespace INANOA {
                         bool init(const std::string& vsResource, const std::string& fsResource, const int width, const int height);
                         void resize(const int w, const int h);
 
-                        void setCamera(const glm::mat4& projMat, const glm::mat4& viewMat, const glm::vec3& viewOrg);
                         void bindProgram() const;
 
                         void clearRenderTarget();
@@ -44,10 +85,6 @@ namespace INANOA {
 			}
 
 		private:
-			glm::mat4 m_viewMat;
-			glm::mat4 m_projMat;
-			glm::vec4 m_viewPosition;
-
 			int m_frameWidth = 64;
 			int m_frameHeight = 64;
 
@@ -1,4 +1,5 @@
 #include "Shader.h"
+#include "ProgramBinaryCache.h"
 
 #include <iostream>
 #include <fstream>
@@ -50,6 +51,14 @@ namespace INANOA {
 			glDeleteShader(this->m_shaderId);
 		}
 		bool Shader::createShaderFromFile(const std::string& fileFullpath) {
+			if (this->loadShaderFromFile(fileFullpath) == false) {
+				return false;
+			}
+
+			// compile shader
+			return this->compileShader();
+		}
+		bool Shader::loadShaderFromFile(const std::string& fileFullpath) {
 			// read shader code from file
 			std::ifstream inputStream;
 			inputStream.exceptions(std::ifstream::failbit | std::ifstream::badbit);
@@ -71,9 +80,7 @@ namespace INANOA {
 
 			// append shader code
 			this->appendShaderCode(shaderCode);
-
-			// compile shader
-			return this->compileShader();
+			return true;
 		}
 
 
@@ -84,7 +91,11 @@ namespace INANOA {
 			this->m_fsReady = false;
 			this->m_csReady = false;
 		}
-		ShaderProgram::~ShaderProgram() {}
+		ShaderProgram::~ShaderProgram() {
+			if (this->m_programId != 0u) {
+				glDeleteProgram(this->m_programId);
+			}
+		}
 		bool ShaderProgram::init() {
 			this->m_programId = glCreateProgram();
 
@@ -137,70 +148,89 @@ namespace INANOA {
 
 			return this->m_shaderProgramStatus;
 		}
-		void ShaderProgram::linkProgram() {
+		bool ShaderProgram::linkProgram() {
 			if (this->m_shaderProgramStatus != ShaderProgramStatus::READY) {
-				return;
+				this->m_programInfoLog = "missing shader stage";
+				return false;
 			}
 
+			// the binary is fetched for the program binary cache afterwards
+			glProgramParameteri(this->m_programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 			glLinkProgram(this->m_programId);
+
+			GLint linked = GL_FALSE;
+			glGetProgramiv(this->m_programId, GL_LINK_STATUS, &linked);
+			if (linked != GL_TRUE) {
+				char linkError[1024];
+				glGetProgramInfoLog(this->m_programId, 1024, nullptr, linkError);
+				this->m_programInfoLog = linkError;
+				return false;
+			}
+			this->m_programInfoLog = "ready";
+			return true;
 		}
 
 		// ======================================
 		ShaderProgram* ShaderProgram::createShaderProgram(const std::string& vsResource, const std::string& fsResource) {
-			Shader* vsShader = new Shader(GL_VERTEX_SHADER);
-			vsShader->createShaderFromFile(vsResource);
-			if (vsShader->status() != ShaderStatus::READY) {
-				std::cout << "VS: " << vsShader->shaderInfoLog() << "\n";
+			Shader vsShader(GL_VERTEX_SHADER);
+			if (vsShader.loadShaderFromFile(vsResource) == false) {
+				std::cout << "VS: " << vsShader.shaderInfoLog() << "\n";
 				return nullptr;
 			}
 
 			// fragment shader
-			Shader* fsShader = new Shader(GL_FRAGMENT_SHADER);
-			fsShader->createShaderFromFile(fsResource);
-			if (fsShader->status() != ShaderStatus::READY) {
-				std::cout << "FS: " << fsShader->shaderInfoLog() << "\n";
+			Shader fsShader(GL_FRAGMENT_SHADER);
+			if (fsShader.loadShaderFromFile(fsResource) == false) {
+				std::cout << "FS: " << fsShader.shaderInfoLog() << "\n";
 				return nullptr;
 			}
 
-			// shader program
-			ShaderProgram* shaderProgram = new ShaderProgram();
-			shaderProgram->init();
-			shaderProgram->attachShader(vsShader);
-			shaderProgram->attachShader(fsShader);
-			shaderProgram->checkStatus();
-			if (shaderProgram->status() != ShaderProgramStatus::READY) {
-				return nullptr;
-			}
-			shaderProgram->linkProgram();
-
-			delete vsShader;
-			delete fsShader;
-
-			return shaderProgram;
+			return ShaderProgram::createShaderProgramFromShaders({ &vsShader, &fsShader }, { vsResource, fsResource });
 		}
 		ShaderProgram* ShaderProgram::createShaderProgramForComputeShader(const std::string& csResource) {
 			// compute shader
-			Shader* csShader = new Shader(GL_COMPUTE_SHADER);
-			csShader->createShaderFromFile(csResource);
-			if (csShader->status() != ShaderStatus::READY) {
-				std::cout << "CS: " << csShader->shaderInfoLog() << "\n";
+			Shader csShader(GL_COMPUTE_SHADER);
+			if (csShader.loadShaderFromFile(csResource) == false) {
+				std::cout << "CS: " << csShader.shaderInfoLog() << "\n";
 				return nullptr;
 			}
 
-			// shader program
+			return ShaderProgram::createShaderProgramFromShaders({ &csShader }, { csResource });
+		}
+		ShaderProgram* ShaderProgram::createShaderProgramFromShaders(const std::vector<Shader*>& shaders, const std::vector<std::string>& resources) {
 			ShaderProgram* shaderProgram = new ShaderProgram();
-			shaderProgram->init();
-			shaderProgram->attachShader(csShader);
-			shaderProgram->checkStatus();
-			if (shaderProgram->status() != ShaderProgramStatus::READY) {
+			if (shaderProgram->init() == false) {
+				delete shaderProgram;
 				return nullptr;
 			}
-			shaderProgram->linkProgram();
 
-			delete csShader;
+			const uint32_t contentKey = ProgramBinaryCache::contentKey(shaders);
+			const std::string cacheFile = ProgramBinaryCache::cacheFile(resources);
+			if (ProgramBinaryCache::load(cacheFile, contentKey, shaderProgram->programId())) {
+				shaderProgram->m_shaderProgramStatus = ShaderProgramStatus::READY;
+				return shaderProgram;
+			}
+
+			for (size_t i = 0; i < shaders.size(); ++i) {
+				if (shaders[i]->compileShader() == false) {
+					std::cout << resources[i] << ": " << shaders[i]->shaderInfoLog() << "\n";
+					delete shaderProgram;
+					return nullptr;
+				}
+				shaderProgram->attachShader(shaders[i]);
+			}
+			shaderProgram->checkStatus();
+			if (shaderProgram->linkProgram() == false) {
+				std::cout << "Link: " << shaderProgram->programInfoLog() << "\n";
+				delete shaderProgram;
+				return nullptr;
+			}
 
+			// a missing cache only costs the compile on the next start
+			if (ProgramBinaryCache::store(cacheFile, contentKey, shaderProgram->programId()) == false) {
+				std::cerr << "Failed to write program binary cache: " << cacheFile << std::endl;
+			}
 			return shaderProgram;
 		}
 	}
 }
-
@@ -1,8 +1,11 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <glad/glad.h>
 
+#include "GLStateCache.h"
+
 namespace INANOA {
 	namespace OPENGL {
 		enum class ShaderStatus {
@@ -31,6 +34,8 @@ namespace INANOA {
 
 		public:
 			bool createShaderFromFile(const std::string& fileFullpath);
+			// reads the code without compiling it
+			bool loadShaderFromFile(const std::string& fileFullpath);
 			void appendShaderCode(const std::string& code);
 			bool compileShader();
 			void releaseShader();
@@ -40,6 +45,7 @@ namespace INANOA {
 			inline ShaderStatus status() const { return this->m_shaderStatus; }
 			inline GLuint shaderId() const { return this->m_shaderId; }
 			inline GLenum shaderType() const { return this->m_shaderType; }
+			inline const std::string& shaderCode() const { return this->m_shaderCode; }
 
 		private:
 			const GLenum m_shaderType;
@@ -65,14 +71,16 @@ namespace INANOA {
 			bool init();
 			bool attachShader(const Shader* shader);
 			ShaderProgramStatus checkStatus();
-			void linkProgram();
+			// false when the link failed, programInfoLog() has the reason
+			bool linkProgram();
 			
 		public:
-			inline void useProgram(){ glUseProgram(this->m_programId); }
+			inline void useProgram(){ GLStateCache::useProgram(this->m_programId); }
 
 		public:
 			inline GLuint programId() const { return this->m_programId; }
 			inline ShaderProgramStatus status() const { return this->m_shaderProgramStatus; }
+			inline std::string programInfoLog() const { return this->m_programInfoLog; }
 
 		private:
 			GLuint m_programId;
@@ -81,10 +89,16 @@ namespace INANOA {
 			bool m_csReady = false;
 
 			ShaderProgramStatus m_shaderProgramStatus;
+			std::string m_programInfoLog;
 
 		public:
 			static ShaderProgram* createShaderProgram(const std::string& vsResource, const std::string& fsResource);
 			static ShaderProgram* createShaderProgramForComputeShader(const std::string& csResource);
+
+		private:
+			// linked from the program binary cache when it has an up to date binary, compiled and
+			// linked (and cached) otherwise; the shaders only need their code loaded
+			static ShaderProgram* createShaderProgramFromShaders(const std::vector<Shader*>& shaders, const std::vector<std::string>& resources);
 		};
 	}
 	
@@ -7,8 +7,6 @@ namespace INANOA {
 		const GLuint VERTEX_LOCATION = 0;
 
 		const GLint MODEL_MAT_LOCATION = 0;
-		const GLint VIEW_MAT_LOCATION = 1;
-		const GLint PROJ_MAT_LOCATION = 2;
 		const GLint SHADING_MODEL_ID_LOCATION = 5;
 	}
 }
@@ -0,0 +1,109 @@
+#include "AssetLoader.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace INANOA {
+	namespace SCENE {
+		AssetLoader::AssetLoader() {}
+		AssetLoader::~AssetLoader() {
+			this->shutdown();
+		}
+
+		bool AssetLoader::init(const int numThreads) {
+			this->m_quit = false;
+			for (int i = 0; i < std::max(numThreads, 1); ++i) {
+				this->m_workers.push_back(std::thread(&AssetLoader::workerLoop, this));
+			}
+			return true;
+		}
+
+		void AssetLoader::shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				this->m_quit = true;
+				this->m_jobs.clear();
+			}
+			this->m_workAvailable.notify_all();
+			for (std::thread& worker : this->m_workers) {
+				if (worker.joinable()) {
+					worker.join();
+				}
+			}
+			this->m_workers.clear();
+			this->m_uploads.clear();
+		}
+
+		void AssetLoader::submit(const Step& work, const Step& upload) {
+			Job job;
+			job.work = work;
+			job.upload = upload;
+			this->m_submittedJobs++;
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				if (work) {
+					this->m_jobs.push_back(job);
+				}
+				else {
+					this->m_uploads.push_back(job);
+				}
+			}
+			if (work) {
+				this->m_workAvailable.notify_one();
+			}
+		}
+
+		void AssetLoader::workerLoop() {
+			while (true) {
+				Job job;
+				{
+					std::unique_lock<std::mutex> lock(this->m_mutex);
+					this->m_workAvailable.wait(lock, [this]() { return this->m_quit || this->m_jobs.empty() == false; });
+					if (this->m_quit) {
+						return;
+					}
+					job = this->m_jobs.front();
+					this->m_jobs.pop_front();
+				}
+				job.work();
+				{
+					std::lock_guard<std::mutex> lock(this->m_mutex);
+					this->m_uploads.push_back(job);
+				}
+				this->m_uploadAvailable.notify_all();
+			}
+		}
+
+		void AssetLoader::pumpUploads(const double budgetMs) {
+			const auto start = std::chrono::steady_clock::now();
+			while (true) {
+				Job job;
+				{
+					std::lock_guard<std::mutex> lock(this->m_mutex);
+					if (this->m_uploads.empty()) {
+						return;
+					}
+					job = this->m_uploads.front();
+					this->m_uploads.pop_front();
+				}
+				if (job.upload) {
+					job.upload();
+				}
+				this->m_completedJobs++;
+				if (std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budgetMs) {
+					return;
+				}
+			}
+		}
+
+		void AssetLoader::finish() {
+			while (this->idle() == false) {
+				{
+					std::unique_lock<std::mutex> lock(this->m_mutex);
+					this->m_uploadAvailable.wait(lock, [this]() { return this->m_uploads.empty() == false; });
+				}
+				this->pumpUploads(0.0);
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// Job based asset loading. The work of a job (file reads, parsing, decoding into CPU memory)
+		// runs on a pool of worker threads; its upload step is handed back to the GL thread, which
+		// runs the finished uploads from pumpUploads() within a time budget, so the uploads of a
+		// large scene are spread over several frames. An upload may submit further jobs (e.g. the
+		// next stage once all of its inputs are there).
+		class AssetLoader
+		{
+		public:
+			typedef std::function<void()> Step;
+
+			explicit AssetLoader();
+			virtual ~AssetLoader();
+
+			AssetLoader(const AssetLoader&) = delete;
+			AssetLoader& operator=(const AssetLoader&) = delete;
+
+		public:
+			bool init(const int numThreads);
+			// drops the jobs that have not started, waits for the running ones
+			void shutdown();
+
+			// work runs on a worker, then upload on the GL thread; either may be empty
+			void submit(const Step& work, const Step& upload);
+
+			// GL thread: runs finished uploads until budgetMs is spent (at least one when there is one)
+			void pumpUploads(const double budgetMs);
+			// GL thread: runs everything submitted so far, including the jobs the uploads submit
+			void finish();
+
+		public:
+			// jobs whose upload has run / jobs submitted
+			inline int completedJobs() const { return this->m_completedJobs; }
+			inline int submittedJobs() const { return this->m_submittedJobs; }
+			inline bool idle() const { return this->m_completedJobs == this->m_submittedJobs; }
+
+		private:
+			struct Job {
+				Step work;
+				Step upload;
+			};
+
+		private:
+			void workerLoop();
+
+		private:
+			std::vector<std::thread> m_workers;
+			std::mutex m_mutex;
+			std::condition_variable m_workAvailable;
+			std::condition_variable m_uploadAvailable;
+			std::deque<Job> m_jobs;
+			std::deque<Job> m_uploads;
+			bool m_quit = false;
+
+			// GL thread only
+			int m_submittedJobs = 0;
+			int m_completedJobs = 0;
+		};
+	}
+}
@@ -0,0 +1,160 @@
+#include "FoliageCatalog.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace INANOA {
+	namespace SCENE {
+		namespace {
+			struct SpeciesEntry {
+				FoliageSpecies species;
+				std::string meshFile;
+				std::string textureFile;
+				std::vector<float> keepRatios;
+				int line = 0;
+			};
+
+			// index of value in values, appended when it is not there yet
+			template <typename T>
+			uint32_t findOrAppend(std::vector<T>& values, const T& value) {
+				const auto it = std::find(values.begin(), values.end(), value);
+				if (it != values.end()) {
+					return static_cast<uint32_t>(it - values.begin());
+				}
+				values.push_back(value);
+				return static_cast<uint32_t>(values.size() - 1);
+			}
+		}
+
+		bool operator==(const FoliageGeometry& a, const FoliageGeometry& b) {
+			return a.meshFile == b.meshFile && a.keepRatios == b.keepRatios;
+		}
+
+		FoliageCatalog::FoliageCatalog() {}
+		FoliageCatalog::~FoliageCatalog() {}
+
+		bool FoliageCatalog::load(const std::string& filename) {
+			this->clear();
+			std::ifstream input(filename);
+			if (!input.is_open()) {
+				std::cerr << "Failed to open foliage catalog: " << filename << std::endl;
+				return false;
+			}
+
+			std::vector<SpeciesEntry> entries;
+			std::string line;
+			int lineNumber = 0;
+			while (std::getline(input, line)) {
+				lineNumber++;
+				const size_t comment = line.find('#');
+				if (comment != std::string::npos) {
+					line.erase(comment);
+				}
+				std::istringstream lineStream(line);
+				std::string key;
+				if (!(lineStream >> key)) {
+					continue;
+				}
+				const auto fail = [&](const char* message) {
+					std::cerr << filename << ":" << lineNumber << ": " << message << std::endl;
+					return false;
+				};
+
+				if (key == "species") {
+					SpeciesEntry entry;
+					entry.line = lineNumber;
+					if (!(lineStream >> entry.species.name)) {
+						return fail("species without a name");
+					}
+					entries.push_back(entry);
+					continue;
+				}
+				if (entries.empty()) {
+					return fail("expected \"species <name>\" first");
+				}
+				SpeciesEntry& entry = entries.back();
+				if (key == "mesh") {
+					lineStream >> entry.meshFile;
+				}
+				else if (key == "texture") {
+					lineStream >> entry.textureFile;
+				}
+				else if (key == "samples") {
+					lineStream >> entry.species.sampleFile;
+				}
+				else if (key == "density") {
+					lineStream >> entry.species.density;
+				}
+				else if (key == "scale_jitter") {
+					lineStream >> entry.species.scaleJitter;
+				}
+				else if (key == "cull_distance") {
+					lineStream >> entry.species.cullDistance;
+				}
+				else if (key == "impostor") {
+					lineStream >> entry.species.impostorDistance >> entry.species.impostorCrossfade;
+					if (lineStream.fail() == false && (entry.species.impostorDistance <= 0.0f || entry.species.impostorCrossfade < 0.0f)) {
+						return fail("impostor distance must be positive, the crossfade not negative");
+					}
+				}
+				else if (key == "lod") {
+					float keepRatio = 0.0f;
+					float maxDistance = 0.0f;
+					lineStream >> keepRatio >> maxDistance;
+					if (keepRatio <= 0.0f || keepRatio > 1.0f) {
+						return fail("lod keep ratio must be in (0, 1]");
+					}
+					entry.keepRatios.push_back(keepRatio);
+					entry.species.lodDistances.push_back(maxDistance);
+				}
+				else {
+					return fail("unknown key");
+				}
+				if (lineStream.fail()) {
+					return fail("missing or malformed value");
+				}
+			}
+
+			for (SpeciesEntry& entry : entries) {
+				const auto fail = [&](const char* message) {
+					std::cerr << filename << ":" << entry.line << ": species " << entry.species.name << ": " << message << std::endl;
+					this->clear();
+					return false;
+				};
+				if (entry.meshFile.empty() || entry.textureFile.empty() || entry.species.sampleFile.empty()) {
+					return fail("mesh, texture and samples are required");
+				}
+				if (entry.keepRatios.size() > MAX_LODS) {
+					return fail("too many LODs");
+				}
+				if (entry.keepRatios.empty()) {
+					entry.keepRatios.push_back(1.0f);
+					entry.species.lodDistances.push_back(0.0f);
+				}
+				entry.species.density = std::clamp(entry.species.density, 0.0f, 1.0f);
+
+				FoliageGeometry geometry;
+				geometry.meshFile = entry.meshFile;
+				geometry.keepRatios = entry.keepRatios;
+				entry.species.geometry = findOrAppend(this->m_geometries, geometry);
+				entry.species.textureLayer = findOrAppend(this->m_textures, entry.textureFile);
+				if (this->m_textures.size() > MAX_TEXTURES) {
+					return fail("too many textures");
+				}
+				this->m_species.push_back(entry.species);
+				if (this->m_species.size() > MAX_SPECIES) {
+					return fail("too many species");
+				}
+			}
+			return true;
+		}
+
+		void FoliageCatalog::clear() {
+			this->m_species.clear();
+			this->m_geometries.clear();
+			this->m_textures.clear();
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// mesh file + LOD keep ratios, loaded once however many species use it
+		struct FoliageGeometry {
+			std::string meshFile;
+			std::vector<float> keepRatios;
+		};
+
+		struct FoliageSpecies {
+			std::string name;
+			// index into FoliageCatalog::geometries()
+			uint32_t geometry = 0u;
+			// layer of the foliage texture array, index into FoliageCatalog::textures()
+			uint32_t textureLayer = 0u;
+			// v1 sample set the instances are placed from
+			std::string sampleFile;
+			// fraction of the samples that get an instance
+			float density = 1.0f;
+			// instances are scaled by 1 +- scaleJitter
+			float scaleJitter = 0.0f;
+			// camera distance up to which each LOD is used, the last LOD has no limit
+			std::vector<float> lodDistances;
+			// instances farther from the camera are culled, 0: only the far plane culls them
+			float cullDistance = 0.0f;
+			// instances farther than this are drawn as octahedral impostors, 0: never
+			float impostorDistance = 0.0f;
+			// distance over which the meshes dissolve into the impostors, past impostorDistance
+			float impostorCrossfade = 0.0f;
+		};
+
+		// Foliage species of the scene, read from a text file:
+		//   species <name>
+		//   mesh <obj file>
+		//   texture <image file>
+		//   samples <ss2 file>
+		//   density <fraction>               optional, 1
+		//   scale_jitter <j>                 optional, 0
+		//   lod <keep ratio> <max distance>  one line per LOD, optional (a single full LOD)
+		//   cull_distance <d>                optional, 0
+		//   impostor <distance> <crossfade>  optional, no impostor
+		// The lines after "species" describe that species, '#' starts a comment. Species sharing a mesh
+		// (and its LOD keep ratios) share its geometry, species sharing an image share its texture layer.
+		class FoliageCatalog
+		{
+		public:
+			// mesh ids and texture layers of the packed instances are 8 bit
+			static const size_t MAX_SPECIES = 256u;
+			static const size_t MAX_TEXTURES = 256u;
+			// must match MAX_LODS in foliage_cull.comp
+			static const size_t MAX_LODS = 4u;
+
+		public:
+			explicit FoliageCatalog();
+			virtual ~FoliageCatalog();
+
+		public:
+			// false (and an empty catalog) when the file is missing or malformed
+			bool load(const std::string& filename);
+			void clear();
+
+		public:
+			inline const std::vector<FoliageSpecies>& species() const { return this->m_species; }
+			inline const std::vector<FoliageGeometry>& geometries() const { return this->m_geometries; }
+			// image files in layer order
+			inline const std::vector<std::string>& textures() const { return this->m_textures; }
+
+		private:
+			std::vector<FoliageSpecies> m_species;
+			std::vector<FoliageGeometry> m_geometries;
+			std::vector<std::string> m_textures;
+		};
+	}
+}
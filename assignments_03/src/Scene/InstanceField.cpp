@@ -0,0 +1,122 @@
+#include "InstanceField.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace INANOA {
+	namespace SCENE {
+		namespace {
+			uint64_t align16(const uint64_t offset) {
+				return (offset + 15u) & ~static_cast<uint64_t>(15u);
+			}
+
+			// the tile's chunks and records lie in their sections, the chunks' records in the tile's
+			bool validTile(const InstanceFieldTile& tile, const InstanceFieldChunk* chunks, const InstanceFieldHeader& header) {
+				const uint64_t tileRecordsEnd = static_cast<uint64_t>(tile.firstRecord) + tile.numRecords;
+				if (static_cast<uint64_t>(tile.firstChunk) + tile.numChunks > header.numChunks || tileRecordsEnd > header.numInstances) {
+					return false;
+				}
+				for (uint32_t c = 0u; c < tile.numChunks; ++c) {
+					const InstanceFieldChunk& chunk = chunks[tile.firstChunk + c];
+					if (chunk.first < tile.firstRecord || static_cast<uint64_t>(chunk.first) + chunk.count > tileRecordsEnd) {
+						return false;
+					}
+				}
+				return true;
+			}
+		}
+
+		InstanceField::InstanceField() {}
+		InstanceField::~InstanceField() {}
+
+		bool InstanceField::open(const std::string& filename) {
+			this->m_header = nullptr;
+			if (this->m_file.open(filename) == false) {
+				return false;
+			}
+			const unsigned char* base = this->m_file.data();
+			const uint64_t fileSize = this->m_file.size();
+			if (fileSize < sizeof(InstanceFieldHeader)) {
+				std::cerr << filename << ": truncated header" << std::endl;
+				this->m_file.close();
+				return false;
+			}
+			const InstanceFieldHeader* header = reinterpret_cast<const InstanceFieldHeader*>(base);
+			if (header->magic != MAGIC || header->version != VERSION) {
+				std::cerr << filename << ": not an SS2 v" << VERSION << " instance field" << std::endl;
+				this->m_file.close();
+				return false;
+			}
+			const uint64_t countsEnd = sizeof(InstanceFieldHeader) + static_cast<uint64_t>(header->numMeshes) * sizeof(uint32_t);
+			const uint64_t chunksEnd = header->chunkOffset + static_cast<uint64_t>(header->numChunks) * sizeof(InstanceFieldChunk);
+			const uint64_t recordsEnd = header->recordOffset + static_cast<uint64_t>(header->numInstances) * header->recordStride;
+			const uint64_t tilesEnd = header->tileOffset + static_cast<uint64_t>(header->numTiles) * sizeof(InstanceFieldTile);
+			const uint64_t tileMeshCountsEnd = header->tileMeshCountOffset + static_cast<uint64_t>(header->numTiles) * header->numMeshes * sizeof(uint32_t);
+			const bool aligned = (header->chunkOffset | header->recordOffset | header->tileOffset | header->tileMeshCountOffset) % 16u == 0u;
+			if (aligned == false || header->chunkOffset < countsEnd || header->recordOffset < chunksEnd || header->tileOffset < recordsEnd || header->tileMeshCountOffset < tilesEnd || tileMeshCountsEnd > fileSize) {
+				std::cerr << filename << ": corrupt section offsets" << std::endl;
+				this->m_file.close();
+				return false;
+			}
+			// the streamer copies whole tiles without further checks
+			const InstanceFieldTile* tiles = reinterpret_cast<const InstanceFieldTile*>(base + header->tileOffset);
+			const InstanceFieldChunk* chunks = reinterpret_cast<const InstanceFieldChunk*>(base + header->chunkOffset);
+			for (uint32_t t = 0u; t < header->numTiles; ++t) {
+				if (validTile(tiles[t], chunks, *header) == false) {
+					std::cerr << filename << ": corrupt tile " << t << std::endl;
+					this->m_file.close();
+					return false;
+				}
+			}
+
+			this->m_header = header;
+			this->m_meshInstanceCounts = reinterpret_cast<const uint32_t*>(base + sizeof(InstanceFieldHeader));
+			this->m_chunks = reinterpret_cast<const InstanceFieldChunk*>(base + header->chunkOffset);
+			this->m_records = base + header->recordOffset;
+			this->m_tiles = reinterpret_cast<const InstanceFieldTile*>(base + header->tileOffset);
+			this->m_tileMeshCounts = reinterpret_cast<const uint32_t*>(base + header->tileMeshCountOffset);
+			return true;
+		}
+
+		bool InstanceField::write(const std::string& filename, const InstanceFieldHeader& header, const uint32_t* meshInstanceCounts, const InstanceFieldChunk* chunks, const void* records, const InstanceFieldTile* tiles, const uint32_t* tileMeshCounts) {
+			InstanceFieldHeader fileHeader = header;
+			fileHeader.magic = MAGIC;
+			fileHeader.version = VERSION;
+			const uint64_t countBytes = static_cast<uint64_t>(header.numMeshes) * sizeof(uint32_t);
+			const uint64_t chunkBytes = static_cast<uint64_t>(header.numChunks) * sizeof(InstanceFieldChunk);
+			const uint64_t recordBytes = static_cast<uint64_t>(header.numInstances) * header.recordStride;
+			const uint64_t tileBytes = static_cast<uint64_t>(header.numTiles) * sizeof(InstanceFieldTile);
+			const uint64_t tileMeshCountBytes = static_cast<uint64_t>(header.numTiles) * header.numMeshes * sizeof(uint32_t);
+			fileHeader.chunkOffset = align16(sizeof(InstanceFieldHeader) + countBytes);
+			fileHeader.recordOffset = align16(fileHeader.chunkOffset + chunkBytes);
+			fileHeader.tileOffset = align16(fileHeader.recordOffset + recordBytes);
+			fileHeader.tileMeshCountOffset = align16(fileHeader.tileOffset + tileBytes);
+
+			// written next to the target and renamed, a reader never maps a half written file
+			const std::string tempFile = filename + ".tmp";
+			std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) {
+				return false;
+			}
+			const char padding[16] = {};
+			const auto section = [&](const uint64_t offset, const void* data, const uint64_t size) {
+				output.write(padding, static_cast<std::streamsize>(offset - static_cast<uint64_t>(output.tellp())));
+				output.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+			};
+			output.write(reinterpret_cast<const char*>(&fileHeader), sizeof(InstanceFieldHeader));
+			section(sizeof(InstanceFieldHeader), meshInstanceCounts, countBytes);
+			section(fileHeader.chunkOffset, chunks, chunkBytes);
+			section(fileHeader.recordOffset, records, recordBytes);
+			section(fileHeader.tileOffset, tiles, tileBytes);
+			section(fileHeader.tileMeshCountOffset, tileMeshCounts, tileMeshCountBytes);
+			output.close();
+			if (!output) {
+				std::remove(tempFile.c_str());
+				return false;
+			}
+			std::remove(filename.c_str());
+			return std::rename(tempFile.c_str(), filename.c_str()) == 0;
+		}
+	}
+}
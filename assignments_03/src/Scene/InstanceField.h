@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "MappedFile.h"
+
+namespace INANOA {
+	namespace SCENE {
+		// SS2 v2: a foliage field already laid out like the GPU culling buffers.
+		//   InstanceFieldHeader
+		//   uint32_t meshInstanceCounts[numMeshes]
+		//   InstanceFieldChunk chunks[numChunks]      at chunkOffset, same layout as the instance cells
+		//   records[numInstances * recordStride]       at recordOffset, chunk i owns records [first, first + count)
+		//   InstanceFieldTile tiles[numTiles]          at tileOffset, tile i owns a run of chunks and their records
+		//   uint32_t tileMeshCounts[numTiles * numMeshes] at tileMeshCountOffset
+		// Sections start on 16 byte boundaries, every value is little endian. v1 .ss2 files (int count
+		// followed by position + radians floats) are still read by SpatialSample.
+		struct InstanceFieldHeader {
+			uint32_t magic;
+			uint32_t version;
+			// hash of whatever the records were built from, a stale file is rebuilt
+			uint32_t contentKey;
+			uint32_t numMeshes;
+			uint32_t numChunks;
+			uint32_t numInstances;
+			uint32_t recordStride;
+			uint32_t numTiles;
+			uint64_t chunkOffset;
+			uint64_t recordOffset;
+			uint64_t tileOffset;
+			uint64_t tileMeshCountOffset;
+			float boundsMin[4];
+			float boundsMax[4];
+		};
+		static_assert(sizeof(InstanceFieldHeader) == 96, "InstanceFieldHeader layout");
+
+		struct InstanceFieldChunk {
+			float boundsMin[4];
+			float boundsMax[4];
+			uint32_t first;
+			uint32_t count;
+			uint32_t reserved[2];
+		};
+		static_assert(sizeof(InstanceFieldChunk) == 48, "InstanceFieldChunk layout");
+
+		// spatial tile, the unit of streaming
+		struct InstanceFieldTile {
+			float boundsMin[4];
+			float boundsMax[4];
+			uint32_t firstChunk;
+			uint32_t numChunks;
+			uint32_t firstRecord;
+			uint32_t numRecords;
+		};
+		static_assert(sizeof(InstanceFieldTile) == 48, "InstanceFieldTile layout");
+
+		class InstanceField
+		{
+		public:
+			// "SS2F"; read as the int count of a v1 file it is far beyond any sample count
+			static const uint32_t MAGIC = 0x46325353u;
+			static const uint32_t VERSION = 2u;
+
+		public:
+			explicit InstanceField();
+			virtual ~InstanceField();
+
+			InstanceField(const InstanceField&) = delete;
+			InstanceField& operator=(const InstanceField&) = delete;
+
+		public:
+			// maps the file and validates the header, the section sizes and the tile table, nothing is copied
+			bool open(const std::string& filename);
+
+			// header.magic, version and the offsets are filled in
+			static bool write(const std::string& filename, const InstanceFieldHeader& header, const uint32_t* meshInstanceCounts, const InstanceFieldChunk* chunks, const void* records, const InstanceFieldTile* tiles, const uint32_t* tileMeshCounts);
+
+		public:
+			inline const InstanceFieldHeader& header() const { return *this->m_header; }
+			inline const uint32_t* meshInstanceCounts() const { return this->m_meshInstanceCounts; }
+			inline const InstanceFieldChunk* chunks() const { return this->m_chunks; }
+			inline const unsigned char* records() const { return this->m_records; }
+			inline const InstanceFieldTile* tiles() const { return this->m_tiles; }
+			// numMeshes counts per tile
+			inline const uint32_t* tileMeshCounts() const { return this->m_tileMeshCounts; }
+			inline size_t recordBytes() const { return static_cast<size_t>(this->m_header->numInstances) * this->m_header->recordStride; }
+
+		private:
+			MappedFile m_file;
+			const InstanceFieldHeader* m_header = nullptr;
+			const uint32_t* m_meshInstanceCounts = nullptr;
+			const InstanceFieldChunk* m_chunks = nullptr;
+			const unsigned char* m_records = nullptr;
+			const InstanceFieldTile* m_tiles = nullptr;
+			const uint32_t* m_tileMeshCounts = nullptr;
+		};
+	}
+}
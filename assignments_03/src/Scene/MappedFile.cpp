@@ -0,0 +1,101 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace INANOA {
+	namespace SCENE {
+		MappedFile::MappedFile() {}
+		MappedFile::~MappedFile() {
+			this->close();
+		}
+
+#ifdef _WIN32
+		bool MappedFile::open(const std::string& filename) {
+			this->close();
+			HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (file == INVALID_HANDLE_VALUE) {
+				return false;
+			}
+			LARGE_INTEGER fileSize;
+			if (GetFileSizeEx(file, &fileSize) == FALSE || fileSize.QuadPart == 0) {
+				CloseHandle(file);
+				return false;
+			}
+			HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping == nullptr) {
+				CloseHandle(file);
+				return false;
+			}
+			const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (view == nullptr) {
+				CloseHandle(mapping);
+				CloseHandle(file);
+				return false;
+			}
+			this->m_fileHandle = file;
+			this->m_mappingHandle = mapping;
+			this->m_data = static_cast<const unsigned char*>(view);
+			this->m_size = static_cast<size_t>(fileSize.QuadPart);
+			return true;
+		}
+
+		void MappedFile::close() {
+			if (this->m_data != nullptr) {
+				UnmapViewOfFile(this->m_data);
+			}
+			if (this->m_mappingHandle != nullptr) {
+				CloseHandle(this->m_mappingHandle);
+			}
+			if (this->m_fileHandle != nullptr) {
+				CloseHandle(this->m_fileHandle);
+			}
+			this->m_data = nullptr;
+			this->m_size = 0u;
+			this->m_mappingHandle = nullptr;
+			this->m_fileHandle = nullptr;
+		}
+#else
+		bool MappedFile::open(const std::string& filename) {
+			this->close();
+			const int fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0) {
+				return false;
+			}
+			struct stat fileStat;
+			if (fstat(fd, &fileStat) != 0 || fileStat.st_size == 0) {
+				::close(fd);
+				return false;
+			}
+			void* view = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+			// the mapping keeps its own reference to the file
+			::close(fd);
+			if (view == MAP_FAILED) {
+				return false;
+			}
+			// read front to back once, let the kernel read ahead
+			madvise(view, static_cast<size_t>(fileStat.st_size), MADV_SEQUENTIAL);
+			this->m_data = static_cast<const unsigned char*>(view);
+			this->m_size = static_cast<size_t>(fileStat.st_size);
+			return true;
+		}
+
+		void MappedFile::close() {
+			if (this->m_data != nullptr) {
+				munmap(const_cast<unsigned char*>(this->m_data), this->m_size);
+			}
+			this->m_data = nullptr;
+			this->m_size = 0u;
+		}
+#endif
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace INANOA {
+	namespace SCENE {
+		// Read-only memory mapping of a whole file (mmap / MapViewOfFile). The pages are only read
+		// from disk when touched, nothing is copied into the process heap.
+		class MappedFile
+		{
+		public:
+			explicit MappedFile();
+			virtual ~MappedFile();
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+		public:
+			bool open(const std::string& filename);
+			void close();
+
+		public:
+			inline const unsigned char* data() const { return this->m_data; }
+			inline size_t size() const { return this->m_size; }
+			inline bool isOpen() const { return this->m_data != nullptr; }
+
+		private:
+			const unsigned char* m_data = nullptr;
+			size_t m_size = 0u;
+#ifdef _WIN32
+			void* m_fileHandle = nullptr;
+			void* m_mappingHandle = nullptr;
+#endif
+		};
+	}
+}
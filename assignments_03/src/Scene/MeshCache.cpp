@@ -0,0 +1,82 @@
+#include "MeshCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace INANOA {
+	namespace SCENE {
+		bool MeshCache::read(const std::string& filename, const uint32_t contentKey, const uint32_t vertexStride, MeshCacheData& data) {
+			std::ifstream input(filename, std::ios::binary);
+			if (!input.is_open()) {
+				return false;
+			}
+			MeshCacheHeader header{};
+			input.read(reinterpret_cast<char*>(&header), sizeof(MeshCacheHeader));
+			if (!input || header.magic != MAGIC) {
+				std::cerr << filename << ": not a mesh cache file" << std::endl;
+				return false;
+			}
+			if (header.version != VERSION || header.contentKey != contentKey || header.vertexStride != vertexStride) {
+				return false;
+			}
+
+			data.vertexStride = header.vertexStride;
+			std::memcpy(data.boundingSphere, header.boundingSphere, sizeof(data.boundingSphere));
+			data.lods.resize(header.numLods);
+			data.vertices.resize(static_cast<size_t>(header.numVertices) * header.vertexStride);
+			data.indices.resize(header.numIndices);
+			input.read(reinterpret_cast<char*>(data.lods.data()), static_cast<std::streamsize>(data.lods.size() * sizeof(MeshCacheLod)));
+			input.read(reinterpret_cast<char*>(data.vertices.data()), static_cast<std::streamsize>(data.vertices.size()));
+			input.read(reinterpret_cast<char*>(data.indices.data()), static_cast<std::streamsize>(data.indices.size() * sizeof(uint32_t)));
+			if (!input) {
+				std::cerr << filename << ": truncated mesh cache file" << std::endl;
+				return false;
+			}
+			for (const MeshCacheLod& lod : data.lods) {
+				if (static_cast<uint64_t>(lod.firstIndex) + lod.indexCount > header.numIndices) {
+					std::cerr << filename << ": corrupt LOD range" << std::endl;
+					return false;
+				}
+			}
+			for (const uint32_t index : data.indices) {
+				if (index >= header.numVertices) {
+					std::cerr << filename << ": corrupt index" << std::endl;
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool MeshCache::write(const std::string& filename, const uint32_t contentKey, const MeshCacheData& data) {
+			MeshCacheHeader header{};
+			header.magic = MAGIC;
+			header.version = VERSION;
+			header.contentKey = contentKey;
+			header.vertexStride = data.vertexStride;
+			header.numVertices = data.vertexStride > 0u ? static_cast<uint32_t>(data.vertices.size() / data.vertexStride) : 0u;
+			header.numIndices = static_cast<uint32_t>(data.indices.size());
+			header.numLods = static_cast<uint32_t>(data.lods.size());
+			std::memcpy(header.boundingSphere, data.boundingSphere, sizeof(header.boundingSphere));
+
+			// written next to the target and renamed, a reader never sees a half written file
+			const std::string tempFile = filename + ".tmp";
+			std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) {
+				return false;
+			}
+			output.write(reinterpret_cast<const char*>(&header), sizeof(MeshCacheHeader));
+			output.write(reinterpret_cast<const char*>(data.lods.data()), static_cast<std::streamsize>(data.lods.size() * sizeof(MeshCacheLod)));
+			output.write(reinterpret_cast<const char*>(data.vertices.data()), static_cast<std::streamsize>(data.vertices.size()));
+			output.write(reinterpret_cast<const char*>(data.indices.data()), static_cast<std::streamsize>(data.indices.size() * sizeof(uint32_t)));
+			output.close();
+			if (!output) {
+				std::remove(tempFile.c_str());
+				return false;
+			}
+			std::remove(filename.c_str());
+			return std::rename(tempFile.c_str(), filename.c_str()) == 0;
+		}
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// Processed mesh (welded, cache optimized, quantized vertices) as the GPU buffers want it.
+		//   MeshCacheHeader
+		//   MeshCacheLod lods[numLods]
+		//   vertices[numVertices * vertexStride]
+		//   uint32_t indices[numIndices]
+		// Every value is little endian.
+		struct MeshCacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			// hash of the source file and the processing parameters, a stale file is rebuilt
+			uint32_t contentKey;
+			uint32_t vertexStride;
+			uint32_t numVertices;
+			uint32_t numIndices;
+			uint32_t numLods;
+			uint32_t reserved;
+			// mesh space bounding sphere (xyz center, w radius) of the source vertices
+			float boundingSphere[4];
+		};
+		static_assert(sizeof(MeshCacheHeader) == 48, "MeshCacheHeader layout");
+
+		struct MeshCacheLod {
+			uint32_t firstIndex;
+			uint32_t indexCount;
+		};
+
+		struct MeshCacheData {
+			uint32_t vertexStride = 0u;
+			float boundingSphere[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			std::vector<MeshCacheLod> lods;
+			std::vector<unsigned char> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		class MeshCache
+		{
+		public:
+			// "SMSH"
+			static const uint32_t MAGIC = 0x48534D53u;
+			static const uint32_t VERSION = 1u;
+
+		public:
+			// false when the file is missing, stale (other contentKey / vertexStride) or corrupt
+			static bool read(const std::string& filename, const uint32_t contentKey, const uint32_t vertexStride, MeshCacheData& data);
+			static bool write(const std::string& filename, const uint32_t contentKey, const MeshCacheData& data);
+		};
+	}
+}
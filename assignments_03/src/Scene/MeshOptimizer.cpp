@@ -0,0 +1,217 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace INANOA {
+	namespace SCENE {
+		namespace MeshOptimizer {
+			namespace {
+				// LRU cache model of the vertex cache optimization and the weights of Forsyth's paper
+				constexpr int CACHE_SIZE = 32;
+				constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+				constexpr float CACHE_DECAY_POWER = 1.5f;
+				constexpr float VALENCE_BOOST_SCALE = 2.0f;
+				constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+				uint32_t hashVertex(const unsigned char* bytes, const size_t size) {
+					// FNV-1a
+					uint32_t hash = 2166136261u;
+					for (size_t i = 0; i < size; ++i) {
+						hash = (hash ^ bytes[i]) * 16777619u;
+					}
+					return hash;
+				}
+
+				float vertexScore(const int cachePosition, const uint32_t remainingTriangles) {
+					if (remainingTriangles == 0u) {
+						// no triangle left that could use it
+						return -1.0f;
+					}
+					float score = 0.0f;
+					if (cachePosition >= 0) {
+						// the vertices of the last triangle get a fixed score so it is not simply repeated
+						if (cachePosition < 3) {
+							score = LAST_TRIANGLE_SCORE;
+						}
+						else {
+							const float scaler = 1.0f / static_cast<float>(CACHE_SIZE - 3);
+							score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+						}
+					}
+					// vertices with few triangles left are finished first, they would be reloaded later otherwise
+					score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingTriangles), -VALENCE_BOOST_POWER);
+					return score;
+				}
+			}
+
+			size_t weldVertices(const void* vertices, const size_t vertexCount, const size_t vertexStride, std::vector<uint32_t>& remap) {
+				const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+				remap.assign(vertexCount, UINT32_MAX);
+
+				// open addressing, at most half full; entries are indices of the first occurrences
+				size_t tableSize = 1u;
+				while (tableSize < vertexCount * 2u) {
+					tableSize *= 2u;
+				}
+				std::vector<uint32_t> table(tableSize, UINT32_MAX);
+				uint32_t numUnique = 0u;
+				for (size_t v = 0; v < vertexCount; ++v) {
+					const unsigned char* vertex = bytes + v * vertexStride;
+					size_t slot = hashVertex(vertex, vertexStride) & (tableSize - 1u);
+					while (table[slot] != UINT32_MAX && std::memcmp(bytes + static_cast<size_t>(table[slot]) * vertexStride, vertex, vertexStride) != 0) {
+						slot = (slot + 1u) & (tableSize - 1u);
+					}
+					if (table[slot] == UINT32_MAX) {
+						table[slot] = static_cast<uint32_t>(v);
+						remap[v] = numUnique++;
+					}
+					else {
+						remap[v] = remap[table[slot]];
+					}
+				}
+				return numUnique;
+			}
+
+			void optimizeVertexCache(uint32_t* indices, const size_t indexCount, const size_t vertexCount) {
+				const size_t numTriangles = indexCount / 3u;
+				if (numTriangles == 0u) {
+					return;
+				}
+
+				// triangles of every vertex (CSR); the first remaining[v] entries are the ones not emitted yet
+				std::vector<uint32_t> remaining(vertexCount, 0u);
+				for (size_t i = 0; i < numTriangles * 3u; ++i) {
+					remaining[indices[i]]++;
+				}
+				std::vector<uint32_t> adjacencyOffsets(vertexCount + 1u, 0u);
+				for (size_t v = 0; v < vertexCount; ++v) {
+					adjacencyOffsets[v + 1u] = adjacencyOffsets[v] + remaining[v];
+				}
+				std::vector<uint32_t> adjacency(numTriangles * 3u);
+				std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+				for (size_t t = 0; t < numTriangles; ++t) {
+					for (size_t k = 0; k < 3u; ++k) {
+						const uint32_t v = indices[t * 3u + k];
+						adjacency[fill[v]++] = static_cast<uint32_t>(t);
+					}
+				}
+
+				std::vector<int> cachePositions(vertexCount, -1);
+				std::vector<float> vertexScores(vertexCount);
+				for (size_t v = 0; v < vertexCount; ++v) {
+					vertexScores[v] = vertexScore(-1, remaining[v]);
+				}
+				std::vector<float> triangleScores(numTriangles);
+				std::vector<bool> emitted(numTriangles, false);
+				int bestTriangle = -1;
+				float bestScore = -1.0f;
+				for (size_t t = 0; t < numTriangles; ++t) {
+					triangleScores[t] = vertexScores[indices[t * 3u]] + vertexScores[indices[t * 3u + 1u]] + vertexScores[indices[t * 3u + 2u]];
+					if (triangleScores[t] > bestScore) {
+						bestScore = triangleScores[t];
+						bestTriangle = static_cast<int>(t);
+					}
+				}
+
+				const std::vector<uint32_t> source(indices, indices + numTriangles * 3u);
+				std::vector<uint32_t> cache;
+				std::vector<uint32_t> newCache;
+				cache.reserve(CACHE_SIZE + 3);
+				newCache.reserve(CACHE_SIZE + 3);
+				size_t scanCursor = 0u;
+				for (size_t out = 0; out < numTriangles; ++out) {
+					if (bestTriangle < 0) {
+						// nothing in the cache has triangles left, continue with the next unused one
+						while (emitted[scanCursor]) {
+							scanCursor++;
+						}
+						bestTriangle = static_cast<int>(scanCursor);
+					}
+					const uint32_t* triangle = source.data() + static_cast<size_t>(bestTriangle) * 3u;
+					std::memcpy(indices + out * 3u, triangle, 3u * sizeof(uint32_t));
+					emitted[bestTriangle] = true;
+
+					for (size_t k = 0; k < 3u; ++k) {
+						const uint32_t v = triangle[k];
+						uint32_t* triangles = adjacency.data() + adjacencyOffsets[v];
+						uint32_t* last = triangles + remaining[v] - 1u;
+						*std::find(triangles, last + 1, static_cast<uint32_t>(bestTriangle)) = *last;
+						remaining[v]--;
+					}
+
+					// the triangle's vertices move to the front of the cache
+					newCache.assign(triangle, triangle + 3);
+					for (const uint32_t v : cache) {
+						if (v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+							newCache.push_back(v);
+						}
+					}
+					for (size_t i = 0; i < newCache.size(); ++i) {
+						cachePositions[newCache[i]] = i < static_cast<size_t>(CACHE_SIZE) ? static_cast<int>(i) : -1;
+					}
+
+					// rescore the touched vertices and their remaining triangles, the next triangle is
+					// the best one that uses a cached vertex
+					bestTriangle = -1;
+					bestScore = -1.0f;
+					for (const uint32_t v : newCache) {
+						const float score = vertexScore(cachePositions[v], remaining[v]);
+						const float delta = score - vertexScores[v];
+						vertexScores[v] = score;
+						const uint32_t* triangles = adjacency.data() + adjacencyOffsets[v];
+						for (uint32_t i = 0u; i < remaining[v]; ++i) {
+							triangleScores[triangles[i]] += delta;
+						}
+					}
+					for (size_t i = 0; i < newCache.size() && i < static_cast<size_t>(CACHE_SIZE); ++i) {
+						const uint32_t v = newCache[i];
+						const uint32_t* triangles = adjacency.data() + adjacencyOffsets[v];
+						for (uint32_t j = 0u; j < remaining[v]; ++j) {
+							if (triangleScores[triangles[j]] > bestScore) {
+								bestScore = triangleScores[triangles[j]];
+								bestTriangle = static_cast<int>(triangles[j]);
+							}
+						}
+					}
+					if (newCache.size() > static_cast<size_t>(CACHE_SIZE)) {
+						newCache.resize(CACHE_SIZE);
+					}
+					cache.swap(newCache);
+				}
+			}
+
+			size_t optimizeVertexFetch(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, std::vector<uint32_t>& remap) {
+				remap.assign(vertexCount, UINT32_MAX);
+				uint32_t next = 0u;
+				for (size_t i = 0; i < indexCount; ++i) {
+					if (remap[indices[i]] == UINT32_MAX) {
+						remap[indices[i]] = next++;
+					}
+				}
+				return next;
+			}
+
+			float averageCacheMissRatio(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const int cacheSize) {
+				const size_t numTriangles = indexCount / 3u;
+				if (numTriangles == 0u) {
+					return 0.0f;
+				}
+				// a vertex is cached while fewer than cacheSize misses happened since it was loaded
+				std::vector<uint32_t> loadedAt(vertexCount, 0u);
+				std::vector<bool> loaded(vertexCount, false);
+				uint32_t misses = 0u;
+				for (size_t i = 0; i < numTriangles * 3u; ++i) {
+					const uint32_t v = indices[i];
+					if (loaded[v] == false || misses - loadedAt[v] >= static_cast<uint32_t>(cacheSize)) {
+						loaded[v] = true;
+						loadedAt[v] = misses;
+						misses++;
+					}
+				}
+				return static_cast<float>(misses) / static_cast<float>(numTriangles);
+			}
+		}
+	}
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// Index buffer preparation for triangle lists. Vertices are opaque blocks of vertexStride
+		// bytes, two vertices are the same when their bytes are.
+		namespace MeshOptimizer {
+			// remap[i]: index of vertex i after merging identical vertices (first occurrence order),
+			// returns the number of unique vertices
+			size_t weldVertices(const void* vertices, const size_t vertexCount, const size_t vertexStride, std::vector<uint32_t>& remap);
+
+			// reorders the triangles for the post-transform vertex cache (Forsyth's linear-speed
+			// algorithm with an LRU cache model); the set of triangles does not change
+			void optimizeVertexCache(uint32_t* indices, const size_t indexCount, const size_t vertexCount);
+
+			// remap[v]: new index of vertex v so that vertices are stored in the order the indices
+			// first use them (UINT32_MAX for unused vertices); returns the number of used vertices
+			size_t optimizeVertexFetch(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, std::vector<uint32_t>& remap);
+
+			// average number of vertex shader invocations per triangle with a FIFO cache of cacheSize
+			// entries (3.0 without reuse, ~0.5 at best for regular meshes)
+			float averageCacheMissRatio(const uint32_t* indices, const size_t indexCount, const size_t vertexCount, const int cacheSize);
+		}
+	}
+}
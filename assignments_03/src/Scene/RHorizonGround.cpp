@@ -3,6 +3,7 @@
 
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/transform.hpp>
+#include "../Rendering/GLStateCache.h"
 #include "../Rendering/ShaderParameterBindingPoint.h"
 
 namespace INANOA {
@@ -63,7 +64,7 @@ for (int i = 0; i < NUM_CASCADE; ++i) {
 
 			void HorizonGround::render() {
 				// bind vao
-				glBindVertexArray(this->m_vaoHandle);
+				OPENGL::GLStateCache::bindVertexArray(this->m_vaoHandle);
 				// submit model matrix
 				glUniformMatrix4fv(SHADER_PARAMETER_BINDING::MODEL_MAT_LOCATION, 1, false, glm::value_ptr(this->m_modelMat));				
 				// render
@@ -1,6 +1,7 @@
 #include "RViewFrustum.h"
 
 #include <glm/gtc/type_ptr.hpp>
+#include "../Rendering/GLStateCache.h"
 #include "../Rendering/ShaderParameterBindingPoint.h"
 
 namespace INANOA {
@@ -74,7 +75,7 @@ namespace INANOA {
 
 		void RViewFrustum::render() {
 			// bind vao
-			glBindVertexArray(this->m_vaoHandle);
+			OPENGL::GLStateCache::bindVertexArray(this->m_vaoHandle);
 			// submit model matrix
 			glUniformMatrix4fv(SHADER_PARAMETER_BINDING::MODEL_MAT_LOCATION, 1, false, glm::value_ptr(this->m_modelMat));
 			// render
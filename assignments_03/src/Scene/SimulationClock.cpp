@@ -0,0 +1,29 @@
+#include "SimulationClock.h"
+
+#include <algorithm>
+
+namespace INANOA {
+	namespace SCENE {
+		SimulationClock::SimulationClock(const double stepSeconds, const int maxStepsPerFrame) :
+			m_stepSeconds(stepSeconds), m_maxStepsPerFrame(std::max(maxStepsPerFrame, 1)) {}
+		SimulationClock::~SimulationClock() {}
+
+		int SimulationClock::advance(const double elapsedSeconds) {
+			this->m_accumulator = this->m_accumulator + std::max(elapsedSeconds, 0.0);
+			int numSteps = static_cast<int>(this->m_accumulator / this->m_stepSeconds);
+			this->m_accumulator = this->m_accumulator - numSteps * this->m_stepSeconds;
+			if (numSteps > this->m_maxStepsPerFrame) {
+				this->m_droppedSteps = this->m_droppedSteps + static_cast<uint64_t>(numSteps - this->m_maxStepsPerFrame);
+				numSteps = this->m_maxStepsPerFrame;
+			}
+			this->m_totalSteps = this->m_totalSteps + static_cast<uint64_t>(numSteps);
+			return numSteps;
+		}
+
+		void SimulationClock::reset() {
+			this->m_accumulator = 0.0;
+			this->m_totalSteps = 0u;
+			this->m_droppedSteps = 0u;
+		}
+	}
+}
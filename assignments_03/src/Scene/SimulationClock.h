@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+
+namespace INANOA {
+	namespace SCENE {
+		// Fixed timestep simulation clock. The wall time of each rendered frame is accumulated and
+		// consumed in whole steps, the remainder is the interpolation factor between the last two
+		// simulated states, so the simulation runs at the same rate whatever the frame rate.
+		class SimulationClock
+		{
+		public:
+			// 60 steps per second, the rate the trajectory and the camera speeds were tuned at
+			explicit SimulationClock(const double stepSeconds = 1.0 / 60.0, const int maxStepsPerFrame = 8);
+			virtual ~SimulationClock();
+
+		public:
+			// steps to simulate for elapsedSeconds of wall time; past maxStepsPerFrame the rest is dropped,
+			// a stall slows the simulation down instead of making the next frames catch up
+			int advance(const double elapsedSeconds);
+			void reset();
+
+		public:
+			inline double stepSeconds() const { return this->m_stepSeconds; }
+			// [0, 1) from the previous to the current state
+			inline float alpha() const { return static_cast<float>(this->m_accumulator / this->m_stepSeconds); }
+			inline uint64_t totalSteps() const { return this->m_totalSteps; }
+			inline uint64_t droppedSteps() const { return this->m_droppedSteps; }
+
+		private:
+			const double m_stepSeconds;
+			const int m_maxStepsPerFrame;
+			double m_accumulator = 0.0;
+			uint64_t m_totalSteps = 0u;
+			uint64_t m_droppedSteps = 0u;
+		};
+	}
+}
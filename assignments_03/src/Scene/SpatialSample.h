@@ -4,6 +4,8 @@
 #include <istream>
 #include <ostream>
 
+#include "InstanceField.h"
+
 namespace INANOA {
 	namespace SCENE {
 		namespace EXPERIMENTAL {
@@ -56,7 +58,8 @@ namespace INANOA {
 					int numSample;
 					inputStream.read((char*)(&numSample), sizeof(int));
 
-					if (numSample <= 0) {
+					// SS2 v2 files are laid out for the GPU and loaded through InstanceField
+					if (numSample <= 0 || static_cast<uint32_t>(numSample) == InstanceField::MAGIC) {
 						return nullptr;
 					}
 
@@ -0,0 +1,99 @@
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace INANOA {
+	namespace SCENE {
+		namespace {
+			uint64_t levelBytes(const uint32_t width, const uint32_t height, const uint32_t level, const uint32_t blockBytes) {
+				const uint64_t levelWidth = std::max(width >> level, 1u);
+				const uint64_t levelHeight = std::max(height >> level, 1u);
+				return ((levelWidth + 3u) / 4u) * ((levelHeight + 3u) / 4u) * blockBytes;
+			}
+		}
+
+		bool TextureCache::read(const std::string& filename, const uint32_t contentKey, const uint32_t glInternalFormat, TextureCacheData& data) {
+			std::ifstream input(filename, std::ios::binary);
+			if (!input.is_open()) {
+				return false;
+			}
+			TextureCacheHeader header{};
+			input.read(reinterpret_cast<char*>(&header), sizeof(TextureCacheHeader));
+			if (!input || header.magic != MAGIC) {
+				std::cerr << filename << ": not a texture cache file" << std::endl;
+				return false;
+			}
+			if (header.version != VERSION || header.contentKey != contentKey || header.glInternalFormat != glInternalFormat) {
+				return false;
+			}
+			if (header.width == 0u || header.height == 0u || header.numLevels == 0u || header.numLevels > 32u) {
+				std::cerr << filename << ": corrupt texture cache header" << std::endl;
+				return false;
+			}
+
+			std::vector<TextureCacheLevel> index(header.numLevels);
+			input.read(reinterpret_cast<char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(TextureCacheLevel)));
+			data.glInternalFormat = header.glInternalFormat;
+			data.blockBytes = header.blockBytes;
+			data.width = static_cast<int>(header.width);
+			data.height = static_cast<int>(header.height);
+			data.levels.resize(header.numLevels);
+			for (uint32_t level = 0u; level < header.numLevels && input; ++level) {
+				if (index[level].byteLength != levelBytes(header.width, header.height, level, header.blockBytes)) {
+					std::cerr << filename << ": corrupt level size" << std::endl;
+					return false;
+				}
+				data.levels[level].resize(static_cast<size_t>(index[level].byteLength));
+				input.seekg(static_cast<std::streamoff>(index[level].byteOffset));
+				input.read(reinterpret_cast<char*>(data.levels[level].data()), static_cast<std::streamsize>(index[level].byteLength));
+			}
+			if (!input) {
+				std::cerr << filename << ": truncated texture cache file" << std::endl;
+				return false;
+			}
+			return true;
+		}
+
+		bool TextureCache::write(const std::string& filename, const uint32_t contentKey, const TextureCacheData& data) {
+			TextureCacheHeader header{};
+			header.magic = MAGIC;
+			header.version = VERSION;
+			header.contentKey = contentKey;
+			header.glInternalFormat = data.glInternalFormat;
+			header.width = static_cast<uint32_t>(data.width);
+			header.height = static_cast<uint32_t>(data.height);
+			header.numLevels = static_cast<uint32_t>(data.levels.size());
+			header.blockBytes = data.blockBytes;
+
+			std::vector<TextureCacheLevel> index(data.levels.size());
+			uint64_t offset = sizeof(TextureCacheHeader) + index.size() * sizeof(TextureCacheLevel);
+			for (size_t level = 0; level < data.levels.size(); ++level) {
+				index[level].byteOffset = offset;
+				index[level].byteLength = data.levels[level].size();
+				offset += index[level].byteLength;
+			}
+
+			// written next to the target and renamed, a reader never sees a half written file
+			const std::string tempFile = filename + ".tmp";
+			std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+			if (!output.is_open()) {
+				return false;
+			}
+			output.write(reinterpret_cast<const char*>(&header), sizeof(TextureCacheHeader));
+			output.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(TextureCacheLevel)));
+			for (const std::vector<unsigned char>& level : data.levels) {
+				output.write(reinterpret_cast<const char*>(level.data()), static_cast<std::streamsize>(level.size()));
+			}
+			output.close();
+			if (!output) {
+				std::remove(tempFile.c_str());
+				return false;
+			}
+			std::remove(filename.c_str());
+			return std::rename(tempFile.c_str(), filename.c_str()) == 0;
+		}
+	}
+}
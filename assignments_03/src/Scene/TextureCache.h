@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// Block compressed texture with its mip chain as glCompressedTexSubImage wants it, laid out
+		// after KTX2 (header, level index, level data):
+		//   TextureCacheHeader
+		//   TextureCacheLevel levels[numLevels]
+		//   level data, level 0 first
+		// Every value is little endian.
+		struct TextureCacheHeader {
+			uint32_t magic;
+			uint32_t version;
+			// hash of the source image and the processing parameters, a stale file is rebuilt
+			uint32_t contentKey;
+			// GL internal format of the blocks (e.g. GL_COMPRESSED_RGBA_BPTC_UNORM)
+			uint32_t glInternalFormat;
+			uint32_t width;
+			uint32_t height;
+			uint32_t numLevels;
+			// bytes of one 4x4 block
+			uint32_t blockBytes;
+		};
+		static_assert(sizeof(TextureCacheHeader) == 32, "TextureCacheHeader layout");
+
+		// byteOffset from the start of the file
+		struct TextureCacheLevel {
+			uint64_t byteOffset;
+			uint64_t byteLength;
+		};
+
+		struct TextureCacheData {
+			uint32_t glInternalFormat = 0u;
+			uint32_t blockBytes = 0u;
+			int width = 0;
+			int height = 0;
+			// level i is max(width >> i, 1) x max(height >> i, 1)
+			std::vector<std::vector<unsigned char>> levels;
+		};
+
+		class TextureCache
+		{
+		public:
+			// "STEX"
+			static const uint32_t MAGIC = 0x58455453u;
+			static const uint32_t VERSION = 1u;
+
+		public:
+			// false when the file is missing, stale (other contentKey / format) or corrupt
+			static bool read(const std::string& filename, const uint32_t contentKey, const uint32_t glInternalFormat, TextureCacheData& data);
+			static bool write(const std::string& filename, const uint32_t contentKey, const TextureCacheData& data);
+		};
+	}
+}
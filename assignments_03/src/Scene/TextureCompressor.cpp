@@ -0,0 +1,299 @@
+#include "TextureCompressor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace INANOA {
+	namespace SCENE {
+		namespace TextureCompressor {
+			namespace {
+				constexpr int CHANNELS = 4;
+				constexpr int BLOCK_TEXELS = 16;
+				// interpolation weights of 4 bit BC7 indices, out of 64
+				constexpr int WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+				constexpr int ALPHA_SCALE_STEPS = 12;
+
+				// 7 bit endpoint + p-bit, the decoded 8 bit value is (q << 1) | p
+				struct Endpoint {
+					int q[CHANNELS];
+					int p;
+				};
+
+				float alphaCoverage(const std::vector<unsigned char>& rgba, const float cutoff, const float scale) {
+					const size_t numTexels = rgba.size() / CHANNELS;
+					size_t passing = 0u;
+					for (size_t i = 0; i < numTexels; ++i) {
+						if (static_cast<float>(rgba[i * CHANNELS + 3]) * scale >= cutoff * 255.0f) {
+							passing++;
+						}
+					}
+					return static_cast<float>(passing) / static_cast<float>(std::max<size_t>(numTexels, 1u));
+				}
+
+				Endpoint quantizeEndpoint(const float color[CHANNELS]) {
+					Endpoint best{};
+					float bestError = -1.0f;
+					for (int p = 0; p < 2; ++p) {
+						Endpoint endpoint{};
+						endpoint.p = p;
+						float error = 0.0f;
+						for (int c = 0; c < CHANNELS; ++c) {
+							endpoint.q[c] = std::clamp(static_cast<int>(std::lround((color[c] - static_cast<float>(p)) * 0.5f)), 0, 127);
+							const float d = static_cast<float>((endpoint.q[c] << 1) | p) - color[c];
+							error += d * d;
+						}
+						if (bestError < 0.0f || error < bestError) {
+							bestError = error;
+							best = endpoint;
+						}
+					}
+					return best;
+				}
+
+				// best index of every texel for the endpoint pair, returns the squared error of the block
+				int selectIndices(const int texels[BLOCK_TEXELS][CHANNELS], const Endpoint& e0, const Endpoint& e1, int indices[BLOCK_TEXELS]) {
+					int palette[16][CHANNELS];
+					for (int i = 0; i < 16; ++i) {
+						for (int c = 0; c < CHANNELS; ++c) {
+							const int a = (e0.q[c] << 1) | e0.p;
+							const int b = (e1.q[c] << 1) | e1.p;
+							palette[i][c] = ((64 - WEIGHTS4[i]) * a + WEIGHTS4[i] * b + 32) >> 6;
+						}
+					}
+					int totalError = 0;
+					for (int t = 0; t < BLOCK_TEXELS; ++t) {
+						int bestError = INT32_MAX;
+						for (int i = 0; i < 16; ++i) {
+							int error = 0;
+							for (int c = 0; c < CHANNELS; ++c) {
+								const int d = palette[i][c] - texels[t][c];
+								error += d * d;
+							}
+							if (error < bestError) {
+								bestError = error;
+								indices[t] = i;
+							}
+						}
+						totalError += bestError;
+					}
+					return totalError;
+				}
+
+				// endpoints that minimize the squared error for fixed indices; false when every texel uses one weight
+				bool refitEndpoints(const int texels[BLOCK_TEXELS][CHANNELS], const int indices[BLOCK_TEXELS], float e0[CHANNELS], float e1[CHANNELS]) {
+					float aa = 0.0f;
+					float ab = 0.0f;
+					float bb = 0.0f;
+					float ax[CHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					float bx[CHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for (int t = 0; t < BLOCK_TEXELS; ++t) {
+						const float w = static_cast<float>(WEIGHTS4[indices[t]]) / 64.0f;
+						aa += (1.0f - w) * (1.0f - w);
+						ab += (1.0f - w) * w;
+						bb += w * w;
+						for (int c = 0; c < CHANNELS; ++c) {
+							ax[c] += (1.0f - w) * static_cast<float>(texels[t][c]);
+							bx[c] += w * static_cast<float>(texels[t][c]);
+						}
+					}
+					const float det = aa * bb - ab * ab;
+					if (std::fabs(det) < 1e-6f) {
+						return false;
+					}
+					for (int c = 0; c < CHANNELS; ++c) {
+						e0[c] = std::clamp((bb * ax[c] - ab * bx[c]) / det, 0.0f, 255.0f);
+						e1[c] = std::clamp((aa * bx[c] - ab * ax[c]) / det, 0.0f, 255.0f);
+					}
+					return true;
+				}
+
+				// least significant bit first, as BC7 blocks are laid out
+				struct BlockWriter {
+					unsigned char bytes[BC7_BLOCK_BYTES] = {};
+					int position = 0;
+
+					void write(const uint32_t value, const int numBits) {
+						for (int i = 0; i < numBits; ++i, ++position) {
+							if ((value >> i) & 1u) {
+								bytes[position >> 3] |= static_cast<unsigned char>(1u << (position & 7));
+							}
+						}
+					}
+				};
+
+				void encodeBlock(const int texels[BLOCK_TEXELS][CHANNELS], unsigned char* block) {
+					// endpoints along the principal axis of the texels (power iteration on the covariance)
+					float mean[CHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+					for (int t = 0; t < BLOCK_TEXELS; ++t) {
+						for (int c = 0; c < CHANNELS; ++c) {
+							mean[c] += static_cast<float>(texels[t][c]) / BLOCK_TEXELS;
+						}
+					}
+					float covariance[CHANNELS][CHANNELS] = {};
+					for (int t = 0; t < BLOCK_TEXELS; ++t) {
+						for (int i = 0; i < CHANNELS; ++i) {
+							for (int j = 0; j < CHANNELS; ++j) {
+								covariance[i][j] += (static_cast<float>(texels[t][i]) - mean[i]) * (static_cast<float>(texels[t][j]) - mean[j]);
+							}
+						}
+					}
+					float axis[CHANNELS] = { 1.0f, 1.0f, 1.0f, 1.0f };
+					for (int iteration = 0; iteration < 8; ++iteration) {
+						float next[CHANNELS] = { 0.0f, 0.0f, 0.0f, 0.0f };
+						float length = 0.0f;
+						for (int i = 0; i < CHANNELS; ++i) {
+							for (int j = 0; j < CHANNELS; ++j) {
+								next[i] += covariance[i][j] * axis[j];
+							}
+							length += next[i] * next[i];
+						}
+						length = std::sqrt(length);
+						if (length < 1e-6f) {
+							// flat block, both endpoints end up at the mean
+							std::fill(axis, axis + CHANNELS, 0.0f);
+							break;
+						}
+						for (int i = 0; i < CHANNELS; ++i) {
+							axis[i] = next[i] / length;
+						}
+					}
+					float minT = 0.0f;
+					float maxT = 0.0f;
+					for (int t = 0; t < BLOCK_TEXELS; ++t) {
+						float projection = 0.0f;
+						for (int c = 0; c < CHANNELS; ++c) {
+							projection += (static_cast<float>(texels[t][c]) - mean[c]) * axis[c];
+						}
+						minT = std::min(minT, projection);
+						maxT = std::max(maxT, projection);
+					}
+					float color0[CHANNELS];
+					float color1[CHANNELS];
+					for (int c = 0; c < CHANNELS; ++c) {
+						color0[c] = std::clamp(mean[c] + minT * axis[c], 0.0f, 255.0f);
+						color1[c] = std::clamp(mean[c] + maxT * axis[c], 0.0f, 255.0f);
+					}
+
+					Endpoint e0 = quantizeEndpoint(color0);
+					Endpoint e1 = quantizeEndpoint(color1);
+					int indices[BLOCK_TEXELS];
+					int error = selectIndices(texels, e0, e1, indices);
+					// one least squares pass over the chosen indices, kept when it is better
+					if (error > 0 && refitEndpoints(texels, indices, color0, color1)) {
+						const Endpoint r0 = quantizeEndpoint(color0);
+						const Endpoint r1 = quantizeEndpoint(color1);
+						int refitIndices[BLOCK_TEXELS];
+						const int refitError = selectIndices(texels, r0, r1, refitIndices);
+						if (refitError < error) {
+							e0 = r0;
+							e1 = r1;
+							error = refitError;
+							std::memcpy(indices, refitIndices, sizeof(indices));
+						}
+					}
+
+					// the most significant bit of the first index is implicitly 0
+					if (indices[0] >= 8) {
+						std::swap(e0, e1);
+						for (int t = 0; t < BLOCK_TEXELS; ++t) {
+							indices[t] = 15 - indices[t];
+						}
+					}
+
+					BlockWriter writer;
+					// mode 6: bit 6 set
+					writer.write(1u << 6, 7);
+					for (int c = 0; c < CHANNELS; ++c) {
+						writer.write(static_cast<uint32_t>(e0.q[c]), 7);
+						writer.write(static_cast<uint32_t>(e1.q[c]), 7);
+					}
+					writer.write(static_cast<uint32_t>(e0.p), 1);
+					writer.write(static_cast<uint32_t>(e1.p), 1);
+					writer.write(static_cast<uint32_t>(indices[0]), 3);
+					for (int t = 1; t < BLOCK_TEXELS; ++t) {
+						writer.write(static_cast<uint32_t>(indices[t]), 4);
+					}
+					std::memcpy(block, writer.bytes, BC7_BLOCK_BYTES);
+				}
+			}
+
+			size_t bc7Size(const int width, const int height) {
+				return static_cast<size_t>((width + 3) / 4) * static_cast<size_t>((height + 3) / 4) * BC7_BLOCK_BYTES;
+			}
+
+			void buildMipChain(const unsigned char* rgba, const int width, const int height, const float alphaCutoff, std::vector<std::vector<unsigned char>>& levels) {
+				levels.clear();
+				levels.emplace_back(rgba, rgba + static_cast<size_t>(width) * height * CHANNELS);
+				const float targetCoverage = alphaCutoff > 0.0f ? alphaCoverage(levels[0], alphaCutoff, 1.0f) : 0.0f;
+
+				// every level is filtered from the unscaled previous one, the alpha scale does not accumulate
+				std::vector<unsigned char> previous = levels[0];
+				int previousWidth = width;
+				int previousHeight = height;
+				while (previousWidth > 1 || previousHeight > 1) {
+					const int levelWidth = std::max(previousWidth / 2, 1);
+					const int levelHeight = std::max(previousHeight / 2, 1);
+					std::vector<unsigned char> level(static_cast<size_t>(levelWidth) * levelHeight * CHANNELS);
+					for (int y = 0; y < levelHeight; ++y) {
+						const int y0 = std::min(y * 2, previousHeight - 1);
+						const int y1 = std::min(y * 2 + 1, previousHeight - 1);
+						for (int x = 0; x < levelWidth; ++x) {
+							const int x0 = std::min(x * 2, previousWidth - 1);
+							const int x1 = std::min(x * 2 + 1, previousWidth - 1);
+							for (int c = 0; c < CHANNELS; ++c) {
+								const int sum = previous[(static_cast<size_t>(y0) * previousWidth + x0) * CHANNELS + c]
+									+ previous[(static_cast<size_t>(y0) * previousWidth + x1) * CHANNELS + c]
+									+ previous[(static_cast<size_t>(y1) * previousWidth + x0) * CHANNELS + c]
+									+ previous[(static_cast<size_t>(y1) * previousWidth + x1) * CHANNELS + c];
+								level[(static_cast<size_t>(y) * levelWidth + x) * CHANNELS + c] = static_cast<unsigned char>((sum + 2) / 4);
+							}
+						}
+					}
+					previous = level;
+					previousWidth = levelWidth;
+					previousHeight = levelHeight;
+
+					if (targetCoverage > 0.0f && targetCoverage < 1.0f) {
+						// coverage grows with the scale, bisect for the one that matches level 0
+						float low = 0.0f;
+						float high = 4.0f;
+						for (int step = 0; step < ALPHA_SCALE_STEPS; ++step) {
+							const float mid = 0.5f * (low + high);
+							if (alphaCoverage(level, alphaCutoff, mid) < targetCoverage) {
+								low = mid;
+							}
+							else {
+								high = mid;
+							}
+						}
+						for (size_t i = 3; i < level.size(); i += CHANNELS) {
+							level[i] = static_cast<unsigned char>(std::min(255.0f, std::round(static_cast<float>(level[i]) * high)));
+						}
+					}
+					levels.push_back(std::move(level));
+				}
+			}
+
+			void compressBC7(const unsigned char* rgba, const int width, const int height, std::vector<unsigned char>& blocks) {
+				const int blocksX = (width + 3) / 4;
+				const int blocksY = (height + 3) / 4;
+				blocks.resize(bc7Size(width, height));
+				int texels[BLOCK_TEXELS][CHANNELS];
+				for (int by = 0; by < blocksY; ++by) {
+					for (int bx = 0; bx < blocksX; ++bx) {
+						for (int t = 0; t < BLOCK_TEXELS; ++t) {
+							const int x = std::min(bx * 4 + (t & 3), width - 1);
+							const int y = std::min(by * 4 + (t >> 2), height - 1);
+							for (int c = 0; c < CHANNELS; ++c) {
+								texels[t][c] = rgba[(static_cast<size_t>(y) * width + x) * CHANNELS + c];
+							}
+						}
+						encodeBlock(texels, blocks.data() + (static_cast<size_t>(by) * blocksX + bx) * BC7_BLOCK_BYTES);
+					}
+				}
+			}
+		}
+	}
+}
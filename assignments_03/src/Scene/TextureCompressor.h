@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace INANOA {
+	namespace SCENE {
+		// Offline preparation of RGBA8 images for block compressed textures. Images are tightly
+		// packed RGBA8 rows, blocks are 4x4 texels in row major block order.
+		namespace TextureCompressor {
+			constexpr size_t BC7_BLOCK_BYTES = 16u;
+
+			// bytes of one BC7 image of that size (partial blocks at the edges count as whole ones)
+			size_t bc7Size(const int width, const int height);
+
+			// box filtered mip chain down to 1x1, levels[0] is a copy of the image. With alphaCutoff > 0
+			// the alpha of every level is scaled so that the fraction of texels passing the alpha test
+			// stays that of level 0, alpha tested foliage would thin out in the distance otherwise.
+			void buildMipChain(const unsigned char* rgba, const int width, const int height, const float alphaCutoff, std::vector<std::vector<unsigned char>>& levels);
+
+			// BC7 encoding (mode 6: one RGBA endpoint pair with 4 bit indices per block); texels
+			// outside the image repeat the edge
+			void compressBC7(const unsigned char* rgba, const int width, const int height, std::vector<unsigned char>& blocks);
+		}
+	}
+}
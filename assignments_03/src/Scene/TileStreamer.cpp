@@ -0,0 +1,285 @@
+#include "TileStreamer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+#include <glm/glm.hpp>
+
+namespace INANOA {
+	namespace SCENE {
+		TileStreamer::TileStreamer() {}
+		TileStreamer::~TileStreamer() {
+			this->shutdown();
+			for (StagingRegion& region : this->m_regions) {
+				if (region.fence != nullptr) {
+					glDeleteSync(region.fence);
+					region.fence = nullptr;
+				}
+			}
+			if (this->m_stagingBuffer != 0u) {
+				glBindBuffer(GL_COPY_READ_BUFFER, this->m_stagingBuffer);
+				glUnmapBuffer(GL_COPY_READ_BUFFER);
+				glBindBuffer(GL_COPY_READ_BUFFER, 0);
+				glDeleteBuffers(1, &this->m_stagingBuffer);
+			}
+		}
+
+		int TileStreamer::slotsForRadius(const float radius, const float tileSize) {
+			// the point can be anywhere in its own tile, tile (i, j) is reachable when the gap
+			// between the two squares is within radius
+			const int reach = static_cast<int>(std::ceil(radius / tileSize)) + 1;
+			int count = 0;
+			for (int i = -reach; i <= reach; ++i) {
+				for (int j = -reach; j <= reach; ++j) {
+					const float gapX = std::max(std::abs(i) - 1, 0) * tileSize;
+					const float gapZ = std::max(std::abs(j) - 1, 0) * tileSize;
+					if (gapX * gapX + gapZ * gapZ <= radius * radius) {
+						count++;
+					}
+				}
+			}
+			return count;
+		}
+
+		bool TileStreamer::init(const TiledInstanceSource& source, const int numSlots, const uint32_t cellsPerSlot, const uint32_t recordsPerSlot, const TilePoolBuffers& buffers) {
+			this->m_source = source;
+			this->m_buffers = buffers;
+			this->m_cellsPerSlot = cellsPerSlot;
+			this->m_recordsPerSlot = recordsPerSlot;
+			this->m_slots.assign(static_cast<size_t>(numSlots), Slot());
+			this->m_tileSlots.assign(source.numTiles, -1);
+
+			// one region holds a full slot: its cells, then its records
+			const GLsizeiptr cellBytes = static_cast<GLsizeiptr>(cellsPerSlot) * sizeof(InstanceFieldChunk);
+			this->m_regionBytes = cellBytes + static_cast<GLsizeiptr>(recordsPerSlot) * source.recordStride;
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			const GLsizeiptr totalSize = this->m_regionBytes * NUM_STAGING_REGIONS;
+			glGenBuffers(1, &this->m_stagingBuffer);
+			glBindBuffer(GL_COPY_READ_BUFFER, this->m_stagingBuffer);
+			glBufferStorage(GL_COPY_READ_BUFFER, totalSize, nullptr, flags);
+			this->m_stagingMapped = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_READ_BUFFER, 0, totalSize, flags));
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+			if (this->m_stagingMapped == nullptr) {
+				std::cerr << "Failed to map tile staging buffer" << std::endl;
+				return false;
+			}
+
+			this->m_quit = false;
+			this->m_worker = std::thread(&TileStreamer::workerLoop, this);
+			return true;
+		}
+
+		void TileStreamer::shutdown() {
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				this->m_quit = true;
+			}
+			this->m_condition.notify_all();
+			if (this->m_worker.joinable()) {
+				this->m_worker.join();
+			}
+		}
+
+		void TileStreamer::workerLoop() {
+			while (true) {
+				LoadRequest request;
+				{
+					std::unique_lock<std::mutex> lock(this->m_mutex);
+					this->m_condition.wait(lock, [this]() { return this->m_quit || this->m_requests.empty() == false; });
+					if (this->m_quit) {
+						return;
+					}
+					request = this->m_requests.front();
+					this->m_requests.pop_front();
+				}
+				this->stageTile(request);
+				{
+					std::lock_guard<std::mutex> lock(this->m_mutex);
+					this->m_finished.push_back(request);
+				}
+				this->m_condition.notify_all();
+			}
+		}
+
+		void TileStreamer::stageTile(const LoadRequest& request) {
+			// worker thread: plain memory copies into the mapping, no GL calls
+			const InstanceFieldTile& tile = this->m_source.tiles[request.tile];
+			unsigned char* region = this->m_stagingMapped + static_cast<GLsizeiptr>(request.region) * this->m_regionBytes;
+			InstanceFieldChunk* cells = reinterpret_cast<InstanceFieldChunk*>(region);
+			const uint32_t slotFirstRecord = static_cast<uint32_t>(request.slot) * this->m_recordsPerSlot;
+			for (uint32_t c = 0u; c < tile.numChunks; ++c) {
+				InstanceFieldChunk chunk = this->m_source.chunks[tile.firstChunk + c];
+				chunk.first = slotFirstRecord + (chunk.first - tile.firstRecord);
+				cells[c] = chunk;
+			}
+			const size_t recordOffset = static_cast<size_t>(this->m_cellsPerSlot) * sizeof(InstanceFieldChunk);
+			std::memcpy(region + recordOffset, this->m_source.records + static_cast<size_t>(tile.firstRecord) * this->m_source.recordStride, static_cast<size_t>(tile.numRecords) * this->m_source.recordStride);
+		}
+
+		void TileStreamer::publishTile(const LoadRequest& request) {
+			const InstanceFieldTile& tile = this->m_source.tiles[request.tile];
+			const GLintptr regionOffset = static_cast<GLintptr>(request.region) * this->m_regionBytes;
+			const GLintptr recordOffset = static_cast<GLintptr>(this->m_cellsPerSlot) * sizeof(InstanceFieldChunk);
+			const GLintptr slotRecord = static_cast<GLintptr>(request.slot) * this->m_recordsPerSlot;
+
+			glBindBuffer(GL_COPY_READ_BUFFER, this->m_stagingBuffer);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffers.cells);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, regionOffset, static_cast<GLintptr>(request.slot) * this->m_cellsPerSlot * sizeof(InstanceFieldChunk), static_cast<GLsizeiptr>(tile.numChunks) * sizeof(InstanceFieldChunk));
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffers.records);
+			glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, regionOffset + recordOffset, slotRecord * this->m_source.recordStride, static_cast<GLsizeiptr>(tile.numRecords) * this->m_source.recordStride);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffers.states);
+			glClearBufferSubData(GL_COPY_WRITE_BUFFER, GL_R32UI, slotRecord * sizeof(GLuint), static_cast<GLsizeiptr>(tile.numRecords) * sizeof(GLuint), GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+			glBindBuffer(GL_COPY_READ_BUFFER, 0);
+
+			StagingRegion& region = this->m_regions[request.region];
+			region.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			this->setTableEntry(request.slot, tile.numChunks, request.tile);
+			this->m_slots[request.slot].loading = false;
+			this->m_residentTiles++;
+			this->m_pendingTiles--;
+		}
+
+		void TileStreamer::setTableEntry(const int slot, const uint32_t numCells, const int tile) {
+			const GLuint entry[4] = { numCells, static_cast<GLuint>(tile), 0u, 0u };
+			glBindBuffer(GL_COPY_WRITE_BUFFER, this->m_buffers.tileTable);
+			glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(slot) * sizeof(entry), sizeof(entry), entry);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+
+		int TileStreamer::acquireRegion() {
+			for (int r = 0; r < NUM_STAGING_REGIONS; ++r) {
+				StagingRegion& region = this->m_regions[r];
+				if (region.busy && region.fence != nullptr) {
+					// the copy out of the region has to be done before the worker may refill it
+					const GLenum status = glClientWaitSync(region.fence, 0, 0);
+					if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED) {
+						glDeleteSync(region.fence);
+						region.fence = nullptr;
+						region.busy = false;
+					}
+				}
+				if (region.busy == false) {
+					region.busy = true;
+					return r;
+				}
+			}
+			return -1;
+		}
+
+		int TileStreamer::acquireSlot() {
+			int best = -1;
+			for (int s = 0; s < static_cast<int>(this->m_slots.size()); ++s) {
+				const Slot& slot = this->m_slots[s];
+				if (slot.loading) {
+					continue;
+				}
+				if (slot.tile < 0) {
+					return s;
+				}
+				// tiles wanted this frame stay
+				if (slot.lastWanted < this->m_frame && (best < 0 || slot.lastWanted < this->m_slots[best].lastWanted)) {
+					best = s;
+				}
+			}
+			return best;
+		}
+
+		int TileStreamer::update(const glm::vec3& center, const float radius) {
+			if (this->m_stagingMapped == nullptr) {
+				return 0;
+			}
+			this->m_frame++;
+
+			std::deque<LoadRequest> finished;
+			{
+				std::lock_guard<std::mutex> lock(this->m_mutex);
+				finished.swap(this->m_finished);
+			}
+			for (const LoadRequest& request : finished) {
+				this->publishTile(request);
+			}
+
+			// wanted tiles, nearest first
+			std::vector<std::pair<float, int>> wanted;
+			const glm::vec2 point(center.x, center.z);
+			for (uint32_t t = 0u; t < this->m_source.numTiles; ++t) {
+				const InstanceFieldTile& tile = this->m_source.tiles[t];
+				const glm::vec2 closest = glm::clamp(point, glm::vec2(tile.boundsMin[0], tile.boundsMin[2]), glm::vec2(tile.boundsMax[0], tile.boundsMax[2]));
+				const float distance = glm::length(point - closest);
+				if (distance <= radius) {
+					wanted.push_back(std::make_pair(distance, static_cast<int>(t)));
+				}
+			}
+			std::sort(wanted.begin(), wanted.end());
+			for (const std::pair<float, int>& entry : wanted) {
+				const int slot = this->m_tileSlots[entry.second];
+				if (slot >= 0) {
+					this->m_slots[slot].lastWanted = this->m_frame;
+				}
+			}
+
+			bool requested = false;
+			int missing = 0;
+			for (const std::pair<float, int>& entry : wanted) {
+				const int tile = entry.second;
+				if (this->m_tileSlots[tile] >= 0) {
+					continue;
+				}
+				const int slot = missing == 0 ? this->acquireSlot() : -1;
+				const int region = slot >= 0 ? this->acquireRegion() : -1;
+				if (region < 0) {
+					missing++;
+					continue;
+				}
+				Slot& target = this->m_slots[slot];
+				if (target.tile >= 0) {
+					this->m_tileSlots[target.tile] = -1;
+					this->setTableEntry(slot, 0u, -1);
+					this->m_residentTiles--;
+				}
+				target.tile = tile;
+				target.loading = true;
+				target.lastWanted = this->m_frame;
+				this->m_tileSlots[tile] = slot;
+				this->m_pendingTiles++;
+
+				LoadRequest request;
+				request.tile = tile;
+				request.slot = slot;
+				request.region = region;
+				{
+					std::lock_guard<std::mutex> lock(this->m_mutex);
+					this->m_requests.push_back(request);
+				}
+				requested = true;
+			}
+			if (requested) {
+				this->m_condition.notify_all();
+			}
+			return missing;
+		}
+
+		void TileStreamer::prefetch(const glm::vec3& center, const float radius) {
+			while (true) {
+				const int missing = this->update(center, radius);
+				if (this->m_pendingTiles > 0) {
+					std::unique_lock<std::mutex> lock(this->m_mutex);
+					this->m_condition.wait(lock, [this]() { return this->m_finished.empty() == false; });
+				}
+				else if (missing == 0 || this->acquireSlot() < 0) {
+					// everything wanted is resident, or the pool is full of wanted tiles
+					return;
+				}
+				else {
+					// only the staging copies are outstanding
+					glFinish();
+				}
+			}
+		}
+	}
+}
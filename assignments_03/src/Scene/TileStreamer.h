@@ -0,0 +1,123 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <glad/glad.h>
+#include <glm/vec3.hpp>
+
+#include "InstanceField.h"
+
+namespace INANOA {
+	namespace SCENE {
+		// tiles of an instance field (mapped SS2 v2 file or a freshly baked one), must outlive the streamer
+		struct TiledInstanceSource {
+			const InstanceFieldTile* tiles = nullptr;
+			const InstanceFieldChunk* chunks = nullptr;
+			const unsigned char* records = nullptr;
+			uint32_t numTiles = 0u;
+			uint32_t recordStride = 0u;
+		};
+
+		// fixed size GPU tile pool: slot s owns cells [s * cellsPerSlot, (s + 1) * cellsPerSlot) and
+		// records [s * recordsPerSlot, (s + 1) * recordsPerSlot); tileTable holds one uvec4 per slot
+		// (x: resident cells, y: tile)
+		struct TilePoolBuffers {
+			GLuint cells = 0u;
+			GLuint records = 0u;
+			GLuint states = 0u;
+			GLuint tileTable = 0u;
+		};
+
+		// Keeps the tiles around a point resident in a fixed size GPU pool. A worker thread reads
+		// the requested tiles from the source (page faults of a mapped file land there, not on the
+		// render thread) into a persistently mapped staging buffer, the GL thread only issues the
+		// copies into the pool. When the pool is full the least recently wanted slot is evicted.
+		// The per-instance state of a tile (erased by the slime) does not survive its eviction.
+		class TileStreamer
+		{
+		public:
+			explicit TileStreamer();
+			virtual ~TileStreamer();
+
+			TileStreamer(const TileStreamer&) = delete;
+			TileStreamer& operator=(const TileStreamer&) = delete;
+
+		public:
+			bool init(const TiledInstanceSource& source, const int numSlots, const uint32_t cellsPerSlot, const uint32_t recordsPerSlot, const TilePoolBuffers& buffers);
+			// stops the worker, must run before the source goes away
+			void shutdown();
+
+			// GL thread, once per frame: publishes finished tiles and requests the missing tiles
+			// within radius of center (xz), nearest first. Returns the wanted tiles that could not
+			// be requested yet (no free staging region or slot).
+			int update(const glm::vec3& center, const float radius);
+			// update() until every tile within radius is resident
+			void prefetch(const glm::vec3& center, const float radius);
+
+		public:
+			inline int residentTiles() const { return this->m_residentTiles; }
+			inline int pendingTiles() const { return this->m_pendingTiles; }
+			inline int numSlots() const { return static_cast<int>(this->m_slots.size()); }
+
+			// number of slots a square grid of tileSize tiles needs to hold every tile within
+			// radius of any point
+			static int slotsForRadius(const float radius, const float tileSize);
+
+		private:
+			struct Slot {
+				int tile = -1;
+				bool loading = false;
+				uint64_t lastWanted = 0u;
+			};
+			struct StagingRegion {
+				bool busy = false;
+				GLsync fence = nullptr;
+			};
+			struct LoadRequest {
+				int tile = -1;
+				int slot = -1;
+				int region = -1;
+			};
+
+		private:
+			void workerLoop();
+			void stageTile(const LoadRequest& request);
+			void publishTile(const LoadRequest& request);
+			void setTableEntry(const int slot, const uint32_t numCells, const int tile);
+			int acquireRegion();
+			int acquireSlot();
+
+		private:
+			static const int NUM_STAGING_REGIONS = 4;
+
+			TiledInstanceSource m_source;
+			TilePoolBuffers m_buffers;
+			uint32_t m_cellsPerSlot = 0u;
+			uint32_t m_recordsPerSlot = 0u;
+
+			std::vector<Slot> m_slots;
+			// slot of every tile, -1 when neither resident nor loading
+			std::vector<int> m_tileSlots;
+			uint64_t m_frame = 0u;
+			int m_residentTiles = 0;
+			int m_pendingTiles = 0;
+
+			GLuint m_stagingBuffer = 0u;
+			unsigned char* m_stagingMapped = nullptr;
+			GLsizeiptr m_regionBytes = 0;
+			StagingRegion m_regions[NUM_STAGING_REGIONS];
+
+			std::thread m_worker;
+			std::mutex m_mutex;
+			std::condition_variable m_condition;
+			std::deque<LoadRequest> m_requests;
+			std::deque<LoadRequest> m_finished;
+			bool m_quit = false;
+		};
+	}
+}
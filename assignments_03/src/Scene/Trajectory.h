@@ -4,6 +4,7 @@
 #define GLM_ENABLE_EXPERIMENTAL
 #endif
 
+#include <glm/vec2.hpp>
 #include <glm/vec3.hpp>
 #include <glm/gtx/rotate_vector.hpp>
 #include <random>
@@ -25,6 +26,11 @@ this->m_dist = std::normal_distribution<float>(0.0f, 0.03f);
 				void setStartPosition(const glm::vec3& startPos) {
 					this->m_currPosition = startPos;
 				}
+				// xz area the trajectory turns around at
+				void setBounds(const glm::vec2& boundsMin, const glm::vec2& boundsMax) {
+					this->m_boundsMin = boundsMin;
+					this->m_boundsMax = boundsMax;
+				}
 				void update() {
 					if (this->m_enabled == false) {
 						return;
@@ -44,7 +50,7 @@ this->m_dist = std::normal_distribution<float>(0.0f, 0.03f);
 
 					this->m_currPosition = this->m_currPosition + this->m_speed * this->m_direction;
 					// boundary
-					if (this->m_currPosition.x > 50.0 || this->m_currPosition.x < -50.0 || this->m_currPosition.z > 10.0 || this->m_currPosition.z < -250.0) {
+					if (this->m_currPosition.x > this->m_boundsMax.x || this->m_currPosition.x < this->m_boundsMin.x || this->m_currPosition.z > this->m_boundsMax.y || this->m_currPosition.z < this->m_boundsMin.y) {
 						this->m_direction = -1.0f * this->m_direction;
 					}
 				}
@@ -63,6 +69,8 @@ return glm::vec4(this->m_currPosition, 1.0f);
 			private:
 				glm::vec3 m_currPosition;
 				glm::vec3 m_direction;
+				glm::vec2 m_boundsMin = glm::vec2(-50.0f, -250.0f);
+				glm::vec2 m_boundsMax = glm::vec2(50.0f, 10.0f);
 float m_speed = 0.01f;
 				float m_radians = 0.0;
 
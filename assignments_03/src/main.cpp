@@ -3,21 +3,116 @@
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
 #include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
 #define GL_SILENCE_DEPRECATION
 #include <GLFW/glfw3.h>
 #include "RenderWidgets/RenderingOrderExp.h"
+#include "Rendering/FramePacer.h"
+#include "Rendering/FrameQueue.h"
+#include "Rendering/GLExtensions.h"
+#include "Rendering/GLStateCache.h"
+#include "Rendering/HeadlessContext.h"
+#include "Rendering/OffscreenTarget.h"
+#include "Benchmark/BenchmarkRunner.h"
+#include "Benchmark/CameraPath.h"
+#include "Benchmark/InstanceLayoutBenchmark.h"
 
 INANOA::RenderingOrderExp* renderer = nullptr;
 const int INIT_WIDTH = 1344;
 const int INIT_HEIGHT = 756;
 double PROGRAM_FPS = 0.0;
 double FRAME_MS = 0.0;
+// copies of the foliage sample sets per world axis (--world-repeat)
+int WORLD_REPEAT = 1;
+// interactive frame rate limit (--fps-limit), the simulation runs at a fixed rate regardless
+INANOA::OPENGL::FramePacer FRAME_PACER;
+
+// command line
+//   --benchmark              run headless (EGL + offscreen FBO) and write frame-time reports
+//   --frames N / --warmup N  measured / discarded frames of the benchmark
+//   --size WxH               offscreen resolution of the benchmark
+//   --path FILE              replay a recorded camera path instead of the procedural one
+//   --out PREFIX             report files: PREFIX.json and PREFIX.csv
+//   --no-occlusion           benchmark without Hi-Z occlusion culling
+//   --atomic-compaction      benchmark with atomic appends instead of the prefix sum compaction
+//   --no-indirect-count      benchmark drawing every foliage command instead of the compacted draw lists
+//   --no-impostors           benchmark drawing the far foliage as meshes instead of octahedral impostors
+//   --foliage-pass MODE      alpha-test (default), depth-prepass or alpha-to-coverage foliage shading
+//   --debug-view NAME        none (default), overdraw, instance, lod or quad foliage debug shading; reports the
+//                            foliage overdraw per viewport
+//   --layout-benchmark       run headless and compare culling the unpacked and packed instance records
+//                            (uses --frames, --warmup and --out)
+//   --instances N            instances of the layout benchmark
+//   --record FILE            interactive mode: record the player camera and slime path to FILE
+//   --world-repeat N         tile the foliage field N x N times (larger worlds for the tile streamer)
+//   --fps-limit N            cap the frame rate at N frames per second (interactive and benchmark)
+//   --single-thread          interactive mode: simulate and render on the main thread
+struct LaunchOptions {
+	bool benchmark = false;
+	bool layoutBenchmark = false;
+	bool singleThread = false;
+	INANOA::BENCHMARK::BenchmarkSettings settings;
+	int numInstances = INANOA::BENCHMARK::InstanceLayoutSettings().numInstances;
+	std::string recordFile;
+};
+INANOA::BENCHMARK::CameraPath RECORDED_PATH;
+
+// Interactive frames: the main thread owns the window, the input, ImGui and the simulation, the render
+// thread owns the GL context. They only share PresentedFrames through FRAME_QUEUE and the GuiStats.
+struct PresentedFrame {
+	uint64_t frameId = 0u;
+	INANOA::FrameSnapshot snapshot;
+	int framebufferWidth = 0;
+	int framebufferHeight = 0;
+	// what the render thread draws, ImGui::GetDrawData() on a single thread, guiDrawData otherwise
+	ImDrawData* drawData = nullptr;
+	// copy of the GUI draw lists, ImGui rewrites its own in the next frame
+	ImDrawData guiDrawData;
+
+	~PresentedFrame() {
+		for (ImDrawList* list : this->guiDrawData.CmdLists) {
+			IM_DELETE(list);
+		}
+	}
+};
+// the main thread simulates at most this many frames ahead of the render thread
+INANOA::OPENGL::FrameQueue<PresentedFrame, 2> FRAME_QUEUE;
+std::atomic<bool> RENDER_THREAD_QUIT = { false };
+// frame id of the last frame the render thread has swapped
+std::atomic<uint64_t> RENDERED_FRAME = { 0u };
+
+// render thread state shown in the GUI, published after every frame
+struct GuiStats {
+	std::vector<INANOA::OPENGL::GpuProfiler::ScopeResult> passes;
+	int droppedProfilerFrames = 0;
+	bool loading = false;
+	int completedLoadJobs = 0;
+	int submittedLoadJobs = 0;
+	int residentTiles = 0;
+	int tileSlots = 0;
+	int pendingTiles = 0;
+	INANOA::OPENGL::GLStateCache::Stats bindStats;
+	bool indirectCountSupported = false;
+	bool debugViewsSupported = false;
+	INANOA::OPENGL::OverdrawCounter::FrameResult overdraw;
+};
+std::mutex GUI_STATS_MUTEX;
+GuiStats GUI_STATS;
 
 bool on_init(int displayWidth, int displayHeight)
 {
 	// Initialize render
 	renderer = new INANOA::RenderingOrderExp();
+	renderer->setWorldRepeat(WORLD_REPEAT);
 	if (renderer->init(displayWidth, displayHeight) == false)
 	{
 		return false;
@@ -25,30 +120,192 @@ bool on_init(int displayWidth, int displayHeight)
 	return true;
 }
 
-void on_resize(GLFWwindow* window, int w, int h)
+// render thread (or the main thread with --single-thread), the GL context is current
+void render_frame(const PresentedFrame& frame)
 {
-	renderer->resize(w, h);
+	// the window framebuffer is only resized between frames
+	static int renderedWidth = 0;
+	static int renderedHeight = 0;
+	if (frame.framebufferWidth > 0 && frame.framebufferHeight > 0 && (frame.framebufferWidth != renderedWidth || frame.framebufferHeight != renderedHeight)) {
+		renderer->resize(frame.framebufferWidth, frame.framebufferHeight);
+		renderedWidth = frame.framebufferWidth;
+		renderedHeight = frame.framebufferHeight;
+	}
+	renderer->applySnapshot(frame.snapshot);
+	renderer->render();
+
+	ImGui_ImplOpenGL3_NewFrame();
+	glViewport(0, 0, frame.framebufferWidth, frame.framebufferHeight);
+	ImGui_ImplOpenGL3_RenderDrawData(frame.drawData);
+
+	GuiStats stats;
+	const INANOA::OPENGL::GpuProfiler* profiler = renderer->profiler();
+	stats.passes = profiler->rollingAverage();
+	stats.droppedProfilerFrames = profiler->droppedFrames();
+	stats.loading = renderer->loading();
+	stats.completedLoadJobs = renderer->assetLoader()->completedJobs();
+	stats.submittedLoadJobs = renderer->assetLoader()->submittedJobs();
+	stats.residentTiles = renderer->tileStreamer()->residentTiles();
+	stats.tileSlots = renderer->tileStreamer()->numSlots();
+	stats.pendingTiles = renderer->tileStreamer()->pendingTiles();
+	stats.bindStats = INANOA::OPENGL::GLStateCache::lastFrameStats();
+	stats.indirectCountSupported = renderer->indirectCountSupported();
+	stats.debugViewsSupported = renderer->overdrawCounter() != nullptr;
+	if (stats.debugViewsSupported) {
+		stats.overdraw = renderer->overdrawCounter()->latest();
+	}
+	std::lock_guard<std::mutex> lock(GUI_STATS_MUTEX);
+	GUI_STATS = std::move(stats);
 }
 
-inline void on_display()
+// yields first, then sleeps, while the other thread catches up
+static void wait_backoff(int& spins)
 {
-	renderer->update();
-	renderer->render();
+	spins = spins + 1;
+	if (spins < 64) {
+		std::this_thread::yield();
+	}
+	else {
+		std::this_thread::sleep_for(std::chrono::microseconds(200));
+	}
+}
+
+static void render_thread_main(GLFWwindow* window)
+{
+	glfwMakeContextCurrent(window);
+	int spins = 0;
+	while (true) {
+		const PresentedFrame* frame = FRAME_QUEUE.acquireRead();
+		if (frame == nullptr) {
+			// the queued frames are drawn before quitting
+			if (RENDER_THREAD_QUIT.load(std::memory_order_acquire)) {
+				break;
+			}
+			wait_backoff(spins);
+			continue;
+		}
+		spins = 0;
+		render_frame(*frame);
+		glfwSwapBuffers(window);
+		RENDERED_FRAME.store(frame->frameId, std::memory_order_release);
+		FRAME_QUEUE.releaseRead();
+	}
+	glfwMakeContextCurrent(nullptr);
+}
+
+// ImGui rewrites its draw lists every frame, the render thread draws from clones. The GUI textures are
+// not copied: ImGui and the backend both write them while one needs an upload (see the main loop).
+static void copy_draw_data(const ImDrawData* source, ImDrawData& target)
+{
+	for (ImDrawList* list : target.CmdLists) {
+		IM_DELETE(list);
+	}
+	target.Clear();
+	for (ImDrawList* list : source->CmdLists) {
+		target.CmdLists.push_back(list->CloneOutput());
+	}
+	target.Valid = source->Valid;
+	target.CmdListsCount = source->CmdListsCount;
+	target.TotalIdxCount = source->TotalIdxCount;
+	target.TotalVtxCount = source->TotalVtxCount;
+	target.DisplayPos = source->DisplayPos;
+	target.DisplaySize = source->DisplaySize;
+	target.FramebufferScale = source->FramebufferScale;
+	target.OwnerViewport = source->OwnerViewport;
+	target.Textures = source->Textures;
+}
+
+static bool gui_textures_pending()
+{
+	for (const ImTextureData* texture : ImGui::GetPlatformIO().Textures) {
+		if (texture->Status != ImTextureStatus_OK) {
+			return true;
+		}
+	}
+	return false;
 }
 
 inline void on_gui()
 {
+	GuiStats stats;
+	{
+		std::lock_guard<std::mutex> lock(GUI_STATS_MUTEX);
+		stats = GUI_STATS;
+	}
+
 	// Show statistics window
 	{
 		static char fpsBuf[] = "fps: 000000000.000000000";
 		static char msBuf[] = "ms: 000000000.000000000";
 
-		sprintf_s(fpsBuf + 5, 16, "%.5f", PROGRAM_FPS);
-		sprintf_s(msBuf + 4, 16, "%.5f", (1000.0 / PROGRAM_FPS));
+		snprintf(fpsBuf + 5, 16, "%.5f", PROGRAM_FPS);
+		snprintf(msBuf + 4, 16, "%.5f", (1000.0 / PROGRAM_FPS));
 
 		ImGui::Begin("Information");
-		ImGui::Text(fpsBuf);
-		ImGui::Text(msBuf);
+		ImGui::TextUnformatted(fpsBuf);
+		ImGui::TextUnformatted(msBuf);
+
+		const INANOA::SCENE::SimulationClock* clock = renderer->simulationClock();
+		ImGui::Text("simulation: %.0f steps/s, %llu steps, %llu dropped", 1.0 / clock->stepSeconds(), static_cast<unsigned long long>(clock->totalSteps()), static_cast<unsigned long long>(clock->droppedSteps()));
+		int fpsLimit = static_cast<int>(FRAME_PACER.targetFps());
+		if (ImGui::SliderInt("fps limit (0: off)", &fpsLimit, 0, 240)) {
+			FRAME_PACER.setTargetFps(fpsLimit);
+		}
+
+		bool occlusionCulling = renderer->occlusionCulling();
+		if (ImGui::Checkbox("occlusion culling", &occlusionCulling)) {
+			renderer->setOcclusionCulling(occlusionCulling);
+		}
+		bool prefixSumCompaction = renderer->prefixSumCompaction();
+		if (ImGui::Checkbox("prefix sum compaction", &prefixSumCompaction)) {
+			renderer->setPrefixSumCompaction(prefixSumCompaction);
+		}
+		if (stats.indirectCountSupported) {
+			bool indirectCountDraws = renderer->indirectCountDraws();
+			if (ImGui::Checkbox("indirect count draws", &indirectCountDraws)) {
+				renderer->setIndirectCountDraws(indirectCountDraws);
+			}
+		}
+		bool impostors = renderer->impostors();
+		if (ImGui::Checkbox("impostors", &impostors)) {
+			renderer->setImpostors(impostors);
+		}
+		int foliagePass = static_cast<int>(renderer->foliagePass());
+		const char* foliagePasses[INANOA::NUM_FOLIAGE_PASSES] = { "alpha test", "depth pre-pass", "alpha to coverage" };
+		if (ImGui::Combo("foliage pass", &foliagePass, foliagePasses, INANOA::NUM_FOLIAGE_PASSES)) {
+			renderer->setFoliagePass(static_cast<INANOA::FoliagePass>(foliagePass));
+		}
+		if (stats.debugViewsSupported) {
+			int debugView = static_cast<int>(renderer->debugView());
+			const char* debugViews[INANOA::OPENGL::NUM_DEBUG_VIEWS] = { "none", "overdraw", "instance", "lod", "quad occupancy" };
+			if (ImGui::Combo("debug view", &debugView, debugViews, INANOA::OPENGL::NUM_DEBUG_VIEWS)) {
+				renderer->setDebugView(static_cast<INANOA::OPENGL::DebugViewType>(debugView));
+			}
+			if (renderer->debugView() != INANOA::OPENGL::DebugViewType::NONE) {
+				// foliage fragments per pixel of the viewport / of the pixels with foliage
+				for (const INANOA::OPENGL::OverdrawCounter::ViewStats& view : stats.overdraw.views) {
+					if (view.valid) {
+						ImGui::Text("%-6s overdraw %5.2f avg %5.2f covered %4u max, quads %3.0f%%", view.name, view.averageOverdraw, view.coveredOverdraw, view.maxOverdraw, view.quadOccupancy * 100.0);
+					}
+				}
+			}
+		}
+
+		if (stats.loading) {
+			ImGui::Text("loading assets: %d / %d", stats.completedLoadJobs, stats.submittedLoadJobs);
+		}
+		ImGui::Text("tiles: %d / %d resident, %d loading", stats.residentTiles, stats.tileSlots, stats.pendingTiles);
+		ImGui::Text("state binds: %u issued, %u skipped", stats.bindStats.issuedCalls, stats.bindStats.skippedCalls);
+
+		// rolling per-pass breakdown
+		ImGui::Separator();
+		ImGui::Text("%-22s %8s %8s", "pass", "cpu ms", "gpu ms");
+		for (const INANOA::OPENGL::GpuProfiler::ScopeResult& scope : stats.passes) {
+			ImGui::Text("%*s%-*s %8.3f %8.3f", scope.depth * 2, "", 22 - scope.depth * 2, scope.name.c_str(), scope.cpuMs, scope.gpuMs);
+		}
+		if (stats.droppedProfilerFrames > 0) {
+			ImGui::Text("dropped frames: %d", stats.droppedProfilerFrames);
+		}
 		ImGui::End();
 	}
 }
@@ -100,8 +357,159 @@ static void glfw_error_callback(int error, const char* description)
 	fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
-int main(int, char**)
+static bool parse_options(int argc, char** argv, LaunchOptions& options)
 {
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+		const bool hasValue = i + 1 < argc;
+		if (arg == "--benchmark") {
+			options.benchmark = true;
+		}
+		else if (arg == "--frames" && hasValue) {
+			options.settings.numFrames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--warmup" && hasValue) {
+			options.settings.warmupFrames = std::atoi(argv[++i]);
+		}
+		else if (arg == "--size" && hasValue) {
+			if (sscanf(argv[++i], "%dx%d", &options.settings.width, &options.settings.height) != 2) {
+				return false;
+			}
+		}
+		else if (arg == "--path" && hasValue) {
+			options.settings.pathFile = argv[++i];
+		}
+		else if (arg == "--out" && hasValue) {
+			options.settings.outputPrefix = argv[++i];
+		}
+		else if (arg == "--no-occlusion") {
+			options.settings.occlusionCulling = false;
+		}
+		else if (arg == "--atomic-compaction") {
+			options.settings.prefixSumCompaction = false;
+		}
+		else if (arg == "--no-indirect-count") {
+			options.settings.indirectCountDraws = false;
+		}
+		else if (arg == "--no-impostors") {
+			options.settings.impostors = false;
+		}
+		else if (arg == "--foliage-pass" && hasValue) {
+			if (INANOA::parseFoliagePass(argv[++i], options.settings.foliagePass) == false) {
+				return false;
+			}
+		}
+		else if (arg == "--debug-view" && hasValue) {
+			if (INANOA::OPENGL::parseDebugView(argv[++i], options.settings.debugView) == false) {
+				return false;
+			}
+		}
+		else if (arg == "--layout-benchmark") {
+			options.layoutBenchmark = true;
+		}
+		else if (arg == "--instances" && hasValue) {
+			options.numInstances = std::atoi(argv[++i]);
+		}
+		else if (arg == "--record" && hasValue) {
+			options.recordFile = argv[++i];
+		}
+		else if (arg == "--world-repeat" && hasValue) {
+			WORLD_REPEAT = std::atoi(argv[++i]);
+		}
+		else if (arg == "--fps-limit" && hasValue) {
+			options.settings.fpsLimit = std::atof(argv[++i]);
+		}
+		else if (arg == "--single-thread") {
+			options.singleThread = true;
+		}
+		else {
+			return false;
+		}
+	}
+	return options.settings.numFrames > 0 && options.settings.width > 0 && options.settings.height > 0 && options.numInstances > 0 && WORLD_REPEAT > 0 && options.settings.fpsLimit >= 0.0;
+}
+
+static bool create_headless_context(INANOA::OPENGL::HeadlessContext& context)
+{
+	if (context.create(4, 6) == false) {
+		std::cerr << "Failed to create headless context: " << context.errorLog() << "\n";
+		return false;
+	}
+	if (!gladLoadGLLoader((GLADloadproc)INANOA::OPENGL::HeadlessContext::procAddress)) {
+		std::cerr << "Failed to initialize GLAD\n";
+		return false;
+	}
+	INANOA::OPENGL::GLExtensions::load((GLADloadproc)INANOA::OPENGL::HeadlessContext::procAddress);
+	std::cout << "Benchmark on " << glGetString(GL_RENDERER) << " (" << glGetString(GL_VERSION) << ")\n";
+	return true;
+}
+
+static int run_benchmark(const LaunchOptions& options)
+{
+	INANOA::OPENGL::HeadlessContext context;
+	if (create_headless_context(context) == false) {
+		return 1;
+	}
+
+	int result = 0;
+	{
+		INANOA::OPENGL::OffscreenTarget target;
+		if (target.init(options.settings.width, options.settings.height) == false) {
+			std::cerr << "Failed to create offscreen target\n";
+			return 1;
+		}
+		if (on_init(options.settings.width, options.settings.height) == false) {
+			return 1;
+		}
+
+		INANOA::BENCHMARK::BenchmarkRunner runner(options.settings);
+		if (runner.run(renderer, &target) == false || runner.writeReports() == false) {
+			result = 1;
+		}
+		on_destroy();
+	}
+	context.destroy();
+	return result;
+}
+
+static int run_layout_benchmark(const LaunchOptions& options)
+{
+	INANOA::OPENGL::HeadlessContext context;
+	if (create_headless_context(context) == false) {
+		return 1;
+	}
+
+	INANOA::BENCHMARK::InstanceLayoutSettings settings;
+	settings.numInstances = options.numInstances;
+	settings.numIterations = options.settings.numFrames;
+	settings.warmupIterations = options.settings.warmupFrames;
+	settings.outputPrefix = options.settings.outputPrefix;
+
+	int result = 0;
+	{
+		INANOA::BENCHMARK::InstanceLayoutBenchmark benchmark(settings);
+		if (benchmark.run() == false || benchmark.writeReports() == false) {
+			result = 1;
+		}
+	}
+	context.destroy();
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	LaunchOptions options;
+	if (parse_options(argc, argv, options) == false) {
+		std::cerr << "usage: " << argv[0] << " [--benchmark [--frames N] [--warmup N] [--size WxH] [--path FILE] [--out PREFIX] [--no-occlusion] [--atomic-compaction] [--no-indirect-count] [--no-impostors] [--foliage-pass MODE] [--debug-view NAME]] [--layout-benchmark [--instances N]] [--record FILE] [--world-repeat N] [--fps-limit N] [--single-thread]\n";
+		return 1;
+	}
+	if (options.benchmark) {
+		return run_benchmark(options);
+	}
+	if (options.layoutBenchmark) {
+		return run_layout_benchmark(options);
+	}
+
 	glfwSetErrorCallback(glfw_error_callback);
 	if (!glfwInit())
 		return 1;
@@ -125,6 +533,7 @@ int main(int, char**)
 		std::cerr << "Failed to initialize GLAD\n";
 		return -1;
 	}
+	INANOA::OPENGL::GLExtensions::load((GLADloadproc)glfwGetProcAddress);
 	glfwSwapInterval(0); // Disable vsync
 
 	// Setup Dear ImGui context
@@ -148,7 +557,6 @@ int main(int, char**)
 	glfwSetScrollCallback(window, on_scroll);
 	glfwSetMouseButtonCallback(window, on_mouse_button);
 	glfwSetCursorPosCallback(window, on_cursor_pos);
-	glfwSetFramebufferSizeCallback(window, on_resize);
 
 	// Setup Platform/Renderer backends
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
@@ -164,6 +572,19 @@ int main(int, char**)
 	// FPS calculation
 	double previousTimeStamp = glfwGetTime();
 	int frameCounter = 0;
+	// simulation time
+	double previousFrameTime = previousTimeStamp;
+	FRAME_PACER.setTargetFps(options.settings.fpsLimit);
+
+	// the render thread takes the context over until shutdown
+	std::thread renderThread;
+	if (options.singleThread == false) {
+		glfwMakeContextCurrent(nullptr);
+		renderThread = std::thread(render_thread_main, window);
+	}
+	uint64_t frameId = 0u;
+	// last submitted frame that uploads GUI textures
+	uint64_t textureUploadFrame = 0u;
 
 	// Main loop
 	while (!glfwWindowShouldClose(window))
@@ -192,22 +613,78 @@ int main(int, char**)
 			continue;
 		}
 
+		// the backend writes the status of the textures it uploads, ImGui must not touch them until it is done
+		int spins = 0;
+		while (RENDERED_FRAME.load(std::memory_order_acquire) < textureUploadFrame) {
+			wait_backoff(spins);
+		}
+
 		// Start the Dear ImGui frame
-		ImGui_ImplOpenGL3_NewFrame();
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 		on_gui();
-		// Rendering
-		on_display();
+		// Simulation
+		const double frameTime = glfwGetTime();
+		renderer->simulate(frameTime - previousFrameTime);
+		previousFrameTime = frameTime;
+		const INANOA::FrameSnapshot snapshot = renderer->snapshot();
+		if (options.recordFile.empty() == false) {
+			INANOA::BENCHMARK::CameraPathKey key;
+			key.eye = snapshot.playerEye;
+			key.lookCenter = snapshot.playerLookCenter;
+			key.slimePosition = snapshot.slimePosition;
+			RECORDED_PATH.append(key);
+		}
 		ImGui::Render();
+		frameId = frameId + 1u;
 		int display_w, display_h;
 		glfwGetFramebufferSize(window, &display_w, &display_h);
-		glViewport(0, 0, display_w, display_h);
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-		glfwSwapBuffers(window);
+
+		// Rendering
+		if (options.singleThread) {
+			PresentedFrame frame;
+			frame.frameId = frameId;
+			frame.snapshot = snapshot;
+			frame.framebufferWidth = display_w;
+			frame.framebufferHeight = display_h;
+			frame.drawData = ImGui::GetDrawData();
+			render_frame(frame);
+			glfwSwapBuffers(window);
+		}
+		else {
+			PresentedFrame* frame = FRAME_QUEUE.acquireWrite();
+			spins = 0;
+			while (frame == nullptr) {
+				wait_backoff(spins);
+				frame = FRAME_QUEUE.acquireWrite();
+			}
+			frame->frameId = frameId;
+			frame->snapshot = snapshot;
+			frame->framebufferWidth = display_w;
+			frame->framebufferHeight = display_h;
+			copy_draw_data(ImGui::GetDrawData(), frame->guiDrawData);
+			// nearly every frame draws with the already uploaded font atlas only
+			if (gui_textures_pending()) {
+				textureUploadFrame = frameId;
+			}
+			else {
+				frame->guiDrawData.Textures = nullptr;
+			}
+			frame->drawData = &frame->guiDrawData;
+			FRAME_QUEUE.commitWrite();
+		}
+		FRAME_PACER.wait();
 	}
 
 	// Cleanup
+	if (options.singleThread == false) {
+		RENDER_THREAD_QUIT.store(true, std::memory_order_release);
+		renderThread.join();
+		glfwMakeContextCurrent(window);
+	}
+	if (options.recordFile.empty() == false && RECORDED_PATH.save(options.recordFile) == false) {
+		std::cerr << "Failed to write camera path: " << options.recordFile << "\n";
+	}
 	on_destroy();
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();